@@ -0,0 +1,179 @@
+/***************************************************************************
+ * GameCube Tools Library.                                                 *
+ * ByteScan.cpp: Fast byte scanning functions.                             *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ByteScan.hpp"
+#include "util/cpuflags.h"
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+#ifdef CPUFLAGS_X86
+#  include <emmintrin.h>
+#  include <immintrin.h>
+#endif /* CPUFLAGS_X86 */
+
+namespace ByteScan {
+
+/**
+ * Check if a buffer consists of a single repeated byte.
+ * Standard version. (No SIMD)
+ * @param buf	[in] Buffer.
+ * @param siz	[in] Size of buf.
+ * @param value	[out,opt] Repeated byte, if the buffer is uniform.
+ * @return True if every byte in buf is the same; false if not, or if siz == 0.
+ */
+bool isUniform_c(const uint8_t *buf, size_t siz, uint8_t *value)
+{
+	if (siz == 0)
+		return false;
+
+	const uint8_t chr = buf[0];
+	const uint64_t pattern = chr * 0x0101010101010101ULL;
+	const uint8_t *p = buf;
+	const uint8_t *const p_end = buf + siz;
+
+	// Check 32 bytes at a time.
+	for (; p + 32 <= p_end; p += 32) {
+		uint64_t qw[4];
+		memcpy(qw, p, sizeof(qw));
+		if (((qw[0] ^ pattern) | (qw[1] ^ pattern) |
+		     (qw[2] ^ pattern) | (qw[3] ^ pattern)) != 0)
+		{
+			return false;
+		}
+	}
+
+	// Check the remaining bytes.
+	for (; p < p_end; p++) {
+		if (*p != chr)
+			return false;
+	}
+
+	if (value) {
+		*value = chr;
+	}
+	return true;
+}
+
+#ifdef CPUFLAGS_X86
+/**
+ * Check if a buffer consists of a single repeated byte.
+ * SSE2-optimized version.
+ * @param buf	[in] Buffer.
+ * @param siz	[in] Size of buf.
+ * @param value	[out,opt] Repeated byte, if the buffer is uniform.
+ * @return True if every byte in buf is the same; false if not, or if siz == 0.
+ */
+CPUFLAGS_TARGET("sse2")
+static bool isUniform_sse2(const uint8_t *buf, size_t siz, uint8_t *value)
+{
+	if (siz == 0)
+		return false;
+
+	const uint8_t chr = buf[0];
+	const __m128i pattern = _mm_set1_epi8((char)chr);
+	const __m128i zero = _mm_setzero_si128();
+	const uint8_t *p = buf;
+	const uint8_t *const p_end = buf + siz;
+
+	// Check 64 bytes at a time.
+	for (; p + 64 <= p_end; p += 64) {
+		const __m128i *const xmm = reinterpret_cast<const __m128i*>(p);
+		__m128i diff = _mm_or_si128(
+			_mm_or_si128(_mm_xor_si128(_mm_loadu_si128(&xmm[0]), pattern),
+				     _mm_xor_si128(_mm_loadu_si128(&xmm[1]), pattern)),
+			_mm_or_si128(_mm_xor_si128(_mm_loadu_si128(&xmm[2]), pattern),
+				     _mm_xor_si128(_mm_loadu_si128(&xmm[3]), pattern)));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, zero)) != 0xFFFF)
+			return false;
+	}
+
+	// Check the remaining bytes.
+	for (; p < p_end; p++) {
+		if (*p != chr)
+			return false;
+	}
+
+	if (value) {
+		*value = chr;
+	}
+	return true;
+}
+
+/**
+ * Check if a buffer consists of a single repeated byte.
+ * AVX2-optimized version.
+ * @param buf	[in] Buffer.
+ * @param siz	[in] Size of buf.
+ * @param value	[out,opt] Repeated byte, if the buffer is uniform.
+ * @return True if every byte in buf is the same; false if not, or if siz == 0.
+ */
+CPUFLAGS_TARGET("avx2")
+static bool isUniform_avx2(const uint8_t *buf, size_t siz, uint8_t *value)
+{
+	if (siz == 0)
+		return false;
+
+	const uint8_t chr = buf[0];
+	const __m256i pattern = _mm256_set1_epi8((char)chr);
+	const uint8_t *p = buf;
+	const uint8_t *const p_end = buf + siz;
+
+	// Check 128 bytes at a time.
+	for (; p + 128 <= p_end; p += 128) {
+		const __m256i *const ymm = reinterpret_cast<const __m256i*>(p);
+		__m256i diff = _mm256_or_si256(
+			_mm256_or_si256(_mm256_xor_si256(_mm256_loadu_si256(&ymm[0]), pattern),
+					_mm256_xor_si256(_mm256_loadu_si256(&ymm[1]), pattern)),
+			_mm256_or_si256(_mm256_xor_si256(_mm256_loadu_si256(&ymm[2]), pattern),
+					_mm256_xor_si256(_mm256_loadu_si256(&ymm[3]), pattern)));
+		if (!_mm256_testz_si256(diff, diff))
+			return false;
+	}
+
+	// Check the remaining bytes.
+	for (; p < p_end; p++) {
+		if (*p != chr)
+			return false;
+	}
+
+	if (value) {
+		*value = chr;
+	}
+	return true;
+}
+#endif /* CPUFLAGS_X86 */
+
+/**
+ * Check if a buffer consists of a single repeated byte.
+ * SSE2 or AVX2 is used if supported by the CPU.
+ * @param buf	[in] Buffer.
+ * @param siz	[in] Size of buf.
+ * @param value	[out,opt] Repeated byte, if the buffer is uniform.
+ * @return True if every byte in buf is the same; false if not, or if siz == 0.
+ */
+bool isUniform(const uint8_t *buf, size_t siz, uint8_t *value)
+{
+#ifdef CPUFLAGS_X86
+	const uint32_t flags = cpuflags_get();
+	if (flags & CPUFLAG_X86_AVX2) {
+		return isUniform_avx2(buf, siz, value);
+	}
+#  ifdef CPUFLAGS_HAS_SSE2_ALWAYS
+	return isUniform_sse2(buf, siz, value);
+#  else /* !CPUFLAGS_HAS_SSE2_ALWAYS */
+	if (flags & CPUFLAG_X86_SSE2) {
+		return isUniform_sse2(buf, siz, value);
+	}
+#  endif /* CPUFLAGS_HAS_SSE2_ALWAYS */
+#endif /* CPUFLAGS_X86 */
+
+	return isUniform_c(buf, siz, value);
+}
+
+}
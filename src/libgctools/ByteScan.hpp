@@ -0,0 +1,55 @@
+/***************************************************************************
+ * GameCube Tools Library.                                                 *
+ * ByteScan.hpp: Fast byte scanning functions.                             *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __LIBGCTOOLS_BYTESCAN_HPP__
+#define __LIBGCTOOLS_BYTESCAN_HPP__
+
+// C includes.
+#include <stdint.h>
+
+// C includes. (C++ namespace)
+#include <cstddef>
+
+namespace ByteScan {
+
+/**
+ * Check if a buffer consists of a single repeated byte.
+ * SSE2 or AVX2 is used if supported by the CPU.
+ * @param buf	[in] Buffer.
+ * @param siz	[in] Size of buf.
+ * @param value	[out,opt] Repeated byte, if the buffer is uniform.
+ * @return True if every byte in buf is the same; false if not, or if siz == 0.
+ */
+bool isUniform(const uint8_t *buf, size_t siz, uint8_t *value = nullptr);
+
+/**
+ * Check if a buffer consists of a single repeated byte.
+ * Standard version. (No SIMD)
+ * @param buf	[in] Buffer.
+ * @param siz	[in] Size of buf.
+ * @param value	[out,opt] Repeated byte, if the buffer is uniform.
+ * @return True if every byte in buf is the same; false if not, or if siz == 0.
+ */
+bool isUniform_c(const uint8_t *buf, size_t siz, uint8_t *value = nullptr);
+
+/**
+ * Check if a buffer is blank, i.e. all 0x00 or all 0xFF.
+ * Erased and formatted memory card blocks usually look like this.
+ * @param buf	[in] Buffer.
+ * @param siz	[in] Size of buf.
+ * @return True if the buffer is blank; false if not.
+ */
+static inline bool isBlank(const uint8_t *buf, size_t siz)
+{
+	uint8_t value;
+	return (isUniform(buf, siz, &value) && (value == 0x00 || value == 0xFF));
+}
+
+}
+
+#endif /* __LIBGCTOOLS_BYTESCAN_HPP__ */
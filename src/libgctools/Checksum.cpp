@@ -10,25 +10,242 @@
 #include "SonicChaoGarden.inc.h"
 
 #include "util/byteswap.h"
+#include "util/cpuflags.h"
 
 // C includes. (C++ namespace)
 #include <cstdio>
 #include <cstring>
 
+#ifdef CPUFLAGS_X86
+#  include <emmintrin.h>
+#  include <immintrin.h>
+#endif /* CPUFLAGS_X86 */
+
 // C++ includes.
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
+using std::lock_guard;
+using std::mutex;
 using std::string;
 using std::unique_ptr;
+using std::unordered_map;
 using std::vector;
 
 namespace Checksum {
 
+/** Table-driven CRC-16 helpers. **/
+
+namespace {
+
+// Compile-time index sequence.
+// (std::index_sequence requires C++14.)
+template<unsigned int... Is> struct IndexSeq { };
+template<unsigned int N, unsigned int... Is>
+struct MakeIndexSeq : MakeIndexSeq<N-1, N-1, Is...> { };
+template<unsigned int... Is>
+struct MakeIndexSeq<0, Is...> { typedef IndexSeq<Is...> type; };
+
+/**
+ * Slicing-by-8 CRC table.
+ * tbl[k][n] is the CRC of byte n followed by k zero bytes.
+ * tbl[0] is the standard byte-at-a-time table.
+ */
+template<typename T>
+struct CrcSliceTable {
+	T tbl[8][256];
+};
+typedef CrcSliceTable<uint16_t> Crc16SliceTable;
+typedef CrcSliceTable<uint32_t> Crc32SliceTable;
+
+/** Reflected CRC-16. (LSB first; used by Crc16()) **/
+
+/**
+ * Shift bits through a reflected CRC-16.
+ * @param crc CRC.
+ * @param poly Polynomial. (reflected)
+ * @param bits Number of bits.
+ * @return Updated CRC.
+ */
+constexpr uint16_t crc16r_bits(uint16_t crc, uint16_t poly, int bits)
+{
+	return (bits == 0 ? crc : crc16r_bits(
+		(crc & 1) ? (uint16_t)((crc >> 1) ^ poly) : (uint16_t)(crc >> 1),
+		poly, bits - 1));
+}
+
+/**
+ * Get a reflected CRC-16 slicing table entry.
+ * @param poly Polynomial. (reflected)
+ * @param k Table index. (number of trailing zero bytes)
+ * @param n Byte value.
+ * @return Table entry.
+ */
+constexpr uint16_t crc16r_entry(uint16_t poly, unsigned int k, unsigned int n)
+{
+	return (k == 0 ? crc16r_bits((uint16_t)n, poly, 8) :
+		(uint16_t)((crc16r_entry(poly, k-1, n) >> 8) ^
+			   crc16r_bits(crc16r_entry(poly, k-1, n) & 0xFF, poly, 8)));
+}
+
+/** Non-reflected CRC-16. (MSB first; used by DreamcastVMU()) **/
+
+/**
+ * Shift bits through a non-reflected CRC-16.
+ * @param crc CRC.
+ * @param poly Polynomial.
+ * @param bits Number of bits.
+ * @return Updated CRC.
+ */
+constexpr uint16_t crc16n_bits(uint16_t crc, uint16_t poly, int bits)
+{
+	return (bits == 0 ? crc : crc16n_bits(
+		(crc & 0x8000) ? (uint16_t)((crc << 1) ^ poly) : (uint16_t)(crc << 1),
+		poly, bits - 1));
+}
+
+/**
+ * Get a non-reflected CRC-16 slicing table entry.
+ * @param poly Polynomial.
+ * @param k Table index. (number of trailing zero bytes)
+ * @param n Byte value.
+ * @return Table entry.
+ */
+constexpr uint16_t crc16n_entry(uint16_t poly, unsigned int k, unsigned int n)
+{
+	return (k == 0 ? crc16n_bits((uint16_t)(n << 8), poly, 8) :
+		(uint16_t)((crc16n_entry(poly, k-1, n) << 8) ^
+			   crc16n_bits(crc16n_entry(poly, k-1, n) & 0xFF00, poly, 8)));
+}
+
+#define CRC_SLICE_ROW(entry, k) { entry(poly, k, Is)... }
+
+/**
+ * Generate a reflected CRC-16 slicing table.
+ * @param poly Polynomial. (reflected)
+ * @return Slicing table.
+ */
+template<unsigned int... Is>
+constexpr Crc16SliceTable crc16r_table(uint16_t poly, IndexSeq<Is...>)
+{
+	return {{
+		CRC_SLICE_ROW(crc16r_entry, 0), CRC_SLICE_ROW(crc16r_entry, 1),
+		CRC_SLICE_ROW(crc16r_entry, 2), CRC_SLICE_ROW(crc16r_entry, 3),
+		CRC_SLICE_ROW(crc16r_entry, 4), CRC_SLICE_ROW(crc16r_entry, 5),
+		CRC_SLICE_ROW(crc16r_entry, 6), CRC_SLICE_ROW(crc16r_entry, 7),
+	}};
+}
+
+/**
+ * Generate a non-reflected CRC-16 slicing table.
+ * @param poly Polynomial.
+ * @return Slicing table.
+ */
+template<unsigned int... Is>
+constexpr Crc16SliceTable crc16n_table(uint16_t poly, IndexSeq<Is...>)
+{
+	return {{
+		CRC_SLICE_ROW(crc16n_entry, 0), CRC_SLICE_ROW(crc16n_entry, 1),
+		CRC_SLICE_ROW(crc16n_entry, 2), CRC_SLICE_ROW(crc16n_entry, 3),
+		CRC_SLICE_ROW(crc16n_entry, 4), CRC_SLICE_ROW(crc16n_entry, 5),
+		CRC_SLICE_ROW(crc16n_entry, 6), CRC_SLICE_ROW(crc16n_entry, 7),
+	}};
+}
+
+// Polynomial used by the Dreamcast VMU. (CRC-16-CCITT, non-reflected)
+static const uint16_t CRC16_POLY_DREAMCAST_VMU = 0x1021;
+
+// Compile-time tables for the default polynomials.
+static constexpr Crc16SliceTable crc16_ccitt_table =
+	crc16r_table(CRC16_POLY_CCITT, MakeIndexSeq<256>::type());
+static constexpr Crc16SliceTable crc16_dcvmu_table =
+	crc16n_table(CRC16_POLY_DREAMCAST_VMU, MakeIndexSeq<256>::type());
+
+/**
+ * Get a reflected CRC-16 slicing table for the specified polynomial.
+ * Tables for custom polynomials are generated on first use and cached.
+ * This function is thread-safe.
+ * @param poly Polynomial. (reflected)
+ * @return Slicing table.
+ */
+static const Crc16SliceTable *getCrc16Table(uint16_t poly)
+{
+	if (poly == CRC16_POLY_CCITT)
+		return &crc16_ccitt_table;
+
+	static mutex tableMutex;
+	static unordered_map<uint16_t, unique_ptr<Crc16SliceTable> > tableCache;
+
+	lock_guard<mutex> lock(tableMutex);
+	unique_ptr<Crc16SliceTable> &table = tableCache[poly];
+	if (!table) {
+		table.reset(new Crc16SliceTable(crc16r_table(poly, MakeIndexSeq<256>::type())));
+	}
+	return table.get();
+}
+
+/**
+ * Update a reflected CRC-16 using a slicing table.
+ * @param t Slicing table.
+ * @param crc Current CRC.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @return Updated CRC.
+ */
+static inline uint16_t crc16r_update(const Crc16SliceTable &t, uint16_t crc, const uint8_t *buf, uint32_t siz)
+{
+	// Do eight bytes at a time.
+	for (; siz >= 8; siz -= 8, buf += 8) {
+		crc = t.tbl[7][buf[0] ^ (crc & 0xFF)] ^
+		      t.tbl[6][buf[1] ^ (crc >> 8)] ^
+		      t.tbl[5][buf[2]] ^ t.tbl[4][buf[3]] ^
+		      t.tbl[3][buf[4]] ^ t.tbl[2][buf[5]] ^
+		      t.tbl[1][buf[6]] ^ t.tbl[0][buf[7]];
+	}
+
+	// Remaining bytes.
+	for (; siz != 0; siz--, buf++) {
+		crc = (crc >> 8) ^ t.tbl[0][(crc ^ *buf) & 0xFF];
+	}
+	return crc;
+}
+
+/**
+ * Update a non-reflected CRC-16 using a slicing table.
+ * @param t Slicing table.
+ * @param crc Current CRC.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @return Updated CRC.
+ */
+static inline uint16_t crc16n_update(const Crc16SliceTable &t, uint16_t crc, const uint8_t *buf, uint32_t siz)
+{
+	// Do eight bytes at a time.
+	for (; siz >= 8; siz -= 8, buf += 8) {
+		crc = t.tbl[7][buf[0] ^ (crc >> 8)] ^
+		      t.tbl[6][buf[1] ^ (crc & 0xFF)] ^
+		      t.tbl[5][buf[2]] ^ t.tbl[4][buf[3]] ^
+		      t.tbl[3][buf[4]] ^ t.tbl[2][buf[5]] ^
+		      t.tbl[1][buf[6]] ^ t.tbl[0][buf[7]];
+	}
+
+	// Remaining bytes.
+	for (; siz != 0; siz--, buf++) {
+		crc = (uint16_t)(crc << 8) ^ t.tbl[0][(crc >> 8) ^ *buf];
+	}
+	return crc;
+}
+
+}
+
 /** Algorithms. **/
 
 /**
  * CRC-16 algorithm.
+ * Table-driven version using slicing-by-8.
  * @param buf Data buffer.
  * @param siz Length of data buffer.
  * @param poly Polynomial.
@@ -36,7 +253,20 @@ namespace Checksum {
  */
 uint16_t Crc16(const uint8_t *buf, uint32_t siz, uint16_t poly)
 {
-	// TODO: Add optimized version for poly == CRC16_POLY_CCITT.
+	const Crc16SliceTable *const table = getCrc16Table(poly);
+	return ~crc16r_update(*table, 0xFFFF, buf, siz);
+}
+
+/**
+ * CRC-16 algorithm.
+ * Bitwise reference version.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @param poly Polynomial.
+ * @return Checksum.
+ */
+uint16_t Crc16_bitwise(const uint8_t *buf, uint32_t siz, uint16_t poly)
+{
 	uint16_t crc = 0xFFFF;
 
 	for (; siz != 0; siz--, buf++) {
@@ -52,61 +282,741 @@ uint16_t Crc16(const uint8_t *buf, uint32_t siz, uint16_t poly)
 	return ~crc;
 }
 
+/** Table-driven CRC-32 helpers. **/
+
+namespace {
+
 /**
- * AddInvDual16 algorithm.
- * Adds 16-bit words together in a uint16_t.
- * First word is a simple addition.
- * Second word adds (word ^ 0xFFFF).
- * If either word equals 0xFFFF, it's changed to 0.
+ * Shift bits through a reflected CRC-32.
+ * @param crc CRC.
+ * @param poly Polynomial. (reflected)
+ * @param bits Number of bits.
+ * @return Updated CRC.
+ */
+constexpr uint32_t crc32r_bits(uint32_t crc, uint32_t poly, int bits)
+{
+	return (bits == 0 ? crc : crc32r_bits(
+		(crc & 1) ? ((crc >> 1) ^ poly) : (crc >> 1),
+		poly, bits - 1));
+}
+
+/**
+ * Get a reflected CRC-32 slicing table entry.
+ * @param poly Polynomial. (reflected)
+ * @param k Table index. (number of trailing zero bytes)
+ * @param n Byte value.
+ * @return Table entry.
+ */
+constexpr uint32_t crc32r_entry(uint32_t poly, unsigned int k, unsigned int n)
+{
+	return (k == 0 ? crc32r_bits(n, poly, 8) :
+		((crc32r_entry(poly, k-1, n) >> 8) ^
+		 crc32r_bits(crc32r_entry(poly, k-1, n) & 0xFF, poly, 8)));
+}
+
+/**
+ * Shift bits through a non-reflected CRC-32.
+ * @param crc CRC.
+ * @param poly Polynomial.
+ * @param bits Number of bits.
+ * @return Updated CRC.
+ */
+constexpr uint32_t crc32n_bits(uint32_t crc, uint32_t poly, int bits)
+{
+	return (bits == 0 ? crc : crc32n_bits(
+		(crc & 0x80000000U) ? ((crc << 1) ^ poly) : (crc << 1),
+		poly, bits - 1));
+}
+
+/**
+ * Get a non-reflected CRC-32 slicing table entry.
+ * @param poly Polynomial.
+ * @param k Table index. (number of trailing zero bytes)
+ * @param n Byte value.
+ * @return Table entry.
+ */
+constexpr uint32_t crc32n_entry(uint32_t poly, unsigned int k, unsigned int n)
+{
+	return (k == 0 ? crc32n_bits(n << 24, poly, 8) :
+		((crc32n_entry(poly, k-1, n) << 8) ^
+		 crc32n_bits(crc32n_entry(poly, k-1, n) & 0xFF000000U, poly, 8)));
+}
+
+/**
+ * Generate a reflected CRC-32 slicing table.
+ * @param poly Polynomial. (reflected)
+ * @return Slicing table.
+ */
+template<unsigned int... Is>
+constexpr Crc32SliceTable crc32r_table(uint32_t poly, IndexSeq<Is...>)
+{
+	return {{
+		CRC_SLICE_ROW(crc32r_entry, 0), CRC_SLICE_ROW(crc32r_entry, 1),
+		CRC_SLICE_ROW(crc32r_entry, 2), CRC_SLICE_ROW(crc32r_entry, 3),
+		CRC_SLICE_ROW(crc32r_entry, 4), CRC_SLICE_ROW(crc32r_entry, 5),
+		CRC_SLICE_ROW(crc32r_entry, 6), CRC_SLICE_ROW(crc32r_entry, 7),
+	}};
+}
+
+/**
+ * Generate a non-reflected CRC-32 slicing table.
+ * @param poly Polynomial.
+ * @return Slicing table.
+ */
+template<unsigned int... Is>
+constexpr Crc32SliceTable crc32n_table(uint32_t poly, IndexSeq<Is...>)
+{
+	return {{
+		CRC_SLICE_ROW(crc32n_entry, 0), CRC_SLICE_ROW(crc32n_entry, 1),
+		CRC_SLICE_ROW(crc32n_entry, 2), CRC_SLICE_ROW(crc32n_entry, 3),
+		CRC_SLICE_ROW(crc32n_entry, 4), CRC_SLICE_ROW(crc32n_entry, 5),
+		CRC_SLICE_ROW(crc32n_entry, 6), CRC_SLICE_ROW(crc32n_entry, 7),
+	}};
+}
+
+#undef CRC_SLICE_ROW
+
+// Compile-time table for the zlib polynomial.
+static constexpr Crc32SliceTable crc32_zlib_table =
+	crc32r_table(CRC32_POLY_ZLIB, MakeIndexSeq<256>::type());
+
+/**
+ * CRC-32 parameters for a polynomial.
+ */
+struct Crc32Params {
+	// Slicing table.
+	const Crc32SliceTable *table;
+	unique_ptr<Crc32SliceTable> ownTable;
+
+	// PCLMULQDQ folding constants. (reflected CRCs only)
+	// Each constant is bitrev32(x^n mod P) << 1.
+	uint64_t k1k2[2];	// n = 4*128+32, 4*128-32 (fold by 4)
+	uint64_t k3k4[2];	// n = 128+32, 128-32 (fold by 1)
+	uint64_t k5k0[2];	// n = 64 (fold 96 to 64 bits)
+	uint64_t poly_mu[2];	// Barrett reduction: P', mu'
+};
+
+/**
+ * Calculate x^n mod P.
+ * @param n Exponent.
+ * @param poly Polynomial. (non-reflected, without the x^32 term)
+ * @return x^n mod P.
+ */
+static uint32_t crc32_xpow_mod(unsigned int n, uint32_t poly)
+{
+	uint32_t r = 1;
+	for (; n > 0; n--) {
+		r = (r & 0x80000000U) ? ((r << 1) ^ poly) : (r << 1);
+	}
+	return r;
+}
+
+/**
+ * Reverse the bits in a 32-bit value.
+ * @param v Value.
+ * @return Reversed value.
+ */
+static inline uint32_t bitrev32(uint32_t v)
+{
+	uint32_t r = 0;
+	for (int i = 32; i > 0; i--, v >>= 1) {
+		r = (r << 1) | (v & 1);
+	}
+	return r;
+}
+
+/**
+ * Initialize the PCLMULQDQ folding constants for a reflected polynomial.
+ * @param params CRC-32 parameters.
+ * @param poly Polynomial. (reflected)
+ */
+static void crc32r_init_fold_constants(Crc32Params *params, uint32_t poly)
+{
+	const uint32_t npoly = bitrev32(poly);
+	#define FOLD_K(n) ((uint64_t)bitrev32(crc32_xpow_mod((n), npoly)) << 1)
+	params->k1k2[0] = FOLD_K(4*128+32);
+	params->k1k2[1] = FOLD_K(4*128-32);
+	params->k3k4[0] = FOLD_K(128+32);
+	params->k3k4[1] = FOLD_K(128-32);
+	params->k5k0[0] = FOLD_K(64);
+	params->k5k0[1] = 0;
+	#undef FOLD_K
+
+	// mu = floor(x^64 / P), a 33-bit value.
+	// Long division over GF(2), with P = x^32 + npoly.
+	uint64_t rem = 0;
+	uint64_t mu = 0;
+	for (int bit = 64; bit >= 0; bit--) {
+		rem = (rem << 1) | (bit == 64 ? 1 : 0);
+		if (rem & (1ULL << 32)) {
+			rem ^= (1ULL << 32) | npoly;
+			mu |= (1ULL << bit);
+		}
+	}
+
+	// P' and mu' are the 33-bit bit-reversed values.
+	params->poly_mu[0] = ((uint64_t)poly << 1) | 1;
+	params->poly_mu[1] = ((uint64_t)bitrev32((uint32_t)mu) << 1) | (mu >> 32);
+}
+
+/**
+ * Get the CRC-32 parameters for the specified polynomial.
+ * Parameters are generated on first use and cached.
+ * This function is thread-safe.
+ * @param poly Polynomial. (reflected if reflected == true)
+ * @param reflected True for a reflected CRC.
+ * @return CRC-32 parameters.
+ */
+static const Crc32Params *getCrc32Params(uint32_t poly, bool reflected)
+{
+	static mutex paramsMutex;
+	static unordered_map<uint64_t, unique_ptr<Crc32Params> > paramsCache;
+
+	lock_guard<mutex> lock(paramsMutex);
+	unique_ptr<Crc32Params> &params = paramsCache[((uint64_t)reflected << 32) | poly];
+	if (!params) {
+		params.reset(new Crc32Params);
+		if (reflected) {
+			if (poly == CRC32_POLY_ZLIB) {
+				params->table = &crc32_zlib_table;
+			} else {
+				params->ownTable.reset(new Crc32SliceTable(
+					crc32r_table(poly, MakeIndexSeq<256>::type())));
+				params->table = params->ownTable.get();
+			}
+			crc32r_init_fold_constants(params.get(), poly);
+		} else {
+			params->ownTable.reset(new Crc32SliceTable(
+				crc32n_table(poly, MakeIndexSeq<256>::type())));
+			params->table = params->ownTable.get();
+			memset(params->k1k2, 0, sizeof(params->k1k2));
+			memset(params->k3k4, 0, sizeof(params->k3k4));
+			memset(params->k5k0, 0, sizeof(params->k5k0));
+			memset(params->poly_mu, 0, sizeof(params->poly_mu));
+		}
+	}
+	return params.get();
+}
+
+/**
+ * Update a reflected CRC-32 using a slicing table.
+ * @param t Slicing table.
+ * @param crc Current CRC.
  * @param buf Data buffer.
  * @param siz Length of data buffer.
- * @param endian Endianness of the data.
+ * @return Updated CRC.
+ */
+static inline uint32_t crc32r_update(const Crc32SliceTable &t, uint32_t crc, const uint8_t *buf, uint32_t siz)
+{
+	// Do eight bytes at a time.
+	for (; siz >= 8; siz -= 8, buf += 8) {
+		crc ^= (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+		       ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+		crc = t.tbl[7][crc & 0xFF] ^ t.tbl[6][(crc >> 8) & 0xFF] ^
+		      t.tbl[5][(crc >> 16) & 0xFF] ^ t.tbl[4][crc >> 24] ^
+		      t.tbl[3][buf[4]] ^ t.tbl[2][buf[5]] ^
+		      t.tbl[1][buf[6]] ^ t.tbl[0][buf[7]];
+	}
+
+	// Remaining bytes.
+	for (; siz != 0; siz--, buf++) {
+		crc = (crc >> 8) ^ t.tbl[0][(crc ^ *buf) & 0xFF];
+	}
+	return crc;
+}
+
+/**
+ * Update a non-reflected CRC-32 using a slicing table.
+ * @param t Slicing table.
+ * @param crc Current CRC.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @return Updated CRC.
+ */
+static inline uint32_t crc32n_update(const Crc32SliceTable &t, uint32_t crc, const uint8_t *buf, uint32_t siz)
+{
+	// Do eight bytes at a time.
+	for (; siz >= 8; siz -= 8, buf += 8) {
+		crc ^= ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) |
+		       ((uint32_t)buf[2] << 8) | (uint32_t)buf[3];
+		crc = t.tbl[7][crc >> 24] ^ t.tbl[6][(crc >> 16) & 0xFF] ^
+		      t.tbl[5][(crc >> 8) & 0xFF] ^ t.tbl[4][crc & 0xFF] ^
+		      t.tbl[3][buf[4]] ^ t.tbl[2][buf[5]] ^
+		      t.tbl[1][buf[6]] ^ t.tbl[0][buf[7]];
+	}
+
+	// Remaining bytes.
+	for (; siz != 0; siz--, buf++) {
+		crc = (crc << 8) ^ t.tbl[0][(crc >> 24) ^ *buf];
+	}
+	return crc;
+}
+
+#ifdef CPUFLAGS_X86
+/**
+ * Update a reflected CRC-32 using PCLMULQDQ folding.
+ * Reference: Intel, "Fast CRC Computation for Generic Polynomials
+ * Using PCLMULQDQ Instruction" (2009)
+ * @param params CRC-32 parameters.
+ * @param crc Current CRC.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer. (must be >= 64 and a multiple of 16)
+ * @return Updated CRC.
+ */
+CPUFLAGS_TARGET("sse2,pclmul")
+static uint32_t crc32r_update_pclmul(const Crc32Params *params, uint32_t crc, const uint8_t *buf, uint32_t siz)
+{
+	const __m128i *pbuf = reinterpret_cast<const __m128i*>(buf);
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+	// Load the first 64 bytes and XOR in the initial CRC.
+	x1 = _mm_loadu_si128(pbuf + 0);
+	x2 = _mm_loadu_si128(pbuf + 1);
+	x3 = _mm_loadu_si128(pbuf + 2);
+	x4 = _mm_loadu_si128(pbuf + 3);
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+	x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(params->k1k2));
+	pbuf += 4;
+	siz -= 64;
+
+	// Fold by 4.
+	while (siz >= 64) {
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(pbuf + 0));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(pbuf + 1));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(pbuf + 2));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(pbuf + 3));
+		pbuf += 4;
+		siz -= 64;
+	}
+
+	// Fold into a single 128-bit value.
+	x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(params->k3k4));
+	#define FOLD_1(xa, xb) do { \
+		x5 = _mm_clmulepi64_si128(xa, x0, 0x00); \
+		xa = _mm_clmulepi64_si128(xa, x0, 0x11); \
+		xa = _mm_xor_si128(_mm_xor_si128(xa, x5), xb); \
+	} while (0)
+	FOLD_1(x1, x2);
+	FOLD_1(x1, x3);
+	FOLD_1(x1, x4);
+
+	// Fold any remaining 16-byte blocks.
+	for (; siz >= 16; siz -= 16, pbuf++) {
+		x2 = _mm_loadu_si128(pbuf);
+		FOLD_1(x1, x2);
+	}
+	#undef FOLD_1
+
+	// Fold 128 bits to 64 bits.
+	const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+	x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+	x1 = _mm_srli_si128(x1, 8);
+	x1 = _mm_xor_si128(x1, x2);
+	x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(params->k5k0));
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, mask32);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// Barrett reduction to 32 bits.
+	x0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(params->poly_mu));
+	x2 = _mm_and_si128(x1, mask32);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+	x2 = _mm_and_si128(x2, mask32);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+	return (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(x1, 4));
+}
+#endif /* CPUFLAGS_X86 */
+
+}
+
+/**
+ * CRC-32 algorithm.
+ * Table-driven version using slicing-by-8.
+ * For reflected polynomials, PCLMULQDQ is used if supported by the CPU.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @param poly Polynomial. (reflected if reflected == true)
+ * @param init Initial value.
+ * @param xorout Final XOR value.
+ * @param reflected True for a reflected (LSB-first) CRC.
  * @return Checksum.
  */
-uint32_t AddInvDual16(const uint16_t *buf, uint32_t siz, ChkEndian endian)
+uint32_t Crc32(const uint8_t *buf, uint32_t siz, uint32_t poly,
+	       uint32_t init, uint32_t xorout, bool reflected)
 {
-	// We're operating on words, not bytes.
-	// siz is in bytes, so we have to divide it by two.
-	siz /= 2;
+	const Crc32Params *const params = getCrc32Params(poly, reflected);
+	uint32_t crc = init;
 
-	// NOTE: Integer overflow/underflow is expected here.
-	uint16_t chk1 = 0;
-	uint16_t chk2 = (uint16_t)(-(int)siz);
+	if (!reflected) {
+		crc = crc32n_update(*params->table, crc, buf, siz);
+		return crc ^ xorout;
+	}
+
+#ifdef CPUFLAGS_X86
+	if (siz >= 64 && (cpuflags_get() & CPUFLAG_X86_PCLMULQDQ)) {
+		// Fold as many 16-byte blocks as possible.
+		const uint32_t len = (siz & ~15U);
+		crc = crc32r_update_pclmul(params, crc, buf, len);
+		buf += len;
+		siz -= len;
+	}
+#endif /* CPUFLAGS_X86 */
+
+	crc = crc32r_update(*params->table, crc, buf, siz);
+	return crc ^ xorout;
+}
+
+/**
+ * CRC-32 algorithm.
+ * Table-driven version using slicing-by-8, without PCLMULQDQ.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @param poly Polynomial. (reflected if reflected == true)
+ * @param init Initial value.
+ * @param xorout Final XOR value.
+ * @param reflected True for a reflected (LSB-first) CRC.
+ * @return Checksum.
+ */
+uint32_t Crc32_table(const uint8_t *buf, uint32_t siz, uint32_t poly,
+		     uint32_t init, uint32_t xorout, bool reflected)
+{
+	const Crc32Params *const params = getCrc32Params(poly, reflected);
+	const uint32_t crc = (reflected
+		? crc32r_update(*params->table, init, buf, siz)
+		: crc32n_update(*params->table, init, buf, siz));
+	return crc ^ xorout;
+}
+
+/**
+ * CRC-32 algorithm.
+ * Bitwise reference version.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @param poly Polynomial. (reflected if reflected == true)
+ * @param init Initial value.
+ * @param xorout Final XOR value.
+ * @param reflected True for a reflected (LSB-first) CRC.
+ * @return Checksum.
+ */
+uint32_t Crc32_bitwise(const uint8_t *buf, uint32_t siz, uint32_t poly,
+		       uint32_t init, uint32_t xorout, bool reflected)
+{
+	uint32_t crc = init;
+
+	for (; siz != 0; siz--, buf++) {
+		if (reflected) {
+			crc ^= *buf;
+			for (int i = 8; i > 0; i--) {
+				if (crc & 1)
+					crc = ((crc >> 1) ^ poly);
+				else
+					crc >>= 1;
+			}
+		} else {
+			crc ^= ((uint32_t)*buf << 24);
+			for (int i = 8; i > 0; i--) {
+				if (crc & 0x80000000U)
+					crc = ((crc << 1) ^ poly);
+				else
+					crc <<= 1;
+			}
+		}
+	}
+
+	return crc ^ xorout;
+}
+
+/** AddInvDual16 / AddBytes32 kernels. **/
+
+namespace {
+
+/**
+ * Sum 16-bit words.
+ * Standard version. (No SIMD)
+ * @param buf Data buffer.
+ * @param words Number of words.
+ * @param endian Endianness of the data.
+ * @return Sum of all words. (mod 2^16)
+ */
+static uint16_t Sum16_c(const uint16_t *buf, uint32_t words, ChkEndian endian)
+{
+	// NOTE: Integer overflow is expected here.
+	uint16_t sum = 0;
 
 	if (endian != CHKENDIAN_LITTLE) {
 		// Big-endian system. (PowerPC, etc.)
 		// Do four words at a time.
-		// TODO: Optimize byteswapping?
-		for (; siz > 4; siz -= 4, buf += 4) {
-			chk1 += be16_to_cpu(buf[0]);
-			chk1 += be16_to_cpu(buf[1]);
-			chk1 += be16_to_cpu(buf[2]);
-			chk1 += be16_to_cpu(buf[3]);
+		for (; words > 4; words -= 4, buf += 4) {
+			sum += be16_to_cpu(buf[0]);
+			sum += be16_to_cpu(buf[1]);
+			sum += be16_to_cpu(buf[2]);
+			sum += be16_to_cpu(buf[3]);
 		}
 
 		// Remaining words.
-		for (; siz != 0; siz--, buf++) {
-			chk1 += be16_to_cpu(*buf);
+		for (; words != 0; words--, buf++) {
+			sum += be16_to_cpu(*buf);
 		}
 	} else {
 		// Little-endian system. (x86, SH-4, etc.)
 		// Do four words at a time.
-		// TODO: Optimize byteswapping?
-		for (; siz > 4; siz -= 4, buf += 4) {
-			chk1 += le16_to_cpu(buf[0]);
-			chk1 += le16_to_cpu(buf[1]);
-			chk1 += le16_to_cpu(buf[2]);
-			chk1 += le16_to_cpu(buf[3]);
+		for (; words > 4; words -= 4, buf += 4) {
+			sum += le16_to_cpu(buf[0]);
+			sum += le16_to_cpu(buf[1]);
+			sum += le16_to_cpu(buf[2]);
+			sum += le16_to_cpu(buf[3]);
 		}
 
 		// Remaining words.
-		for (; siz != 0; siz--, buf++) {
-			chk1 += le16_to_cpu(*buf);
+		for (; words != 0; words--, buf++) {
+			sum += le16_to_cpu(*buf);
 		}
 	}
-	
+
+	return sum;
+}
+
+/**
+ * Sum bytes.
+ * Standard version. (No SIMD)
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @return Sum of all bytes. (mod 2^32)
+ */
+static uint32_t SumBytes_c(const uint8_t *buf, uint32_t siz)
+{
+	uint32_t checksum = 0;
+
+	// Do four bytes at a time.
+	for (; siz > 4; siz -= 4, buf += 4) {
+		checksum += buf[0];
+		checksum += buf[1];
+		checksum += buf[2];
+		checksum += buf[3];
+	}
+
+	// Remaining bytes.
+	for (; siz != 0; siz--, buf++)
+		checksum += *buf;
+
+	return checksum;
+}
+
+#ifdef CPUFLAGS_X86
+/**
+ * Sum 16-bit words.
+ * SSE2-optimized version.
+ * @param buf Data buffer.
+ * @param words Number of words.
+ * @param endian Endianness of the data.
+ * @return Sum of all words. (mod 2^16)
+ */
+CPUFLAGS_TARGET("sse2")
+static uint16_t Sum16_sse2(const uint16_t *buf, uint32_t words, ChkEndian endian)
+{
+	// paddw wraps around at 16 bits, so each lane is a
+	// partial sum (mod 2^16) that can be added together later.
+	__m128i acc0 = _mm_setzero_si128();
+	__m128i acc1 = _mm_setzero_si128();
+	const bool swap = (endian != CHKENDIAN_LITTLE);
+
+	// Do 16 words at a time.
+	for (; words >= 16; words -= 16, buf += 16) {
+		__m128i w0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&buf[0]));
+		__m128i w1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&buf[8]));
+		if (swap) {
+			// SSE2 doesn't have pshufb, so swap the bytes using shifts.
+			w0 = _mm_or_si128(_mm_slli_epi16(w0, 8), _mm_srli_epi16(w0, 8));
+			w1 = _mm_or_si128(_mm_slli_epi16(w1, 8), _mm_srli_epi16(w1, 8));
+		}
+		acc0 = _mm_add_epi16(acc0, w0);
+		acc1 = _mm_add_epi16(acc1, w1);
+	}
+
+	// Horizontal sum.
+	acc0 = _mm_add_epi16(acc0, acc1);
+	acc0 = _mm_add_epi16(acc0, _mm_srli_si128(acc0, 8));
+	acc0 = _mm_add_epi16(acc0, _mm_srli_si128(acc0, 4));
+	acc0 = _mm_add_epi16(acc0, _mm_srli_si128(acc0, 2));
+	const uint16_t sum = (uint16_t)_mm_cvtsi128_si32(acc0);
+
+	// Remaining words.
+	return sum + Sum16_c(buf, words, endian);
+}
+
+/**
+ * Sum 16-bit words.
+ * AVX2-optimized version.
+ * @param buf Data buffer.
+ * @param words Number of words.
+ * @param endian Endianness of the data.
+ * @return Sum of all words. (mod 2^16)
+ */
+CPUFLAGS_TARGET("avx2")
+static uint16_t Sum16_avx2(const uint16_t *buf, uint32_t words, ChkEndian endian)
+{
+	__m256i acc0 = _mm256_setzero_si256();
+	__m256i acc1 = _mm256_setzero_si256();
+	const bool swap = (endian != CHKENDIAN_LITTLE);
+	const __m256i shuf_bswap16 = _mm256_setr_epi8(
+		1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14,
+		1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+
+	// Do 32 words at a time.
+	for (; words >= 32; words -= 32, buf += 32) {
+		__m256i w0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&buf[0]));
+		__m256i w1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&buf[16]));
+		if (swap) {
+			w0 = _mm256_shuffle_epi8(w0, shuf_bswap16);
+			w1 = _mm256_shuffle_epi8(w1, shuf_bswap16);
+		}
+		acc0 = _mm256_add_epi16(acc0, w0);
+		acc1 = _mm256_add_epi16(acc1, w1);
+	}
+
+	// Horizontal sum.
+	acc0 = _mm256_add_epi16(acc0, acc1);
+	__m128i acc = _mm_add_epi16(_mm256_castsi256_si128(acc0),
+				    _mm256_extracti128_si256(acc0, 1));
+	acc = _mm_add_epi16(acc, _mm_srli_si128(acc, 8));
+	acc = _mm_add_epi16(acc, _mm_srli_si128(acc, 4));
+	acc = _mm_add_epi16(acc, _mm_srli_si128(acc, 2));
+	const uint16_t sum = (uint16_t)_mm_cvtsi128_si32(acc);
+
+	// Remaining words.
+	return sum + Sum16_c(buf, words, endian);
+}
+
+/**
+ * Sum bytes.
+ * SSE2-optimized version.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @return Sum of all bytes. (mod 2^32)
+ */
+CPUFLAGS_TARGET("sse2")
+static uint32_t SumBytes_sse2(const uint8_t *buf, uint32_t siz)
+{
+	// psadbw against zero sums each group of 8 bytes
+	// into a 64-bit lane.
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc0 = _mm_setzero_si128();
+	__m128i acc1 = _mm_setzero_si128();
+
+	// Do 32 bytes at a time.
+	for (; siz >= 32; siz -= 32, buf += 32) {
+		const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&buf[0]));
+		const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&buf[16]));
+		acc0 = _mm_add_epi64(acc0, _mm_sad_epu8(b0, zero));
+		acc1 = _mm_add_epi64(acc1, _mm_sad_epu8(b1, zero));
+	}
+
+	// Horizontal sum.
+	acc0 = _mm_add_epi64(acc0, acc1);
+	acc0 = _mm_add_epi64(acc0, _mm_srli_si128(acc0, 8));
+	const uint32_t sum = (uint32_t)_mm_cvtsi128_si32(acc0);
+
+	// Remaining bytes.
+	return sum + SumBytes_c(buf, siz);
+}
+
+/**
+ * Sum bytes.
+ * AVX2-optimized version.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @return Sum of all bytes. (mod 2^32)
+ */
+CPUFLAGS_TARGET("avx2")
+static uint32_t SumBytes_avx2(const uint8_t *buf, uint32_t siz)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc0 = _mm256_setzero_si256();
+	__m256i acc1 = _mm256_setzero_si256();
+
+	// Do 64 bytes at a time.
+	for (; siz >= 64; siz -= 64, buf += 64) {
+		const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&buf[0]));
+		const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&buf[32]));
+		acc0 = _mm256_add_epi64(acc0, _mm256_sad_epu8(b0, zero));
+		acc1 = _mm256_add_epi64(acc1, _mm256_sad_epu8(b1, zero));
+	}
+
+	// Horizontal sum.
+	acc0 = _mm256_add_epi64(acc0, acc1);
+	__m128i acc = _mm_add_epi64(_mm256_castsi256_si128(acc0),
+				    _mm256_extracti128_si256(acc0, 1));
+	acc = _mm_add_epi64(acc, _mm_srli_si128(acc, 8));
+	const uint32_t sum = (uint32_t)_mm_cvtsi128_si32(acc);
+
+	// Remaining bytes.
+	return sum + SumBytes_c(buf, siz);
+}
+#endif /* CPUFLAGS_X86 */
+
+/**
+ * Sum 16-bit words.
+ * SSE2 or AVX2 is used if supported by the CPU.
+ * @param buf Data buffer.
+ * @param words Number of words.
+ * @param endian Endianness of the data.
+ * @return Sum of all words. (mod 2^16)
+ */
+static inline uint16_t Sum16(const uint16_t *buf, uint32_t words, ChkEndian endian)
+{
+#ifdef CPUFLAGS_X86
+	const uint32_t flags = cpuflags_get();
+	if (flags & CPUFLAG_X86_AVX2) {
+		return Sum16_avx2(buf, words, endian);
+	} else if (flags & CPUFLAG_X86_SSE2) {
+		return Sum16_sse2(buf, words, endian);
+	}
+#endif /* CPUFLAGS_X86 */
+	return Sum16_c(buf, words, endian);
+}
+
+/**
+ * Sum bytes.
+ * SSE2 or AVX2 is used if supported by the CPU.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @return Sum of all bytes. (mod 2^32)
+ */
+static inline uint32_t SumBytes(const uint8_t *buf, uint32_t siz)
+{
+#ifdef CPUFLAGS_X86
+	const uint32_t flags = cpuflags_get();
+	if (flags & CPUFLAG_X86_AVX2) {
+		return SumBytes_avx2(buf, siz);
+	} else if (flags & CPUFLAG_X86_SSE2) {
+		return SumBytes_sse2(buf, siz);
+	}
+#endif /* CPUFLAGS_X86 */
+	return SumBytes_c(buf, siz);
+}
+
+/**
+ * Finish an AddInvDual16 checksum.
+ * @param chk1 Sum of all words.
+ * @param words Number of words.
+ * @return Checksum.
+ */
+static inline uint32_t AddInvDual16_finish(uint16_t chk1, uint32_t words)
+{
 	// sum(word ^ 0xFFFF) = sum(0xFFFF - word) = 0xFFFF * siz - sum(word)
 	// On 16 bits using two's complement, 0xFFFF = -1, so chk2 can be simplified as -siz - chk1.
+	// NOTE: Integer overflow/underflow is expected here.
+	uint16_t chk2 = (uint16_t)(-(int)words);
 	chk2 -= chk1;
 
 	// 0xFFFF is an invalid checksum value.
@@ -121,30 +1031,65 @@ uint32_t AddInvDual16(const uint16_t *buf, uint32_t siz, ChkEndian endian)
 	return ((chk1 << 16) | chk2);
 }
 
+}
+
+/**
+ * AddInvDual16 algorithm.
+ * Adds 16-bit words together in a uint16_t.
+ * First word is a simple addition.
+ * Second word adds (word ^ 0xFFFF).
+ * If either word equals 0xFFFF, it's changed to 0.
+ * SSE2 or AVX2 is used if supported by the CPU.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @param endian Endianness of the data.
+ * @return Checksum.
+ */
+uint32_t AddInvDual16(const uint16_t *buf, uint32_t siz, ChkEndian endian)
+{
+	// We're operating on words, not bytes.
+	// siz is in bytes, so we have to divide it by two.
+	siz /= 2;
+	return AddInvDual16_finish(Sum16(buf, siz, endian), siz);
+}
+
+/**
+ * AddInvDual16 algorithm.
+ * Standard version. (No SIMD)
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @param endian Endianness of the data.
+ * @return Checksum.
+ */
+uint32_t AddInvDual16_c(const uint16_t *buf, uint32_t siz, ChkEndian endian)
+{
+	siz /= 2;
+	return AddInvDual16_finish(Sum16_c(buf, siz, endian), siz);
+}
+
 /**
  * AddBytes32 algorithm.
  * Adds all bytes together in a uint32_t.
+ * SSE2 or AVX2 is used if supported by the CPU.
  * @param buf Data buffer.
  * @param siz Length of data buffer.
  * @return Checksum.
  */
 uint32_t AddBytes32(const uint8_t *buf, uint32_t siz)
 {
-	uint32_t checksum = 0;
-
-	// Do four bytes at a time.
-	for (; siz > 4; siz -= 4, buf += 4) {
-		checksum += buf[0];
-		checksum += buf[1];
-		checksum += buf[2];
-		checksum += buf[3];
-	}
-
-	// Remaining bytes.
-	for (; siz != 0; siz--, buf++)
-		checksum += *buf;
+	return SumBytes(buf, siz);
+}
 
-	return checksum;
+/**
+ * AddBytes32 algorithm.
+ * Standard version. (No SIMD)
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @return Checksum.
+ */
+uint32_t AddBytes32_c(const uint8_t *buf, uint32_t siz)
+{
+	return SumBytes_c(buf, siz);
 }
 
 /**
@@ -169,6 +1114,7 @@ uint32_t SonicChaoGarden(const uint8_t *buf, uint32_t siz)
 /**
  * Dreamcast VMU algorithm.
  * Based on FCS-16.
+ * Table-driven version using slicing-by-8.
  *
  * NOTE: The CRC is stored within the header.
  * Specify the address in crc_addr in order to
@@ -182,7 +1128,44 @@ uint32_t SonicChaoGarden(const uint8_t *buf, uint32_t siz)
  */
 uint16_t DreamcastVMU(const uint8_t *buf, uint32_t siz, uint32_t crc_addr)
 {
-	// TODO: Optimize this?
+	// The two bytes at crc_addr are treated as 0.
+	// NOTE: crc_addr+1 wraps around to 0 if crc_addr == -1.
+	// This matches the bitwise version.
+	uint32_t zero_addr[2] = {crc_addr, crc_addr + 1};
+	if (zero_addr[1] < zero_addr[0]) {
+		std::swap(zero_addr[0], zero_addr[1]);
+	}
+
+	static const uint8_t zero_byte = 0;
+	uint16_t crc = 0;
+	uint32_t pos = 0;
+	for (int i = 0; i < 2; i++) {
+		if (zero_addr[i] >= siz)
+			break;
+		crc = crc16n_update(crc16_dcvmu_table, crc, &buf[pos], zero_addr[i] - pos);
+		crc = crc16n_update(crc16_dcvmu_table, crc, &zero_byte, 1);
+		pos = zero_addr[i] + 1;
+	}
+	return crc16n_update(crc16_dcvmu_table, crc, &buf[pos], siz - pos);
+}
+
+/**
+ * Dreamcast VMU algorithm.
+ * Based on FCS-16.
+ * Bitwise reference version.
+ *
+ * NOTE: The CRC is stored within the header.
+ * Specify the address in crc_addr in order to
+ * handle this properly. (Set to -1 to skip.)
+ * The usual address is 0x46.
+ *
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @param crc_addr Address of CRC in header.
+ * @return Checksum.
+ */
+uint16_t DreamcastVMU_bitwise(const uint8_t *buf, uint32_t siz, uint32_t crc_addr)
+{
 	// Reference: http://mc.pp.se/dc/vms/fileheader.html
 	unsigned int n = 0;
 	for (uint32_t i = 0; i < siz; i++) {
@@ -211,55 +1194,72 @@ uint16_t DreamcastVMU(const uint8_t *buf, uint32_t siz, uint32_t crc_addr)
  * The data area is "encrypted", so it has to be decrypted before
  * a checksum can be calculated.
  *
+ * This calculates all four checksums in a single pass. The data
+ * is decrypted on the fly, so no decryption buffer is needed.
+ *
  * @param buf		[in] Data buffer.
  * @param siz		[in] Length of data buffer.
- * @param crc_addr	[in] CRC address. (Should be 0x10, 0x14, 0x18, 0x1C.)
- * @param pChkExpect	[out] Expected checksum, decrypted.
- * @return Actual checksum, decrypted.
+ * @param values	[out] Checksum values. (4 entries, indexed by (crc_addr >> 2) & 3)
+ * @return 0 on success; non-zero if the buffer is too small.
  */
-uint32_t PokemonXD(const uint8_t *buf, uint32_t siz, uint32_t crc_addr, uint32_t *pChkExpect)
+int PokemonXD_all(const uint8_t *buf, uint32_t siz, ChecksumValue values[4])
 {
-	// TODO: There's four 32-bit checksums. We should rework
-	// the checksum system so we don't have to decrypt the
-	// save data four times, once for each checksum.
-	static const uint32_t checksum_size = (0x9FF4*4)+8;
-	if (siz < (0x9FF4*4)+8) {
+	// Each checksum covers 0x9FF4 bytes, starting at 0x08.
+	static const uint32_t region_size = 0x9FF4;
+	static const uint32_t checksum_size = (region_size*4)+8;
+	if (siz < checksum_size) {
 		// Incorrect buffer size.
-		if (pChkExpect) {
-			*pChkExpect = 0;
+		for (unsigned int i = 0; i < 4; i++) {
+			values[i].expected = 0;
+			values[i].actual = ~0U;
 		}
-		return ~0U;
+		return -1;
 	}
 
 	// All fields are in big-endian.
-	struct PokemonXDHeader {
-		uint32_t magic;		// [0x000] 0x01010100
-		uint32_t save_count;	// [0x004] Number of times the game has been saved.
-		uint16_t enc_keys[4];	// [0x008] Encryption keys
-
-		// The following data is all encrypted.
-		uint32_t checksum[4];	// [0x010] Checksums
-	};
-
-	// Decryption buffer.
-	unique_ptr<uint8_t[]> decbuf(new uint8_t[checksum_size]);
-	memcpy(decbuf.get(), buf, 16);
-
-	// Decrypt the data.
-	PokemonXDHeader *const pHdr = reinterpret_cast<PokemonXDHeader*>(decbuf.get());
+	// Header layout:
+	// - [0x000] uint32_t magic: 0x01010100
+	// - [0x004] uint32_t save_count: Number of times the game has been saved.
+	// - [0x008] uint16_t enc_keys[4]: Encryption keys
+	// The following data is all encrypted.
+	// - [0x010] uint32_t checksum[4]: Checksums
+	const uint16_t *psrcbuf16 = reinterpret_cast<const uint16_t*>(buf) + 4;
 	uint16_t keys[4];
-	keys[0] = be16_to_cpu(pHdr->enc_keys[0]);
-	keys[1] = be16_to_cpu(pHdr->enc_keys[1]);
-	keys[2] = be16_to_cpu(pHdr->enc_keys[2]);
-	keys[3] = be16_to_cpu(pHdr->enc_keys[3]);
-
-	const uint16_t *psrcbuf16 = reinterpret_cast<const uint16_t*>(buf) + 8;
-	uint16_t *pdestbuf16 = reinterpret_cast<uint16_t*>(decbuf.get()) + 8;
-	for (size_t i = 16; i < checksum_size; i += 8) {
-		for (unsigned int j = 0; j < 4; j++, psrcbuf16++, pdestbuf16++) {
+	keys[0] = be16_to_cpu(psrcbuf16[0]);
+	keys[1] = be16_to_cpu(psrcbuf16[1]);
+	keys[2] = be16_to_cpu(psrcbuf16[2]);
+	keys[3] = be16_to_cpu(psrcbuf16[3]);
+	psrcbuf16 += 4;
+
+	// Checksum sums, indexed by data region.
+	// The encryption keys are part of the first region.
+	uint32_t sums[4] = {0, 0, 0, 0};
+	sums[0] = (uint32_t)keys[0] + keys[1] + keys[2] + keys[3];
+
+	// Decrypted checksum words from the header.
+	uint16_t chkWords[8];
+
+	unsigned int region = 0;
+	uint32_t region_end = 8 + region_size;
+	uint32_t pos = 16;
+	for (; pos < checksum_size; ) {
+		for (unsigned int j = 0; j < 4; j++, psrcbuf16++, pos += 2) {
 			uint16_t tmp = be16_to_cpu(*psrcbuf16);
 			tmp -= keys[j];
-			*pdestbuf16 = cpu_to_be16(tmp);
+
+			if (pos < 0x20) {
+				// Checksum field.
+				// This is zeroed out when calculating the checksums.
+				chkWords[(pos - 0x10) / 2] = tmp;
+			} else {
+				sums[region] += tmp;
+			}
+
+			if (pos + 2 == region_end) {
+				// Next region.
+				region++;
+				region_end += region_size;
+			}
 		}
 
 		// Advance the keys.
@@ -274,34 +1274,43 @@ uint32_t PokemonXD(const uint8_t *buf, uint32_t siz, uint32_t crc_addr, uint32_t
 		keys[3] = ((a >> 12) & 0xf) | ((b >> 8) & 0xf0) | ((c >> 4) & 0xf00) | (d & 0xf000);
 	}
 
-	// Get the expected checksum.
-	// NOTE: Checksum is stored weirdly:
+	// NOTE: Checksums are stored weirdly:
 	// - ID is reversed.
 	// - Checksum is stored wordswapped.
 	// We'll use crc_addr as the checksum ID in the header,
 	// then do a reverse when checking the actual data area.
-	const unsigned int chkID = (crc_addr >> 2) & 3;
-	uint32_t chk_expect = be32_to_cpu(pHdr->checksum[chkID]);
-	chk_expect = (chk_expect << 16) | (chk_expect >> 16);
-	if (pChkExpect) {
-		*pChkExpect = chk_expect;
+	for (unsigned int chkID = 0; chkID < 4; chkID++) {
+		values[chkID].expected = ((uint32_t)chkWords[(chkID*2)+1] << 16) | chkWords[chkID*2];
+		values[chkID].actual = sums[chkID ^ 3];
 	}
+	return 0;
+}
 
-	// Calculate the actual checksum.
-	// NOTE: Checksum values should be zeroed out here.
-	pHdr->checksum[0] = 0;
-	pHdr->checksum[1] = 0;
-	pHdr->checksum[2] = 0;
-	pHdr->checksum[3] = 0;
+/**
+ * Pokémon XD algorithm.
+ * Reference: https://github.com/TuxSH/PkmGCTools/blob/master/LibPkmGC/src/LibPkmGC/XD/SaveEditing/SaveSlot.cpp
+ *
+ * The data area is "encrypted", so it has to be decrypted before
+ * a checksum can be calculated.
+ *
+ * NOTE: If more than one checksum is needed, use PokemonXD_all().
+ *
+ * @param buf		[in] Data buffer.
+ * @param siz		[in] Length of data buffer.
+ * @param crc_addr	[in] CRC address. (Should be 0x10, 0x14, 0x18, 0x1C.)
+ * @param pChkExpect	[out] Expected checksum, decrypted.
+ * @return Actual checksum, decrypted.
+ */
+uint32_t PokemonXD(const uint8_t *buf, uint32_t siz, uint32_t crc_addr, uint32_t *pChkExpect)
+{
+	ChecksumValue values[4];
+	PokemonXD_all(buf, siz, values);
 
-	// Calculate only the specified checksum.
-	uint32_t chk_actual = 0;
-	psrcbuf16 = reinterpret_cast<const uint16_t*>(&decbuf[0x08]);
-	psrcbuf16 += ((chkID ^ 3) * (0x9FF4/2));
-	for (size_t i = 0; i < 0x9FF4; i += 2, psrcbuf16++) {
-		chk_actual += (uint32_t)be16_to_cpu(*psrcbuf16);
+	const unsigned int chkID = (crc_addr >> 2) & 3;
+	if (pChkExpect) {
+		*pChkExpect = values[chkID].expected;
 	}
-	return chk_actual;
+	return values[chkID].actual;
 }
 
 /** General functions. **/
@@ -325,8 +1334,11 @@ uint32_t Exec(ChkAlgorithm algorithm, const void *buf, uint32_t siz, ChkEndian e
 				     siz, (uint16_t)(param & 0xFFFF));
 
 		case CHKALG_CRC32:
-			// TODO: Implement CRC32 once I encounter a file that uses it.
-			break;
+			// NOTE: Using the default CRC-32 options.
+			// Use Exec(const ChecksumDef&, ...) for other options.
+			if (param == 0)
+				param = CRC32_POLY_ZLIB;
+			return Crc32(static_cast<const uint8_t*>(buf), siz, param);
 
 		case CHKALG_ADDINVDUAL16:
 			return AddInvDual16(static_cast<const uint16_t*>(buf), siz, endian);
@@ -356,6 +1368,85 @@ uint32_t Exec(ChkAlgorithm algorithm, const void *buf, uint32_t siz, ChkEndian e
 	return 0;
 }
 
+/**
+ * Get the checksum for a block of data.
+ * This version uses all options from the checksum definition.
+ * NOTE: checksumDef.start and checksumDef.length are not used.
+ * @param checksumDef Checksum definition.
+ * @param buf Data buffer.
+ * @param siz Length of data buffer.
+ * @return Checksum.
+ */
+uint32_t Exec(const ChecksumDef &checksumDef, const void *buf, uint32_t siz)
+{
+	if (checksumDef.algorithm == CHKALG_CRC32) {
+		const uint32_t poly = (checksumDef.param != 0 ? checksumDef.param : CRC32_POLY_ZLIB);
+		return Crc32(static_cast<const uint8_t*>(buf), siz, poly,
+			checksumDef.crcInit, checksumDef.crcXorOut, checksumDef.crcReflected);
+	}
+
+	return Exec(checksumDef.algorithm, buf, siz, checksumDef.endian, checksumDef.param);
+}
+
+/**
+ * Get the number of checksums an algorithm calculates in a single pass.
+ * @param algorithm Checksum algorithm.
+ * @return Number of checksums, or 0 if the algorithm only calculates one checksum.
+ */
+int MultiCount(ChkAlgorithm algorithm)
+{
+	switch (algorithm) {
+		case CHKALG_POKEMONXD:
+			return 4;
+		default:
+			break;
+	}
+
+	// Single checksum.
+	return 0;
+}
+
+/**
+ * Get the index of a checksum in ExecMulti()'s output.
+ * @param algorithm Checksum algorithm.
+ * @param address Checksum address.
+ * @return Index, or -1 if the algorithm only calculates one checksum.
+ */
+int MultiIndex(ChkAlgorithm algorithm, uint32_t address)
+{
+	switch (algorithm) {
+		case CHKALG_POKEMONXD:
+			return (address >> 2) & 3;
+		default:
+			break;
+	}
+
+	// Single checksum.
+	return -1;
+}
+
+/**
+ * Calculate all checksums for a block of data in a single pass.
+ * This is only supported for algorithms where MultiCount() > 0.
+ * @param algorithm	[in] Checksum algorithm.
+ * @param buf		[in] Data buffer.
+ * @param siz		[in] Length of data buffer.
+ * @param values	[out] Checksum values. (must have MultiCount() entries)
+ * @return 0 on success; non-zero on error.
+ */
+int ExecMulti(ChkAlgorithm algorithm, const void *buf, uint32_t siz, ChecksumValue *values)
+{
+	switch (algorithm) {
+		case CHKALG_POKEMONXD:
+			return PokemonXD_all(static_cast<const uint8_t*>(buf), siz, values);
+		default:
+			break;
+	}
+
+	// Not a multi-checksum algorithm.
+	return -1;
+}
+
 /**
  * Get a ChkAlgorithm from a checksum algorithm name.
  * @param algorithm Checksum algorithm name.
@@ -60,6 +60,12 @@ struct ChecksumDef {
 	uint32_t length;	// Checksummed area: length.
 	ChkEndian endian;	// Endianness.
 
+	// CRC-32 options.
+	// The polynomial is stored in param.
+	uint32_t crcInit;	// Initial value.
+	uint32_t crcXorOut;	// Final XOR value.
+	bool crcReflected;	// True for a reflected (LSB-first) CRC.
+
 	ChecksumDef() { clear(); }
 
 	void clear(void)
@@ -70,6 +76,11 @@ struct ChecksumDef {
 		start = 0;
 		length = 0;
 		endian = CHKENDIAN_BIG;
+
+		// Default CRC-32 options. (zlib)
+		crcInit = 0xFFFFFFFF;
+		crcXorOut = 0xFFFFFFFF;
+		crcReflected = true;
 	}
 };
 
@@ -109,6 +120,7 @@ static const uint16_t ADDSUBDUAL16_SUM_GCN_MEMCARD = 0xFFFF;
 
 /**
 * CRC-16 algorithm.
+* Table-driven version using slicing-by-8.
 * @param buf Data buffer.
 * @param siz Length of data buffer.
 * @param poly Polynomial.
@@ -116,12 +128,66 @@ static const uint16_t ADDSUBDUAL16_SUM_GCN_MEMCARD = 0xFFFF;
 */
 uint16_t Crc16(const uint8_t *buf, uint32_t siz, uint16_t poly = CRC16_POLY_CCITT);
 
+/**
+* CRC-16 algorithm.
+* Bitwise reference version.
+* @param buf Data buffer.
+* @param siz Length of data buffer.
+* @param poly Polynomial.
+* @return Checksum.
+*/
+uint16_t Crc16_bitwise(const uint8_t *buf, uint32_t siz, uint16_t poly = CRC16_POLY_CCITT);
+
+/**
+* CRC-32 algorithm.
+* Table-driven version using slicing-by-8.
+* For reflected polynomials, PCLMULQDQ is used if supported by the CPU.
+* @param buf Data buffer.
+* @param siz Length of data buffer.
+* @param poly Polynomial. (reflected if reflected == true)
+* @param init Initial value.
+* @param xorout Final XOR value.
+* @param reflected True for a reflected (LSB-first) CRC.
+* @return Checksum.
+*/
+uint32_t Crc32(const uint8_t *buf, uint32_t siz, uint32_t poly = CRC32_POLY_ZLIB,
+	       uint32_t init = 0xFFFFFFFF, uint32_t xorout = 0xFFFFFFFF, bool reflected = true);
+
+/**
+* CRC-32 algorithm.
+* Table-driven version using slicing-by-8, without PCLMULQDQ.
+* @param buf Data buffer.
+* @param siz Length of data buffer.
+* @param poly Polynomial. (reflected if reflected == true)
+* @param init Initial value.
+* @param xorout Final XOR value.
+* @param reflected True for a reflected (LSB-first) CRC.
+* @return Checksum.
+*/
+uint32_t Crc32_table(const uint8_t *buf, uint32_t siz, uint32_t poly = CRC32_POLY_ZLIB,
+		     uint32_t init = 0xFFFFFFFF, uint32_t xorout = 0xFFFFFFFF, bool reflected = true);
+
+/**
+* CRC-32 algorithm.
+* Bitwise reference version.
+* @param buf Data buffer.
+* @param siz Length of data buffer.
+* @param poly Polynomial. (reflected if reflected == true)
+* @param init Initial value.
+* @param xorout Final XOR value.
+* @param reflected True for a reflected (LSB-first) CRC.
+* @return Checksum.
+*/
+uint32_t Crc32_bitwise(const uint8_t *buf, uint32_t siz, uint32_t poly = CRC32_POLY_ZLIB,
+		       uint32_t init = 0xFFFFFFFF, uint32_t xorout = 0xFFFFFFFF, bool reflected = true);
+
 /**
 * AddInvDual16 algorithm.
 * Adds 16-bit words together in a uint16_t.
 * First word is a simple addition.
 * Second word adds (word ^ 0xFFFF).
 * If either word equals 0xFFFF, it's changed to 0.
+* SSE2 or AVX2 is used if supported by the CPU.
 * @param buf Data buffer.
 * @param siz Length of data buffer.
 * @param endian Endianness of the data.
@@ -129,15 +195,35 @@ uint16_t Crc16(const uint8_t *buf, uint32_t siz, uint16_t poly = CRC16_POLY_CCIT
 */
 uint32_t AddInvDual16(const uint16_t *buf, uint32_t siz, ChkEndian endian);
 
+/**
+* AddInvDual16 algorithm.
+* Standard version. (No SIMD)
+* @param buf Data buffer.
+* @param siz Length of data buffer.
+* @param endian Endianness of the data.
+* @return Checksum.
+*/
+uint32_t AddInvDual16_c(const uint16_t *buf, uint32_t siz, ChkEndian endian);
+
 /**
 * AddBytes32 algorithm.
 * Adds all bytes together in a uint32_t.
+* SSE2 or AVX2 is used if supported by the CPU.
 * @param buf Data buffer.
 * @param siz Length of data buffer.
 * @return Checksum.
 */
 uint32_t AddBytes32(const uint8_t *buf, uint32_t siz);
 
+/**
+* AddBytes32 algorithm.
+* Standard version. (No SIMD)
+* @param buf Data buffer.
+* @param siz Length of data buffer.
+* @return Checksum.
+*/
+uint32_t AddBytes32_c(const uint8_t *buf, uint32_t siz);
+
 /**
 * SonicChaoGarden algorithm.
 * @param buf Data buffer.
@@ -149,6 +235,7 @@ uint32_t SonicChaoGarden(const uint8_t *buf, uint32_t siz);
 /**
 * Dreamcast VMU algorithm.
 * Based on FCS-16.
+* Table-driven version using slicing-by-8.
 *
 * NOTE: The CRC is stored within the header.
 * Specify the address in crc_addr in order to
@@ -162,6 +249,17 @@ uint32_t SonicChaoGarden(const uint8_t *buf, uint32_t siz);
 */
 uint16_t DreamcastVMU(const uint8_t *buf, uint32_t siz, uint32_t crc_addr = -1);
 
+/**
+* Dreamcast VMU algorithm.
+* Based on FCS-16.
+* Bitwise reference version.
+* @param buf Data buffer.
+* @param siz Length of data buffer.
+* @param crc_addr Address of CRC in header.
+* @return Checksum.
+*/
+uint16_t DreamcastVMU_bitwise(const uint8_t *buf, uint32_t siz, uint32_t crc_addr = -1);
+
 /**
  * Pokémon XD algorithm.
  * Reference: https://github.com/TuxSH/PkmGCTools/blob/master/LibPkmGC/src/LibPkmGC/XD/SaveEditing/SaveSlot.cpp
@@ -169,6 +267,8 @@ uint16_t DreamcastVMU(const uint8_t *buf, uint32_t siz, uint32_t crc_addr = -1);
  * The data area is "encrypted", so it has to be decrypted before
  * a checksum can be calculated.
  *
+ * NOTE: If more than one checksum is needed, use PokemonXD_all().
+ *
  * @param buf		[in] Data buffer.
  * @param siz		[in] Length of data buffer.
  * @param crc_addr	[in] CRC address. (Should be 0x10, 0x14, 0x18, 0x1C.)
@@ -177,6 +277,16 @@ uint16_t DreamcastVMU(const uint8_t *buf, uint32_t siz, uint32_t crc_addr = -1);
  */
 uint32_t PokemonXD(const uint8_t *buf, uint32_t siz, uint32_t crc_addr, uint32_t *pChkExpect);
 
+/**
+ * Pokémon XD algorithm.
+ * This calculates all four checksums in a single pass.
+ * @param buf		[in] Data buffer.
+ * @param siz		[in] Length of data buffer.
+ * @param values	[out] Checksum values. (4 entries, indexed by (crc_addr >> 2) & 3)
+ * @return 0 on success; non-zero if the buffer is too small.
+ */
+int PokemonXD_all(const uint8_t *buf, uint32_t siz, ChecksumValue values[4]);
+
 /** General functions. **/
 
 /**
@@ -190,6 +300,43 @@ uint32_t PokemonXD(const uint8_t *buf, uint32_t siz, uint32_t crc_addr, uint32_t
 */
 uint32_t Exec(ChkAlgorithm algorithm, const void *buf, uint32_t siz, ChkEndian endian, uint32_t param = 0);
 
+/**
+* Get the checksum for a block of data.
+* This version uses all options from the checksum definition.
+* NOTE: checksumDef.start and checksumDef.length are not used.
+* @param checksumDef Checksum definition.
+* @param buf Data buffer.
+* @param siz Length of data buffer.
+* @return Checksum.
+*/
+uint32_t Exec(const ChecksumDef &checksumDef, const void *buf, uint32_t siz);
+
+/**
+* Get the number of checksums an algorithm calculates in a single pass.
+* @param algorithm Checksum algorithm.
+* @return Number of checksums, or 0 if the algorithm only calculates one checksum.
+*/
+int MultiCount(ChkAlgorithm algorithm);
+
+/**
+* Get the index of a checksum in ExecMulti()'s output.
+* @param algorithm Checksum algorithm.
+* @param address Checksum address.
+* @return Index, or -1 if the algorithm only calculates one checksum.
+*/
+int MultiIndex(ChkAlgorithm algorithm, uint32_t address);
+
+/**
+* Calculate all checksums for a block of data in a single pass.
+* This is only supported for algorithms where MultiCount() > 0.
+* @param algorithm	[in] Checksum algorithm.
+* @param buf		[in] Data buffer.
+* @param siz		[in] Length of data buffer.
+* @param values		[out] Checksum values. (must have MultiCount() entries)
+* @return 0 on success; non-zero on error.
+*/
+int ExecMulti(ChkAlgorithm algorithm, const void *buf, uint32_t siz, ChecksumValue *values);
+
 /**
 * Get a ChkAlgorithm from a checksum algorithm name.
 * @param algorithm Checksum algorithm name.
@@ -58,12 +58,14 @@ GcImage *DcImageLoader::fromPalette16(int w, int h,
 	d->init(w, h, GcImage::PXFMT_CI8);
 
 	// Convert the palette.
-	// TODO: Optimize using pointers instead of indexes?
-	// TODO: Clear the top 240 entries?
-	d->palette.resize(256);
+	// NOTE: The top 240 entries are left as 0.
+	GcPalette *const palette = new GcPalette();
+	uint32_t *const pal = palette->data();
 	for (int i = 0; i < 16; i++) {
-		d->palette[i] = ARGB4444_to_ARGB32(le16_to_cpu(pal_buf[i]));
+		pal[i] = ARGB4444_to_ARGB32(le16_to_cpu(pal_buf[i]));
 	}
+	d->setPalette(palette);
+	palette->unref();
 
 	uint8_t *px_dest = (uint8_t*)d->imageData;
 	for (int i = img_siz; i > 0; i--, img_buf++, px_dest += 2) {
@@ -137,11 +139,13 @@ GcImage *DcImageLoader::fromMonochrome(int w, int h,
 	d->init(w, h, GcImage::PXFMT_CI8);
 
 	// Convert the palette.
-	// TODO: Optimize using pointers instead of indexes?
-	// TODO: Clear the top 254 entries?
-	d->palette.resize(256);
-	d->palette[0] = 0xFFFFFFFF;	// white
-	d->palette[1] = 0xFF000000;	// black
+	// NOTE: The top 254 entries are left as 0.
+	GcPalette *const palette = new GcPalette();
+	uint32_t *const pal = palette->data();
+	pal[0] = 0xFFFFFFFF;	// white
+	pal[1] = 0xFF000000;	// black
+	d->setPalette(palette);
+	palette->unref();
 
 	// NOTE: MSB == left-most pixel.
 	uint8_t *px_dest = (uint8_t*)d->imageData;
@@ -13,22 +13,27 @@
 
 /** GcImagePrivate **/
 #include "GcImage_p.hpp"
-using std::vector;
 
 GcImagePrivate::GcImagePrivate()
 	: imageData(nullptr)
 	, imageData_len(0)
+	, palette(nullptr)
 	, pxFmt(GcImage::PXFMT_NONE)
 	, width(0)
 	, height(0)
 { }
 
 GcImagePrivate::~GcImagePrivate()
-	{ free(imageData); }
+{
+	free(imageData);
+	if (palette) {
+		palette->unref();
+	}
+}
 
 GcImagePrivate::GcImagePrivate(const GcImagePrivate &other)
 	: imageData_len(other.imageData_len)
-	, palette(other.palette)
+	, palette(other.palette ? other.palette->ref() : nullptr)
 	, pxFmt(other.pxFmt)
 	, width(other.width)
 	, height(other.height)
@@ -54,7 +59,7 @@ void GcImagePrivate::init(int w, int h, GcImage::PxFmt pxFmt)
 	free(imageData);
 	imageData = nullptr;
 	imageData_len = 0;
-	palette.clear();
+	setPalette(nullptr);
 	width = 0;
 	height = 0;
 	this->pxFmt = GcImage::PXFMT_NONE;
@@ -85,6 +90,25 @@ void GcImagePrivate::init(int w, int h, GcImage::PxFmt pxFmt)
 	}
 }
 
+/**
+ * Set the palette.
+ * A reference is taken to the new palette,
+ * and the old palette is released.
+ * @param palette New palette, or nullptr to clear it.
+ */
+void GcImagePrivate::setPalette(GcPalette *palette)
+{
+	if (this->palette == palette)
+		return;
+	if (palette) {
+		palette->ref();
+	}
+	if (this->palette) {
+		this->palette->unref();
+	}
+	this->palette = palette;
+}
+
 /** GcImage **/
 
 GcImage::GcImage()
@@ -113,22 +137,25 @@ GcImage *GcImage::toRGB5A3(void) const
 
 		case PXFMT_CI8: {
 			// CI8. Convert to ARGB32.
+			if (!d->palette)
+				break;
 			GcImage *gcImage = new GcImage();
 			GcImagePrivate *const d_new = gcImage->d;
 			d_new->init(d->width, d->height, PXFMT_ARGB32);
 
+			const uint32_t *const palette = d->palette->data();
 			const uint8_t *ci8 = static_cast<const uint8_t*>(d->imageData);
 			uint32_t *rgb5A3 = static_cast<uint32_t*>(d_new->imageData);
 			size_t len = d->imageData_len;
 			for (; len >= 4; len -= 4, ci8 += 4, rgb5A3 += 4) {
-				*(rgb5A3 + 0) = d->palette[*(ci8 + 0)];
-				*(rgb5A3 + 1) = d->palette[*(ci8 + 1)];
-				*(rgb5A3 + 2) = d->palette[*(ci8 + 2)];
-				*(rgb5A3 + 3) = d->palette[*(ci8 + 3)];
+				*(rgb5A3 + 0) = palette[*(ci8 + 0)];
+				*(rgb5A3 + 1) = palette[*(ci8 + 1)];
+				*(rgb5A3 + 2) = palette[*(ci8 + 2)];
+				*(rgb5A3 + 3) = palette[*(ci8 + 3)];
 			}
 			// Just in case the image size isn't divisible by 4...
 			for (; len > 0; len--, ci8++, rgb5A3++) {
-				*rgb5A3 = d->palette[*ci8];
+				*rgb5A3 = palette[*ci8];
 			}
 
 			// Image is converted.
@@ -162,7 +189,7 @@ int GcImage::height(void) const
  */
 const uint32_t *GcImage::palette(void) const
 {
-	if (d->pxFmt != PXFMT_CI8 || d->palette.size() != 256)
+	if (d->pxFmt != PXFMT_CI8 || !d->palette)
 		return nullptr;
-	return d->palette.data();
+	return d->palette->data();
 }
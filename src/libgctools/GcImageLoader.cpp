@@ -9,13 +9,23 @@
 
 #include "GcImageLoader.hpp"
 #include "GcImage_p.hpp"
+#include "GcPalette.hpp"
 
 // Byteswapping macros.
 #include "util/byteswap.h"
 
+// CPU flags.
+#include "util/cpuflags.h"
+
 // C includes. (C++ namespace)
 #include <cstring>
 
+#ifdef CPUFLAGS_X86
+#  include <emmintrin.h>
+#  include <tmmintrin.h>
+#  include <immintrin.h>
+#endif /* CPUFLAGS_X86 */
+
 /**
  * Convert an RGB5A3 pixel to ARGB32.
  * @param px16 RGB5A3 pixel.
@@ -77,54 +87,367 @@ static inline void BlitTile(pixel *imgBuf, int pitch,
 	}
 }
 
+/** RGB5A3 decoders. **/
+
 /**
- * Convert a GameCube CI8 image to GcImage.
+ * RGB5A3 line decoder.
+ * Standard version. (No SIMD)
+ * @param dest	[out] ARGB32 destination.
+ * @param src	[in] RGB5A3 source. (big-endian)
+ * @param count	[in] Number of pixels.
+ */
+static void RGB5A3_DecodeLine_c(uint32_t *dest, const uint16_t *src, int count)
+{
+	for (; count > 0; count--, dest++, src++) {
+		*dest = RGB5A3_to_ARGB32(be16_to_cpu(*src));
+	}
+}
+
+/**
+ * RGB5A3 tile decoder.
+ * Standard version. (No SIMD)
+ * @param dest	[out] First pixel of the tile in the linear image buffer.
+ * @param pitch	[in] Pitch of the image buffer, in pixels.
+ * @param src	[in] RGB5A3 tile. (16 pixels, big-endian)
+ */
+static void RGB5A3_DecodeTile_c(uint32_t *dest, int pitch, const uint16_t *src)
+{
+	for (int y = 4; y != 0; y--, dest += pitch, src += 4) {
+		RGB5A3_DecodeLine_c(dest, src, 4);
+	}
+}
+
+#ifdef CPUFLAGS_X86
+/**
+ * Convert eight RGB5A3 pixels to ARGB32.
+ * The pixels must already be in host-endian format.
+ * Bit 15 selects RGB555 or RGB4A3 without branching.
+ * @param px16	[in] RGB5A3 pixels.
+ * @param lo	[out] ARGB32 pixels 0-3.
+ * @param hi	[out] ARGB32 pixels 4-7.
+ */
+CPUFLAGS_TARGET("sse2")
+static inline void RGB5A3_Expand_sse2(__m128i px16, __m128i *lo, __m128i *hi)
+{
+	const __m128i mask5 = _mm_set1_epi16(0x1F);
+	const __m128i mask4 = _mm_set1_epi16(0x0F);
+	const __m128i mask3 = _mm_set1_epi16(0x07);
+
+	// Mask: 0xFFFF for RGB555; 0x0000 for RGB4A3.
+	const __m128i isRGB555 = _mm_srai_epi16(px16, 15);
+
+	// RGB555: xRRRRRGG GGGBBBBB
+	__m128i r5 = _mm_and_si128(_mm_srli_epi16(px16, 10), mask5);
+	__m128i g5 = _mm_and_si128(_mm_srli_epi16(px16, 5), mask5);
+	__m128i b5 = _mm_and_si128(px16, mask5);
+	r5 = _mm_or_si128(_mm_slli_epi16(r5, 3), _mm_srli_epi16(r5, 2));
+	g5 = _mm_or_si128(_mm_slli_epi16(g5, 3), _mm_srli_epi16(g5, 2));
+	b5 = _mm_or_si128(_mm_slli_epi16(b5, 3), _mm_srli_epi16(b5, 2));
+
+	// RGB4A3: xAAARRRR GGGGBBBB
+	__m128i r4 = _mm_and_si128(_mm_srli_epi16(px16, 8), mask4);
+	__m128i g4 = _mm_and_si128(_mm_srli_epi16(px16, 4), mask4);
+	__m128i b4 = _mm_and_si128(px16, mask4);
+	__m128i a3 = _mm_and_si128(_mm_srli_epi16(px16, 12), mask3);
+	r4 = _mm_or_si128(_mm_slli_epi16(r4, 4), r4);
+	g4 = _mm_or_si128(_mm_slli_epi16(g4, 4), g4);
+	b4 = _mm_or_si128(_mm_slli_epi16(b4, 4), b4);
+	a3 = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(a3, 5), _mm_slli_epi16(a3, 2)),
+			  _mm_srli_epi16(a3, 1));
+
+	// Select the channels.
+	#define SELECT(x555, x4a3) \
+		_mm_or_si128(_mm_and_si128(isRGB555, (x555)), _mm_andnot_si128(isRGB555, (x4a3)))
+	const __m128i r = SELECT(r5, r4);
+	const __m128i g = SELECT(g5, g4);
+	const __m128i b = SELECT(b5, b4);
+	const __m128i a = SELECT(_mm_set1_epi16(0xFF), a3);
+	#undef SELECT
+
+	// Combine into ARGB32.
+	const __m128i gb = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+	const __m128i ar = _mm_or_si128(_mm_slli_epi16(a, 8), r);
+	*lo = _mm_unpacklo_epi16(gb, ar);
+	*hi = _mm_unpackhi_epi16(gb, ar);
+}
+
+/**
+ * Byteswap 16-bit values.
+ * SSE2 version.
+ * @param v Values.
+ * @return Byteswapped values.
+ */
+CPUFLAGS_TARGET("sse2")
+static inline __m128i bswap16_sse2(__m128i v)
+{
+	return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+/**
+ * Byteswap 16-bit values.
+ * SSSE3 version.
+ * @param v Values.
+ * @return Byteswapped values.
+ */
+CPUFLAGS_TARGET("ssse3")
+static inline __m128i bswap16_ssse3(__m128i v)
+{
+	const __m128i shuf = _mm_setr_epi8(1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14);
+	return _mm_shuffle_epi8(v, shuf);
+}
+
+/**
+ * RGB5A3 line decoder.
+ * SSE2-optimized version.
+ * @param dest	[out] ARGB32 destination.
+ * @param src	[in] RGB5A3 source. (big-endian)
+ * @param count	[in] Number of pixels.
+ */
+CPUFLAGS_TARGET("sse2")
+static void RGB5A3_DecodeLine_sse2(uint32_t *dest, const uint16_t *src, int count)
+{
+	// Convert eight pixels at a time.
+	for (; count >= 8; count -= 8, dest += 8, src += 8) {
+		__m128i lo, hi;
+		const __m128i px16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		RGB5A3_Expand_sse2(bswap16_sse2(px16), &lo, &hi);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4), hi);
+	}
+
+	// Remaining pixels.
+	RGB5A3_DecodeLine_c(dest, src, count);
+}
+
+/**
+ * RGB5A3 tile decoder.
+ * SSE2-optimized version.
+ * @param dest	[out] First pixel of the tile in the linear image buffer.
+ * @param pitch	[in] Pitch of the image buffer, in pixels.
+ * @param src	[in] RGB5A3 tile. (16 pixels, big-endian)
+ */
+CPUFLAGS_TARGET("sse2")
+static void RGB5A3_DecodeTile_sse2(uint32_t *dest, int pitch, const uint16_t *src)
+{
+	// Each 128-bit load contains two tile rows.
+	const __m128i *const xmm = reinterpret_cast<const __m128i*>(src);
+	for (int i = 0; i < 2; i++, dest += (pitch * 2)) {
+		__m128i lo, hi;
+		RGB5A3_Expand_sse2(bswap16_sse2(_mm_loadu_si128(&xmm[i])), &lo, &hi);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + pitch), hi);
+	}
+}
+
+/**
+ * RGB5A3 line decoder.
+ * SSSE3-optimized version.
+ * @param dest	[out] ARGB32 destination.
+ * @param src	[in] RGB5A3 source. (big-endian)
+ * @param count	[in] Number of pixels.
+ */
+CPUFLAGS_TARGET("ssse3")
+static void RGB5A3_DecodeLine_ssse3(uint32_t *dest, const uint16_t *src, int count)
+{
+	// Convert eight pixels at a time.
+	for (; count >= 8; count -= 8, dest += 8, src += 8) {
+		__m128i lo, hi;
+		const __m128i px16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		RGB5A3_Expand_sse2(bswap16_ssse3(px16), &lo, &hi);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4), hi);
+	}
+
+	// Remaining pixels.
+	RGB5A3_DecodeLine_c(dest, src, count);
+}
+
+/**
+ * RGB5A3 tile decoder.
+ * SSSE3-optimized version.
+ * @param dest	[out] First pixel of the tile in the linear image buffer.
+ * @param pitch	[in] Pitch of the image buffer, in pixels.
+ * @param src	[in] RGB5A3 tile. (16 pixels, big-endian)
+ */
+CPUFLAGS_TARGET("ssse3")
+static void RGB5A3_DecodeTile_ssse3(uint32_t *dest, int pitch, const uint16_t *src)
+{
+	// Each 128-bit load contains two tile rows.
+	const __m128i *const xmm = reinterpret_cast<const __m128i*>(src);
+	for (int i = 0; i < 2; i++, dest += (pitch * 2)) {
+		__m128i lo, hi;
+		RGB5A3_Expand_sse2(bswap16_ssse3(_mm_loadu_si128(&xmm[i])), &lo, &hi);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), lo);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + pitch), hi);
+	}
+}
+
+/**
+ * Convert sixteen RGB5A3 pixels to ARGB32.
+ * The pixels must be in big-endian format.
+ * Bit 15 selects RGB555 or RGB4A3 without branching.
+ *
+ * NOTE: AVX2 unpack instructions work within 128-bit lanes,
+ * so lo contains pixels 0-3 and 8-11, and hi contains
+ * pixels 4-7 and 12-15.
+ *
+ * @param px16	[in] RGB5A3 pixels. (big-endian)
+ * @param lo	[out] ARGB32 pixels 0-3, 8-11.
+ * @param hi	[out] ARGB32 pixels 4-7, 12-15.
+ */
+CPUFLAGS_TARGET("avx2")
+static inline void RGB5A3_Expand_avx2(__m256i px16, __m256i *lo, __m256i *hi)
+{
+	const __m256i mask5 = _mm256_set1_epi16(0x1F);
+	const __m256i mask4 = _mm256_set1_epi16(0x0F);
+	const __m256i mask3 = _mm256_set1_epi16(0x07);
+
+	// Byteswap the pixels.
+	const __m256i shuf = _mm256_setr_epi8(
+		1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14,
+		1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14);
+	px16 = _mm256_shuffle_epi8(px16, shuf);
+
+	// Mask: 0xFFFF for RGB555; 0x0000 for RGB4A3.
+	const __m256i isRGB555 = _mm256_srai_epi16(px16, 15);
+
+	// RGB555: xRRRRRGG GGGBBBBB
+	__m256i r5 = _mm256_and_si256(_mm256_srli_epi16(px16, 10), mask5);
+	__m256i g5 = _mm256_and_si256(_mm256_srli_epi16(px16, 5), mask5);
+	__m256i b5 = _mm256_and_si256(px16, mask5);
+	r5 = _mm256_or_si256(_mm256_slli_epi16(r5, 3), _mm256_srli_epi16(r5, 2));
+	g5 = _mm256_or_si256(_mm256_slli_epi16(g5, 3), _mm256_srli_epi16(g5, 2));
+	b5 = _mm256_or_si256(_mm256_slli_epi16(b5, 3), _mm256_srli_epi16(b5, 2));
+
+	// RGB4A3: xAAARRRR GGGGBBBB
+	__m256i r4 = _mm256_and_si256(_mm256_srli_epi16(px16, 8), mask4);
+	__m256i g4 = _mm256_and_si256(_mm256_srli_epi16(px16, 4), mask4);
+	__m256i b4 = _mm256_and_si256(px16, mask4);
+	__m256i a3 = _mm256_and_si256(_mm256_srli_epi16(px16, 12), mask3);
+	r4 = _mm256_or_si256(_mm256_slli_epi16(r4, 4), r4);
+	g4 = _mm256_or_si256(_mm256_slli_epi16(g4, 4), g4);
+	b4 = _mm256_or_si256(_mm256_slli_epi16(b4, 4), b4);
+	a3 = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(a3, 5), _mm256_slli_epi16(a3, 2)),
+			     _mm256_srli_epi16(a3, 1));
+
+	// Select the channels.
+	const __m256i r = _mm256_blendv_epi8(r4, r5, isRGB555);
+	const __m256i g = _mm256_blendv_epi8(g4, g5, isRGB555);
+	const __m256i b = _mm256_blendv_epi8(b4, b5, isRGB555);
+	const __m256i a = _mm256_blendv_epi8(a3, _mm256_set1_epi16(0xFF), isRGB555);
+
+	// Combine into ARGB32.
+	const __m256i gb = _mm256_or_si256(_mm256_slli_epi16(g, 8), b);
+	const __m256i ar = _mm256_or_si256(_mm256_slli_epi16(a, 8), r);
+	*lo = _mm256_unpacklo_epi16(gb, ar);
+	*hi = _mm256_unpackhi_epi16(gb, ar);
+}
+
+/**
+ * RGB5A3 line decoder.
+ * AVX2-optimized version.
+ * @param dest	[out] ARGB32 destination.
+ * @param src	[in] RGB5A3 source. (big-endian)
+ * @param count	[in] Number of pixels.
+ */
+CPUFLAGS_TARGET("avx2")
+static void RGB5A3_DecodeLine_avx2(uint32_t *dest, const uint16_t *src, int count)
+{
+	// Convert sixteen pixels at a time.
+	for (; count >= 16; count -= 16, dest += 16, src += 16) {
+		__m256i lo, hi;
+		RGB5A3_Expand_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), &lo, &hi);
+		// Restore the pixel order. (0-3, 4-7, 8-11, 12-15)
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest),
+			_mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 8),
+			_mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+
+	// Remaining pixels.
+	RGB5A3_DecodeLine_c(dest, src, count);
+}
+
+/**
+ * RGB5A3 tile decoder.
+ * AVX2-optimized version.
+ * @param dest	[out] First pixel of the tile in the linear image buffer.
+ * @param pitch	[in] Pitch of the image buffer, in pixels.
+ * @param src	[in] RGB5A3 tile. (16 pixels, big-endian)
+ */
+CPUFLAGS_TARGET("avx2")
+static void RGB5A3_DecodeTile_avx2(uint32_t *dest, int pitch, const uint16_t *src)
+{
+	// The entire tile fits in a single 256-bit load.
+	__m256i lo, hi;
+	RGB5A3_Expand_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), &lo, &hi);
+
+	// lo contains rows 0 and 2; hi contains rows 1 and 3.
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm256_castsi256_si128(lo));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + pitch), _mm256_castsi256_si128(hi));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + pitch*2), _mm256_extracti128_si256(lo, 1));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + pitch*3), _mm256_extracti128_si256(hi, 1));
+}
+#endif /* CPUFLAGS_X86 */
+
+/** GcImageLoader **/
+
+/**
+ * Convert a GameCube RGB5A3 palette to GcPalette.
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 0x200]
+ * @param decodeLine RGB5A3 line decoder.
+ * @return GcPalette with a reference count of 1, or nullptr on error.
+ */
+GcPalette *GcImageLoader::decodePalette_int(const uint16_t *pal_buf, int pal_siz,
+			RGB5A3_DecodeLine_fn decodeLine)
+{
+	// Verify parameters.
+	if (!pal_buf || pal_siz < 0x200)
+		return nullptr;
+
+	GcPalette *const palette = new GcPalette();
+	decodeLine(palette->data(), pal_buf, GcPalette::COLOR_COUNT);
+	return palette;
+}
+
+/**
+ * Convert a GameCube RGB5A3 image to GcImage.
  * @param w Image width.
  * @param h Image height.
  * @param img_buf CI8 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)]
- * @param pal_buf Palette buffer.
- * @param pal_siz Size of palette data. [must be >= 0x200]
- * @return QImage, or empty QImage on error.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param decodeTile RGB5A3 tile decoder.
+ * @return GcImage, or nullptr on error.
  */
-GcImage *GcImageLoader::fromCI8(int w, int h,
-			const uint8_t *img_buf, int img_siz,
-			const uint16_t *pal_buf, int pal_siz)
+GcImage *GcImageLoader::fromRGB5A3_int(int w, int h, const uint16_t *img_buf, int img_siz,
+			RGB5A3_DecodeTile_fn decodeTile)
 {
 	// Verify parameters.
 	if (w < 0 || h < 0)
 		return nullptr;
-	if (img_siz < (w * h) || pal_siz < 0x200)
+	if (img_siz < ((w * h) * 2))
 		return nullptr;
 
-	// CI8 uses 8x4 tiles.
-	if (w % 8 != 0 || h % 4 != 0)
+	// RGB5A3 uses 4x4 tiles.
+	if (w % 4 != 0 || h % 4 != 0)
 		return nullptr;
 
 	// Calculate the total number of tiles.
-	const int tilesX = (w / 8);
+	const int tilesX = (w / 4);
 	const int tilesY = (h / 4);
 
 	// Create a GcImage.
 	GcImage *gcImage = new GcImage();
 	GcImagePrivate *const d = gcImage->d;
-	d->init(w, h, GcImage::PXFMT_CI8);
-
-	// Convert the palette.
-	// TODO: Optimize using pointers instead of indexes?
-	d->palette.resize(256);
-	for (int i = 0; i < 256; i++) {
-		d->palette[i] = RGB5A3_to_ARGB32(be16_to_cpu(pal_buf[i]));
-	}
-
-	// Tile pointer.
-	const uint8_t *tileBuf = img_buf;
+	d->init(w, h, GcImage::PXFMT_ARGB32);
 
+	// Tiles are decoded directly into the image buffer.
+	uint32_t *const imgBuf = static_cast<uint32_t*>(d->imageData);
 	for (int y = 0; y < tilesY; y++) {
-		for (int x = 0; x < tilesX; x++) {
-			// Decode the current tile.
-			BlitTile<uint8_t, 8, 4>((uint8_t*)d->imageData, w, tileBuf, x, y);
-			tileBuf += (8 * 4);
+		uint32_t *dest = imgBuf + (y * 4 * w);
+		for (int x = 0; x < tilesX; x++, dest += 4, img_buf += 4*4) {
+			decodeTile(dest, w, img_buf);
 		}
 	}
 
@@ -132,52 +455,182 @@ GcImage *GcImageLoader::fromCI8(int w, int h,
 	return gcImage;
 }
 
+/**
+ * Convert a GameCube RGB5A3 palette to GcPalette.
+ * SIMD is used if supported by the CPU.
+ *
+ * The palette can be shared by multiple CI8 images
+ * using fromCI8(w, h, img_buf, img_siz, palette).
+ * Caller must unref() the returned GcPalette.
+ *
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 0x200]
+ * @return GcPalette with a reference count of 1, or nullptr on error.
+ */
+GcPalette *GcImageLoader::decodePalette(const uint16_t *pal_buf, int pal_siz)
+{
+	RGB5A3_DecodeLine_fn decodeLine = RGB5A3_DecodeLine_c;
+#ifdef CPUFLAGS_X86
+	const uint32_t flags = cpuflags_get();
+	if (flags & CPUFLAG_X86_AVX2) {
+		decodeLine = RGB5A3_DecodeLine_avx2;
+	} else if (flags & CPUFLAG_X86_SSSE3) {
+		decodeLine = RGB5A3_DecodeLine_ssse3;
+	}
+#  ifdef CPUFLAGS_HAS_SSE2_ALWAYS
+	else {
+		decodeLine = RGB5A3_DecodeLine_sse2;
+	}
+#  else /* !CPUFLAGS_HAS_SSE2_ALWAYS */
+	else if (flags & CPUFLAG_X86_SSE2) {
+		decodeLine = RGB5A3_DecodeLine_sse2;
+	}
+#  endif /* CPUFLAGS_HAS_SSE2_ALWAYS */
+#endif /* CPUFLAGS_X86 */
+
+	return decodePalette_int(pal_buf, pal_siz, decodeLine);
+}
 
 /**
- * Convert a GameCube RGB5A3 image to GcImage.
+ * Convert a GameCube CI8 image to GcImage using a decoded palette.
+ * The GcImage takes its own reference to the palette.
  * @param w Image width.
  * @param h Image height.
  * @param img_buf CI8 image buffer.
- * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param palette Decoded palette.
  * @return GcImage, or nullptr on error.
  */
-GcImage *GcImageLoader::fromRGB5A3(int w, int h, const uint16_t *img_buf, int img_siz)
+GcImage *GcImageLoader::fromCI8(int w, int h,
+			const uint8_t *img_buf, int img_siz,
+			GcPalette *palette)
 {
 	// Verify parameters.
-	if (w < 0 || h < 0)
+	if (w < 0 || h < 0 || !palette)
 		return nullptr;
-	if (img_siz < ((w * h) * 2))
+	if (img_siz < (w * h))
 		return nullptr;
 
-	// RGB5A3 uses 4x4 tiles.
-	if (w % 4 != 0 || h % 4 != 0)
+	// CI8 uses 8x4 tiles.
+	if (w % 8 != 0 || h % 4 != 0)
 		return nullptr;
 
 	// Calculate the total number of tiles.
-	const int tilesX = (w / 4);
+	const int tilesX = (w / 8);
 	const int tilesY = (h / 4);
 
 	// Create a GcImage.
 	GcImage *gcImage = new GcImage();
 	GcImagePrivate *const d = gcImage->d;
-	d->init(w, h, GcImage::PXFMT_ARGB32);
+	d->init(w, h, GcImage::PXFMT_CI8);
+	d->setPalette(palette);
 
-	// Temporary tile buffer.
-	uint32_t tileBuf[4*4];
+	// Tile pointer.
+	const uint8_t *tileBuf = img_buf;
 
 	for (int y = 0; y < tilesY; y++) {
 		for (int x = 0; x < tilesX; x++) {
-			// Convert each tile to ARGB32 manually.
-			// TODO: Optimize using pointers instead of indexes?
-			for (int i = 0; i < 4*4; i++, img_buf++) {
-				tileBuf[i] = RGB5A3_to_ARGB32(be16_to_cpu(*img_buf));
-			}
-
-			// Blit the tile to the main image buffer.
-			BlitTile<uint32_t, 4, 4>((uint32_t*)d->imageData, w, tileBuf, x, y);
+			// Decode the current tile.
+			BlitTile<uint8_t, 8, 4>((uint8_t*)d->imageData, w, tileBuf, x, y);
+			tileBuf += (8 * 4);
 		}
 	}
 
 	// Image has been converted.
 	return gcImage;
 }
+
+/**
+ * Convert a GameCube CI8 image to GcImage.
+ * The palette is converted using SIMD if supported by the CPU.
+ * @param w Image width.
+ * @param h Image height.
+ * @param img_buf CI8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 0x200]
+ * @return GcImage, or nullptr on error.
+ */
+GcImage *GcImageLoader::fromCI8(int w, int h,
+			const uint8_t *img_buf, int img_siz,
+			const uint16_t *pal_buf, int pal_siz)
+{
+	GcPalette *const palette = decodePalette(pal_buf, pal_siz);
+	if (!palette)
+		return nullptr;
+
+	GcImage *const gcImage = fromCI8(w, h, img_buf, img_siz, palette);
+	palette->unref();
+	return gcImage;
+}
+
+/**
+ * Convert a GameCube CI8 image to GcImage.
+ * Standard version. (No SIMD)
+ * @param w Image width.
+ * @param h Image height.
+ * @param img_buf CI8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)]
+ * @param pal_buf Palette buffer.
+ * @param pal_siz Size of palette data. [must be >= 0x200]
+ * @return GcImage, or nullptr on error.
+ */
+GcImage *GcImageLoader::fromCI8_c(int w, int h,
+			const uint8_t *img_buf, int img_siz,
+			const uint16_t *pal_buf, int pal_siz)
+{
+	GcPalette *const palette = decodePalette_int(pal_buf, pal_siz, RGB5A3_DecodeLine_c);
+	if (!palette)
+		return nullptr;
+
+	GcImage *const gcImage = fromCI8(w, h, img_buf, img_siz, palette);
+	palette->unref();
+	return gcImage;
+}
+
+/**
+ * Convert a GameCube RGB5A3 image to GcImage.
+ * SIMD is used if supported by the CPU.
+ * @param w Image width.
+ * @param h Image height.
+ * @param img_buf CI8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return GcImage, or nullptr on error.
+ */
+GcImage *GcImageLoader::fromRGB5A3(int w, int h, const uint16_t *img_buf, int img_siz)
+{
+	RGB5A3_DecodeTile_fn decodeTile = RGB5A3_DecodeTile_c;
+#ifdef CPUFLAGS_X86
+	const uint32_t flags = cpuflags_get();
+	if (flags & CPUFLAG_X86_AVX2) {
+		decodeTile = RGB5A3_DecodeTile_avx2;
+	} else if (flags & CPUFLAG_X86_SSSE3) {
+		decodeTile = RGB5A3_DecodeTile_ssse3;
+	}
+#  ifdef CPUFLAGS_HAS_SSE2_ALWAYS
+	else {
+		decodeTile = RGB5A3_DecodeTile_sse2;
+	}
+#  else /* !CPUFLAGS_HAS_SSE2_ALWAYS */
+	else if (flags & CPUFLAG_X86_SSE2) {
+		decodeTile = RGB5A3_DecodeTile_sse2;
+	}
+#  endif /* CPUFLAGS_HAS_SSE2_ALWAYS */
+#endif /* CPUFLAGS_X86 */
+
+	return fromRGB5A3_int(w, h, img_buf, img_siz, decodeTile);
+}
+
+/**
+ * Convert a GameCube RGB5A3 image to GcImage.
+ * Standard version. (No SIMD)
+ * @param w Image width.
+ * @param h Image height.
+ * @param img_buf CI8 image buffer.
+ * @param img_siz Size of image data. [must be >= (w*h)*2]
+ * @return GcImage, or nullptr on error.
+ */
+GcImage *GcImageLoader::fromRGB5A3_c(int w, int h, const uint16_t *img_buf, int img_siz)
+{
+	return fromRGB5A3_int(w, h, img_buf, img_siz, RGB5A3_DecodeTile_c);
+}
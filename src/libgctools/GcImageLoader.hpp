@@ -14,6 +14,8 @@
 #include <stdint.h>
 
 #include "GcImage.hpp"
+class GcPalette;
+
 class GcImageLoader
 {
 	private:
@@ -22,9 +24,79 @@ class GcImageLoader
 		GcImageLoader(const GcImageLoader &other);
 		GcImageLoader &operator=(const GcImageLoader &other);
 
+		/**
+		 * RGB5A3 line decoder.
+		 * Converts a line of big-endian RGB5A3 pixels to ARGB32.
+		 * @param dest	[out] ARGB32 destination.
+		 * @param src	[in] RGB5A3 source. (big-endian)
+		 * @param count	[in] Number of pixels.
+		 */
+		typedef void (*RGB5A3_DecodeLine_fn)(uint32_t *dest, const uint16_t *src, int count);
+
+		/**
+		 * RGB5A3 tile decoder.
+		 * Converts a 4x4 tile of big-endian RGB5A3 pixels to ARGB32,
+		 * writing directly into a linear image buffer.
+		 * @param dest	[out] First pixel of the tile in the linear image buffer.
+		 * @param pitch	[in] Pitch of the image buffer, in pixels.
+		 * @param src	[in] RGB5A3 tile. (16 pixels, big-endian)
+		 */
+		typedef void (*RGB5A3_DecodeTile_fn)(uint32_t *dest, int pitch, const uint16_t *src);
+
+		/**
+		 * Convert a GameCube RGB5A3 palette to GcPalette.
+		 * @param pal_buf Palette buffer.
+		 * @param pal_siz Size of palette data. [must be >= 0x200]
+		 * @param decodeLine RGB5A3 line decoder.
+		 * @return GcPalette with a reference count of 1, or nullptr on error.
+		 */
+		static GcPalette *decodePalette_int(const uint16_t *pal_buf, int pal_siz,
+					RGB5A3_DecodeLine_fn decodeLine);
+
+		/**
+		 * Convert a GameCube RGB5A3 image to GcImage.
+		 * @param w Image width.
+		 * @param h Image height.
+		 * @param img_buf CI8 image buffer.
+		 * @param img_siz Size of image data. [must be >= (w*h)*2]
+		 * @param decodeTile RGB5A3 tile decoder.
+		 * @return GcImage, or nullptr on error.
+		 */
+		static GcImage *fromRGB5A3_int(int w, int h, const uint16_t *img_buf, int img_siz,
+					RGB5A3_DecodeTile_fn decodeTile);
+
 	public:
+		/**
+		 * Convert a GameCube RGB5A3 palette to GcPalette.
+		 * SIMD is used if supported by the CPU.
+		 *
+		 * The palette can be shared by multiple CI8 images
+		 * using fromCI8(w, h, img_buf, img_siz, palette).
+		 * Caller must unref() the returned GcPalette.
+		 *
+		 * @param pal_buf Palette buffer.
+		 * @param pal_siz Size of palette data. [must be >= 0x200]
+		 * @return GcPalette with a reference count of 1, or nullptr on error.
+		 */
+		static GcPalette *decodePalette(const uint16_t *pal_buf, int pal_siz);
+
+		/**
+		 * Convert a GameCube CI8 image to GcImage using a decoded palette.
+		 * The GcImage takes its own reference to the palette.
+		 * @param w Image width.
+		 * @param h Image height.
+		 * @param img_buf CI8 image buffer.
+		 * @param img_siz Size of image data. [must be >= (w*h)]
+		 * @param palette Decoded palette.
+		 * @return GcImage, or nullptr on error.
+		 */
+		static GcImage *fromCI8(int w, int h,
+					const uint8_t *img_buf, int img_siz,
+					GcPalette *palette);
+
 		/**
 		 * Convert a GameCube CI8 image to GcImage.
+		 * The palette is converted using SIMD if supported by the CPU.
 		 * @param w Image width.
 		 * @param h Image height.
 		 * @param img_buf CI8 image buffer.
@@ -37,8 +109,24 @@ class GcImageLoader
 					const uint8_t *img_buf, int img_siz,
 					const uint16_t *pal_buf, int pal_siz);
 
+		/**
+		 * Convert a GameCube CI8 image to GcImage.
+		 * Standard version. (No SIMD)
+		 * @param w Image width.
+		 * @param h Image height.
+		 * @param img_buf CI8 image buffer.
+		 * @param img_siz Size of image data. [must be >= (w*h)]
+		 * @param pal_buf Palette buffer.
+		 * @param pal_siz Size of palette data. [must be >= 0x200]
+		 * @return GcImage, or nullptr on error.
+		 */
+		static GcImage *fromCI8_c(int w, int h,
+					const uint8_t *img_buf, int img_siz,
+					const uint16_t *pal_buf, int pal_siz);
+
 		/**
 		 * Convert a GameCube RGB5A3 image to GcImage.
+		 * SIMD is used if supported by the CPU.
 		 * @param w Image width.
 		 * @param h Image height.
 		 * @param img_buf CI8 image buffer.
@@ -46,6 +134,17 @@ class GcImageLoader
 		 * @return GcImage, or nullptr on error.
 		 */
 		static GcImage *fromRGB5A3(int w, int h, const uint16_t *img_buf, int img_siz);
+
+		/**
+		 * Convert a GameCube RGB5A3 image to GcImage.
+		 * Standard version. (No SIMD)
+		 * @param w Image width.
+		 * @param h Image height.
+		 * @param img_buf CI8 image buffer.
+		 * @param img_siz Size of image data. [must be >= (w*h)*2]
+		 * @return GcImage, or nullptr on error.
+		 */
+		static GcImage *fromRGB5A3_c(int w, int h, const uint16_t *img_buf, int img_siz);
 };
 
 #endif /* __LIBGCTOOLS_GCIMAGELOADER_HPP__ */
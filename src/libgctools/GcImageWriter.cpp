@@ -65,6 +65,10 @@ bool GcImageWriterPrivate::is_gcImages_CI8_UNIQUE(const vector<const GcImage*> *
 		const uint32_t *const palette0 = gcImage0->palette();
 		for (auto iter = gcImages->cbegin() + 1; iter != gcImages->cend(); ++iter) {
 			const uint32_t *const paletteN = (*iter)->palette();
+			if (paletteN == palette0) {
+				// Same shared palette.
+				continue;
+			}
 			if (memcmp(palette0, paletteN, (256*sizeof(*paletteN))) != 0) {
 				// CI8_UNIQUE.
 				is_CI8_UNIQUE = true;
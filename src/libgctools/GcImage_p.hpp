@@ -10,11 +10,10 @@
 #define __LIBGCTOOLS_GCIMAGE_P_HPP__
 
 #include "GcImage.hpp"
+#include "GcPalette.hpp"
 
 // C includes. (C++ namespace)
 #include <cstdlib>
-// C++ includes.
-#include <vector>
 
 class GcImagePrivate
 {
@@ -38,7 +37,19 @@ class GcImagePrivate
 
 		void *imageData;
 		size_t imageData_len;
-		std::vector<uint32_t> palette;
+
+		// Palette. (CI8 only)
+		// Shared with other images that use the same palette.
+		GcPalette *palette;
+
+		/**
+		 * Set the palette.
+		 * A reference is taken to the new palette,
+		 * and the old palette is released.
+		 * @param palette New palette, or nullptr to clear it.
+		 */
+		void setPalette(GcPalette *palette);
+
 		GcImage::PxFmt pxFmt;
 		int width;
 		int height;
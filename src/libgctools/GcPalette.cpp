@@ -0,0 +1,46 @@
+/***************************************************************************
+ * GameCube Tools Library.                                                 *
+ * GcPalette.cpp: Shared 256-color palette.                                *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "GcPalette.hpp"
+
+// C includes. (C++ namespace)
+#include <cstring>
+
+/**
+ * Create a new palette.
+ * All entries are initialized to 0.
+ */
+GcPalette::GcPalette()
+	: m_refCnt(1)
+{
+	memset(m_palette, 0, sizeof(m_palette));
+}
+
+GcPalette::~GcPalette()
+{ }
+
+/**
+ * Take a reference to this palette.
+ * @return this
+ */
+GcPalette *GcPalette::ref(void)
+{
+	m_refCnt.fetch_add(1, std::memory_order_relaxed);
+	return this;
+}
+
+/**
+ * Release a reference to this palette.
+ * The palette is deleted if this was the last reference.
+ */
+void GcPalette::unref(void)
+{
+	if (m_refCnt.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		delete this;
+	}
+}
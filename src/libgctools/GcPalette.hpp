@@ -0,0 +1,84 @@
+/***************************************************************************
+ * GameCube Tools Library.                                                 *
+ * GcPalette.hpp: Shared 256-color palette.                                *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __LIBGCTOOLS_GCPALETTE_HPP__
+#define __LIBGCTOOLS_GCPALETTE_HPP__
+
+// C includes.
+#include <stdint.h>
+
+// C++ includes.
+#include <atomic>
+
+/**
+ * Reference-counted 256-color ARGB32 palette.
+ *
+ * CI8 images that use the same palette, e.g. the frames of
+ * a CARD_ICON_CI_SHARED icon, can all point to one GcPalette
+ * instead of each storing their own copy.
+ *
+ * A new GcPalette has a reference count of 1.
+ * Use ref() to take another reference, and unref()
+ * to release it. The palette is deleted when the
+ * last reference is released.
+ *
+ * NOTE: The palette should not be modified once
+ * it's shared with a GcImage.
+ */
+class GcPalette
+{
+	public:
+		/**
+		 * Create a new palette.
+		 * All entries are initialized to 0.
+		 */
+		GcPalette();
+	private:
+		// Use unref() instead of delete.
+		~GcPalette();
+		GcPalette(const GcPalette &other);
+		GcPalette &operator=(const GcPalette &other);
+
+	public:
+		/**
+		 * Number of palette entries.
+		 */
+		static const int COLOR_COUNT = 256;
+
+		/**
+		 * Take a reference to this palette.
+		 * @return this
+		 */
+		GcPalette *ref(void);
+
+		/**
+		 * Release a reference to this palette.
+		 * The palette is deleted if this was the last reference.
+		 */
+		void unref(void);
+
+		/**
+		 * Get the palette data.
+		 * @return Pointer to 256-element ARGB32 palette.
+		 */
+		uint32_t *data(void)
+			{ return m_palette; }
+
+		/**
+		 * Get the palette data.
+		 * @return Pointer to 256-element ARGB32 palette.
+		 */
+		const uint32_t *data(void) const
+			{ return m_palette; }
+
+	private:
+		std::atomic<int> m_refCnt;
+		uint32_t m_palette[COLOR_COUNT];
+};
+
+#endif /* __LIBGCTOOLS_GCPALETTE_HPP__ */
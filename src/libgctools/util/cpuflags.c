@@ -0,0 +1,133 @@
+/***************************************************************************
+ * GameCube Tools Library.                                                 *
+ * cpuflags.c: CPU feature detection.                                      *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "cpuflags.h"
+
+// C includes.
+#include <stddef.h>
+
+#ifdef CPUFLAGS_X86
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  elif defined(__GNUC__)
+#    include <cpuid.h>
+#  endif
+#endif /* CPUFLAGS_X86 */
+
+// Cached CPU flags.
+// NOTE: Initialization may race, but all threads
+// will write the same value.
+static volatile uint32_t cpuflags = 0;
+static volatile int cpuflags_init = 0;
+
+#ifdef CPUFLAGS_X86
+/**
+ * Run CPUID.
+ * @param leaf		[in] Leaf.
+ * @param subleaf	[in] Subleaf.
+ * @param regs		[out] EAX, EBX, ECX, EDX.
+ * @return 0 on success; non-zero if the leaf isn't supported.
+ */
+static int do_cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if ((uint32_t)info[0] < leaf)
+		return -1;
+	__cpuidex(info, (int)leaf, (int)subleaf);
+	regs[0] = info[0]; regs[1] = info[1];
+	regs[2] = info[2]; regs[3] = info[3];
+	return 0;
+#elif defined(__GNUC__)
+	unsigned int a, b, c, d;
+	if (__get_cpuid_max(0, NULL) < leaf)
+		return -1;
+	__cpuid_count(leaf, subleaf, a, b, c, d);
+	regs[0] = a; regs[1] = b;
+	regs[2] = c; regs[3] = d;
+	return 0;
+#else
+	(void)leaf; (void)subleaf; (void)regs;
+	return -1;
+#endif
+}
+
+/**
+ * Read XCR0.
+ * Only call this if CPUID reports OSXSAVE.
+ * @return XCR0 (low 32 bits)
+ */
+static uint32_t do_xgetbv(void)
+{
+#if defined(_MSC_VER)
+	return (uint32_t)_xgetbv(0);
+#elif defined(__GNUC__)
+	uint32_t eax, edx;
+	__asm__ __volatile__ (".byte 0x0F, 0x01, 0xD0"	/* xgetbv */
+		: "=a" (eax), "=d" (edx) : "c" (0));
+	(void)edx;
+	return eax;
+#else
+	return 0;
+#endif
+}
+#endif /* CPUFLAGS_X86 */
+
+/**
+ * Get the CPU flags.
+ * The CPU is only checked once; subsequent calls
+ * return the cached value.
+ *
+ * AVX and AVX2 are only reported if the OS
+ * saves the YMM registers on context switch.
+ *
+ * @return CPU flags. (CPUFLAG_*; 0 if not x86)
+ */
+uint32_t cpuflags_get(void)
+{
+#ifdef CPUFLAGS_X86
+	uint32_t regs[4];
+	uint32_t flags = 0;
+
+	if (cpuflags_init)
+		return cpuflags;
+
+	if (do_cpuid(1, 0, regs) == 0) {
+		const uint32_t ecx = regs[2];
+		const uint32_t edx = regs[3];
+
+		if (edx & (1U << 26))
+			flags |= CPUFLAG_X86_SSE2;
+		if (ecx & (1U << 9))
+			flags |= CPUFLAG_X86_SSSE3;
+		if (ecx & (1U << 19))
+			flags |= CPUFLAG_X86_SSE41;
+		if (ecx & (1U << 1))
+			flags |= CPUFLAG_X86_PCLMULQDQ;
+
+		// AVX requires OS support for saving the YMM registers.
+		// (OSXSAVE, plus XCR0 bits 1 and 2)
+		if ((ecx & (1U << 28)) && (ecx & (1U << 27)) &&
+		    (do_xgetbv() & 0x6) == 0x6)
+		{
+			flags |= CPUFLAG_X86_AVX;
+			if (do_cpuid(7, 0, regs) == 0 && (regs[1] & (1U << 5)))
+				flags |= CPUFLAG_X86_AVX2;
+		}
+	}
+
+	cpuflags = flags;
+	cpuflags_init = 1;
+	return flags;
+#else /* !CPUFLAGS_X86 */
+	(void)cpuflags;
+	(void)cpuflags_init;
+	return 0;
+#endif /* CPUFLAGS_X86 */
+}
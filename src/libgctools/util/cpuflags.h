@@ -0,0 +1,68 @@
+/***************************************************************************
+ * GameCube Tools Library.                                                 *
+ * cpuflags.h: CPU feature detection.                                      *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __LIBGCTOOLS_CPUFLAGS_H__
+#define __LIBGCTOOLS_CPUFLAGS_H__
+
+// C includes.
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__i386__) || defined(__x86_64__) || defined(__amd64__) || \
+    defined(_M_IX86) || defined(_M_X64)
+#  define CPUFLAGS_X86 1
+#endif
+
+#if defined(__x86_64__) || defined(__amd64__) || defined(_M_X64) || \
+    defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+// SSE2 is always available on this target.
+#  define CPUFLAGS_HAS_SSE2_ALWAYS 1
+#endif
+
+/**
+ * Function target attribute for optimized code paths.
+ * MSVC allows intrinsics in any function, so this is
+ * only needed for gcc and clang.
+ *
+ * Functions using this attribute must only be called
+ * if the corresponding CPU flag is set.
+ */
+#if defined(__GNUC__) && defined(CPUFLAGS_X86)
+#  define CPUFLAGS_TARGET(x) __attribute__((target(x)))
+#else
+#  define CPUFLAGS_TARGET(x)
+#endif
+
+// x86 CPU flags.
+#define CPUFLAG_X86_SSE2	(1U << 0)
+#define CPUFLAG_X86_SSSE3	(1U << 1)
+#define CPUFLAG_X86_SSE41	(1U << 2)
+#define CPUFLAG_X86_PCLMULQDQ	(1U << 3)
+#define CPUFLAG_X86_AVX		(1U << 4)
+#define CPUFLAG_X86_AVX2	(1U << 5)
+
+/**
+ * Get the CPU flags.
+ * The CPU is only checked once; subsequent calls
+ * return the cached value.
+ *
+ * AVX and AVX2 are only reported if the OS
+ * saves the YMM registers on context switch.
+ *
+ * @return CPU flags. (CPUFLAG_*; 0 if not x86)
+ */
+uint32_t cpuflags_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LIBGCTOOLS_CPUFLAGS_H__ */
@@ -0,0 +1,117 @@
+/***************************************************************************
+ * GameCube Tools Library.                                                 *
+ * log.c: Leveled logging.                                                 *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "log.h"
+
+// C includes.
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#  define strcasecmp _stricmp
+#else
+#  include <strings.h>
+#endif
+
+// Current log level.
+// NOTE: Initialization may race, but all threads
+// will write the same value.
+static volatile int loglevel = LOGLEVEL_NONE;
+static volatile int loglevel_init = 0;
+
+/**
+ * Parse the MCRECOVER_LOG_LEVEL environment variable.
+ * @return Log level.
+ */
+static LogLevel log_level_from_env(void)
+{
+	static const char *const names[] = {
+		"none", "error", "warning", "info", "debug"
+	};
+	const char *const env = getenv("MCRECOVER_LOG_LEVEL");
+	unsigned int i;
+
+	if (!env || env[0] == '\0')
+		return LOGLEVEL_NONE;
+
+	if (isdigit((unsigned char)env[0])) {
+		int level = atoi(env);
+		if (level > LOGLEVEL_DEBUG)
+			level = LOGLEVEL_DEBUG;
+		return (LogLevel)level;
+	}
+
+	for (i = 0; i < sizeof(names)/sizeof(names[0]); i++) {
+		if (!strcasecmp(env, names[i]))
+			return (LogLevel)i;
+	}
+
+	// Unknown level name.
+	return LOGLEVEL_NONE;
+}
+
+/**
+ * Get the current log level.
+ *
+ * On first use, the log level is initialized from the
+ * MCRECOVER_LOG_LEVEL environment variable, which can be
+ * either a number or a level name. ("none", "error",
+ * "warning", "info", "debug")
+ * If it isn't set, logging is disabled.
+ *
+ * @return Current log level.
+ */
+LogLevel log_level(void)
+{
+	if (!loglevel_init) {
+		loglevel = log_level_from_env();
+		loglevel_init = 1;
+	}
+	return (LogLevel)loglevel;
+}
+
+/**
+ * Set the log level.
+ * This overrides MCRECOVER_LOG_LEVEL.
+ * @param level New log level.
+ */
+void log_set_level(LogLevel level)
+{
+	loglevel = level;
+	loglevel_init = 1;
+}
+
+/**
+ * Print a message to stderr, regardless of the log level.
+ * Use the LOG() macro instead, which checks the level
+ * before evaluating the arguments.
+ * @param level Log level. (used for the message prefix)
+ * @param fmt printf()-style format string.
+ */
+void log_printf(LogLevel level, const char *fmt, ...)
+{
+	va_list ap;
+
+	switch (level) {
+		case LOGLEVEL_ERROR:
+			fputs("ERROR: ", stderr);
+			break;
+		case LOGLEVEL_WARNING:
+			fputs("WARNING: ", stderr);
+			break;
+		default:
+			break;
+	}
+
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+}
@@ -0,0 +1,87 @@
+/***************************************************************************
+ * GameCube Tools Library.                                                 *
+ * log.h: Leveled logging.                                                 *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __LIBGCTOOLS_UTIL_LOG_H__
+#define __LIBGCTOOLS_UTIL_LOG_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Log levels.
+ * Messages are printed to stderr if their level
+ * is less than or equal to the current log level.
+ */
+typedef enum {
+	LOGLEVEL_NONE		= 0,	// Logging is disabled. (default)
+	LOGLEVEL_ERROR		= 1,
+	LOGLEVEL_WARNING	= 2,
+	LOGLEVEL_INFO		= 3,
+	LOGLEVEL_DEBUG		= 4,	// Very verbose, e.g. per-block messages.
+} LogLevel;
+
+#if defined(__GNUC__)
+#  define LOG_ATTR_PRINTF(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+#  define LOG_ATTR_PRINTF(fmt, args)
+#endif
+
+/**
+ * Get the current log level.
+ *
+ * On first use, the log level is initialized from the
+ * MCRECOVER_LOG_LEVEL environment variable, which can be
+ * either a number or a level name. ("none", "error",
+ * "warning", "info", "debug")
+ * If it isn't set, logging is disabled.
+ *
+ * @return Current log level.
+ */
+LogLevel log_level(void);
+
+/**
+ * Set the log level.
+ * This overrides MCRECOVER_LOG_LEVEL.
+ * @param level New log level.
+ */
+void log_set_level(LogLevel level);
+
+/**
+ * Print a message to stderr, regardless of the log level.
+ * Use the LOG() macro instead, which checks the level
+ * before evaluating the arguments.
+ * @param level Log level. (used for the message prefix)
+ * @param fmt printf()-style format string.
+ */
+void log_printf(LogLevel level, const char *fmt, ...) LOG_ATTR_PRINTF(2, 3);
+
+/**
+ * Check if messages at the specified level are printed.
+ * @param level Log level.
+ * @return Non-zero if enabled; 0 if not.
+ */
+#define LOG_ENABLED(level) ((level) <= log_level())
+
+/**
+ * Log a message if the log level is high enough.
+ * The arguments aren't evaluated if the message isn't printed.
+ * @param level Log level.
+ * @param ... printf()-style format string and arguments.
+ */
+#define LOG(level, ...) do { \
+	if (LOG_ENABLED(level)) { \
+		log_printf((level), __VA_ARGS__); \
+	} \
+} while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LIBGCTOOLS_UTIL_LOG_H__ */
@@ -10,20 +10,37 @@
 #include "Card_p.hpp"
 #include "File.hpp"
 
+// libgctools
+#include "ByteScan.hpp"
+
 // C includes. (C++ namespace)
+#include <cerrno>
 #include <cstring>
 #include <cstdio>
 #include <cassert>
 
 // C++ includes.
+#include <algorithm>
 #include <limits>
 
+// fsync()
+#ifdef _WIN32
+# include <io.h>
+#else
+# include <unistd.h>
+#endif
+
 // Qt includes.
 #include <QtCore/QFile>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QSaveFile>
 #include <QtCore/QVector>
 
 #define NUM_ELEMENTS(x) ((int)(sizeof(x) / sizeof(x[0])))
 
+// Default memory mapping setting for new Card objects.
+static QAtomicInt DefaultMemoryMapped(1);
+
 /** CardPrivate **/
 
 CardPrivate::CardPrivate(Card *q, uint32_t blockSize,
@@ -36,6 +53,12 @@ CardPrivate::CardPrivate(Card *q, uint32_t blockSize,
 	, filesize(0)
 	, readOnly(true)
 	, canMakeWritable(false)
+	, mmapData(nullptr)
+	, mmapSize(0)
+	, useMmap(DefaultMemoryMapped.loadAcquire() != 0)
+	, overlayEnabled(false)
+	, blockCacheHits(0)
+	, blockCacheMisses(0)
 	, encoding(Card::Encoding::Unknown)
 	, blockSize(blockSize)
 	, headerSize(headerSize)
@@ -63,6 +86,10 @@ CardPrivate::CardPrivate(Card *q, uint32_t blockSize,
 	bat_info.active = -1;
 	bat_info.active_hdr = 0;
 	bat_info.valid = 0;
+
+	// Default to caching the entire card, so each
+	// block is only read from the file once.
+	blockCache.setMaxCost(maxBlocks);
 }
 
 CardPrivate::~CardPrivate()
@@ -72,6 +99,7 @@ CardPrivate::~CardPrivate()
 	lstFiles.clear();
 
 	if (file) {
+		unmapFile();
 		file->close();
 		delete file;
 	}
@@ -143,6 +171,12 @@ int CardPrivate::open(const QString &filename, QIODevice::OpenModeFlag openMode)
 		this->errors |= Card::MCE_SZ_NON_POW2;
 	}
 
+	if (useMmap) {
+		// Attempt to memory-map the file.
+		// If this fails, QFile::read() will be used instead.
+		mapFile();
+	}
+
 	// Card is open.
 	return 0;
 }
@@ -158,10 +192,18 @@ void CardPrivate::close(void)
 		return;
 	}
 
+	unmapFile();
 	file->close();
 	delete file;
 	file = nullptr;
 
+	// Discard the overlay and the block cache.
+	overlay.clear();
+	overlayCount.storeRelease(0);
+	blockCache.clear();
+	blockCacheHits = 0;
+	blockCacheMisses = 0;
+
 	// Clear the cached values.
 	filename.clear();
 	filesize = 0;
@@ -170,6 +212,77 @@ void CardPrivate::close(void)
 	freeBlocks = 0;
 }
 
+/**
+ * Memory-map the currently-opened Memory Card image.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int CardPrivate::mapFile(void)
+{
+	if (!file)
+		return -EBADF;
+	if (mmapData)
+		return 0;
+
+	// Only map the area that's actually used by the card.
+	qint64 size = file->size();
+	const qint64 maxSize = ((qint64)maxBlocks * blockSize) + headerSize;
+	if (size > maxSize)
+		size = maxSize;
+	if (size <= (qint64)headerSize)
+		return -EINVAL;
+
+	// NOTE: Writes are still done using QFile::write().
+	// The mapping is shared, so it sees those writes.
+	uchar *data = file->map(0, size);
+	if (!data)
+		return -ENOMEM;	// TODO: Proper error code?
+
+	mmapData = data;
+	mmapSize = size;
+	return 0;
+}
+
+/**
+ * Unmap the currently-opened Memory Card image.
+ */
+void CardPrivate::unmapFile(void)
+{
+	if (!mmapData)
+		return;
+
+	file->unmap(mmapData);
+	mmapData = nullptr;
+	mmapSize = 0;
+}
+
+/**
+ * Write a block to the copy-on-write overlay.
+ * NOTE: fileMutex must be locked by the caller.
+ * @param buf Block data. (Must be blockSize bytes.)
+ * @param blockIdx Block index.
+ */
+void CardPrivate::overlayWrite(const void *buf, uint16_t blockIdx)
+{
+	QHash<uint16_t, QByteArray>::iterator iter = overlay.find(blockIdx);
+	if (iter != overlay.end()) {
+		// Block is already in the overlay.
+		memcpy(iter->data(), buf, blockSize);
+	} else {
+		overlay.insert(blockIdx, QByteArray(static_cast<const char*>(buf), blockSize));
+		overlayCount.storeRelease(overlay.size());
+	}
+}
+
+/**
+ * Clear the block cache.
+ * This locks fileMutex.
+ */
+void CardPrivate::clearBlockCache(void)
+{
+	QMutexLocker locker(&fileMutex);
+	blockCache.clear();
+}
+
 /**
  * Find the most common byte in a block of data.
  * This is useful for determining header garbage.
@@ -180,6 +293,18 @@ void CardPrivate::close(void)
  */
 void CardPrivate::findMostCommonByte(const uint8_t *buf, size_t siz, uint8_t *most_byte, int *count)
 {
+	// Blank headers are usually a single repeated byte.
+	uint8_t uniform_byte;
+	if (ByteScan::isUniform(buf, siz, &uniform_byte)) {
+		if (most_byte) {
+			*most_byte = uniform_byte;
+		}
+		if (count) {
+			*count = (int)siz;
+		}
+		return;
+	}
+
 	int bytes[256];
 	memset(bytes, 0, sizeof(bytes));
 
@@ -318,10 +443,18 @@ int Card::setReadOnly(bool readOnly)
 
 	// TODO: Validate that this file is the same as the one we had before.
 	// TODO: Atomic swap of d->file and tmp_file.
+	QMutexLocker locker(&d->fileMutex);
+	const bool wasMapped = (d->mmapData != nullptr);
+	d->unmapFile();
 	std::swap(d->file, tmp_file);
 	d->readOnly = readOnly;
 	tmp_file->close();
 	delete tmp_file;
+
+	if (wasMapped) {
+		// Map the new file.
+		d->mapFile();
+	}
 	return 0;
 }
 
@@ -335,6 +468,205 @@ bool Card::canMakeWritable(void) const
 	return d->canMakeWritable;
 }
 
+/**
+ * Is the copy-on-write overlay enabled?
+ * @return True if enabled; false if not.
+ */
+bool Card::isOverlayEnabled(void) const
+{
+	Q_D(const Card);
+	return d->overlayEnabled;
+}
+
+/**
+ * Enable or disable the copy-on-write overlay.
+ *
+ * If enabled, writeBlock() and writeBlocks() store modified
+ * blocks in memory instead of writing them to the image.
+ * This works even if the card is read-only, since the image
+ * isn't modified until commitOverlay() is called.
+ * Reads see the modified blocks. Use commitOverlay() to write
+ * the modified blocks to the image, saveOverlayAs() to write
+ * a new image, or discardOverlay() to throw them away.
+ *
+ * The overlay can't be disabled while it has pending changes.
+ *
+ * @param enabled True to enable; false to disable.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Card::setOverlayEnabled(bool enabled)
+{
+	Q_D(Card);
+	QMutexLocker locker(&d->fileMutex);
+	if (!enabled && !d->overlay.isEmpty())
+		return -EBUSY;
+	d->overlayEnabled = enabled;
+	return 0;
+}
+
+/**
+ * Get the number of modified blocks in the copy-on-write overlay.
+ * @return Number of modified blocks.
+ */
+int Card::overlayBlockCount(void) const
+{
+	Q_D(const Card);
+	return d->overlayCount.loadAcquire();
+}
+
+/**
+ * Does the copy-on-write overlay have pending changes?
+ * @return True if any blocks have been modified; false if not.
+ */
+bool Card::hasPendingChanges(void) const
+{
+	Q_D(const Card);
+	return (d->overlayCount.loadAcquire() > 0);
+}
+
+/**
+ * Write the modified blocks in the copy-on-write overlay to the image.
+ *
+ * Blocks are written in ascending order, and the image is
+ * synced to disk before the overlay is cleared. If an error
+ * occurs, the overlay is kept, so the commit can be retried.
+ * The card must not be read-only.
+ *
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Card::commitOverlay(void)
+{
+	Q_D(Card);
+	if (!isOpen())
+		return -EBADF;
+	if (d->readOnly)
+		return -EROFS;
+
+	QMutexLocker locker(&d->fileMutex);
+	if (d->overlay.isEmpty())
+		return 0;
+
+	QList<uint16_t> blockIdxs = d->overlay.keys();
+	std::sort(blockIdxs.begin(), blockIdxs.end());
+	foreach (uint16_t blockIdx, blockIdxs) {
+		d->blockCache.remove(blockIdx);
+		const qint64 pos = ((qint64)blockIdx * d->blockSize) + d->headerSize;
+		if (!d->file->seek(pos))
+			return -EIO;	// TODO: Proper error code?
+		const QByteArray &block = d->overlay.value(blockIdx);
+		if (d->file->write(block) != (qint64)d->blockSize)
+			return -EIO;
+	}
+
+	// Make sure the data is on disk before dropping the overlay.
+	if (!d->file->flush())
+		return -EIO;
+#ifdef _WIN32
+	if (_commit(d->file->handle()) != 0)
+		return -EIO;
+#else
+	if (fsync(d->file->handle()) != 0)
+		return -errno;
+#endif
+
+	d->overlay.clear();
+	d->overlayCount.storeRelease(0);
+	locker.unlock();
+	emit pendingChangesChanged(false);
+	return 0;
+}
+
+/**
+ * Write a new image containing the original image
+ * with the copy-on-write overlay applied.
+ *
+ * The original image and the overlay are not modified.
+ *
+ * @param filename Filename for the new image.
+ * @return 0 on success; negative POSIX error code on error.
+ * (Check this->errorString for more information.)
+ */
+int Card::saveOverlayAs(const QString &filename)
+{
+	Q_D(Card);
+	if (!isOpen())
+		return -EBADF;
+
+	QSaveFile outFile(filename);
+	if (!outFile.open(QIODevice::WriteOnly)) {
+		// TODO: Translate the error message.
+		d->errorString = outFile.errorString();
+		return -EIO;
+	}
+
+	QMutexLocker locker(&d->fileMutex);
+	QByteArray buf;
+
+	// Copy the header.
+	if (d->headerSize > 0) {
+		if (!d->file->seek(0))
+			return -EIO;
+		buf = d->file->read(d->headerSize);
+		if (buf.size() != (int)d->headerSize || outFile.write(buf) != buf.size())
+			return -EIO;
+	}
+
+	// Copy the blocks, using the overlay where possible.
+	buf.resize(d->blockSize);
+	for (int i = 0; i < d->totalPhysBlocks; i++) {
+		const uint8_t *const ovl = d->overlayBlock((uint16_t)i);
+		if (ovl) {
+			if (outFile.write(reinterpret_cast<const char*>(ovl), d->blockSize) != (qint64)d->blockSize)
+				return -EIO;
+			continue;
+		}
+
+		const qint64 pos = ((qint64)i * d->blockSize) + d->headerSize;
+		if (!d->file->seek(pos) ||
+		    d->file->read(buf.data(), d->blockSize) != (qint64)d->blockSize ||
+		    outFile.write(buf) != buf.size())
+		{
+			return -EIO;
+		}
+	}
+
+	// Copy any trailing data.
+	const qint64 trailingPos = ((qint64)d->totalPhysBlocks * d->blockSize) + d->headerSize;
+	if (d->file->size() > trailingPos) {
+		if (!d->file->seek(trailingPos))
+			return -EIO;
+		while (!d->file->atEnd()) {
+			buf = d->file->read(65536);
+			if (buf.isEmpty() || outFile.write(buf) != buf.size())
+				return -EIO;
+		}
+	}
+
+	if (!outFile.commit()) {
+		d->errorString = outFile.errorString();
+		return -EIO;
+	}
+	return 0;
+}
+
+/**
+ * Discard all modified blocks in the copy-on-write overlay.
+ *
+ * NOTE: Cached file information isn't reloaded, so any
+ * File objects that were modified should be reloaded.
+ */
+void Card::discardOverlay(void)
+{
+	Q_D(Card);
+	QMutexLocker locker(&d->fileMutex);
+	if (d->overlay.isEmpty())
+		return;
+	d->overlay.clear();
+	d->overlayCount.storeRelease(0);
+	locker.unlock();
+	emit pendingChangesChanged(false);
+}
+
 /** Card information **/
 
 /**
@@ -614,22 +946,47 @@ int Card::readBlock(void *buf, int siz, uint16_t blockIdx)
 {
 	Q_D(Card);
 	if (!isOpen())
-		return EBADF;
+		return -EBADF;
 	else if (siz < (int)d->blockSize)
 		return -EINVAL;
 	else if (siz == 0)
 		return 0;
 
 	// Read the specified block.
+	// NOTE: The lost file scan may call this from multiple threads.
+	// fileMutex must be locked even if the file is memory-mapped,
+	// since setMemoryMapped() and setReadOnly() unmap the file.
+	QMutexLocker locker(&d->fileMutex);
+	const uint8_t *ptr = d->overlayBlock(blockIdx);
+	if (!ptr) {
+		ptr = d->mmapBlock(blockIdx);
+		if (!ptr) {
+			ptr = d->cachedBlock(blockIdx);
+		}
+	}
+	if (ptr) {
+		// Block is in the overlay, the memory-mapped file,
+		// or the block cache. Copy it while fileMutex is
+		// locked, since overlay blocks may be modified.
+		memcpy(buf, ptr, d->blockSize);
+		return d->blockSize;
+	}
+
+	d->blockCacheMisses++;
 	const qint64 pos = ((qint64)blockIdx * d->blockSize) + d->headerSize;
 	if (!d->file->seek(pos))
 		return -EIO;	// TODO: Proper error code?
 	int ret = (int)d->file->read((char*)buf, d->blockSize);
+	if (ret == (int)d->blockSize) {
+		d->cacheBlock(buf, blockIdx);
+	}
 	return (ret >= 0 ? ret : -EIO);
 }
 
 /**
  * Write a block.
+ * If the copy-on-write overlay is enabled, the block
+ * is written to the overlay instead of the image.
  * @param buf Buffer containing the data to write.
  * @param siz Size of buffer. (Must be equal to blockSize.)
  * @param blockIdx Block index.
@@ -645,6 +1002,23 @@ int Card::writeBlock(const void *buf, int siz, uint16_t blockIdx)
 	else if (siz == 0)
 		return 0;
 
+	QMutexLocker locker(&d->fileMutex);
+	d->blockCache.remove(blockIdx);
+	if (d->overlayEnabled) {
+		// Write the block to the overlay.
+		// NOTE: This is allowed even if the card is read-only,
+		// since the image isn't modified until commitOverlay().
+		if (blockIdx >= d->totalPhysBlocks)
+			return -EINVAL;
+		const bool hadChanges = !d->overlay.isEmpty();
+		d->overlayWrite(buf, blockIdx);
+		locker.unlock();
+		if (!hadChanges) {
+			emit pendingChangesChanged(true);
+		}
+		return d->blockSize;
+	}
+
 	// Make sure the card isn't read-only.
 	if (d->readOnly)
 		return -EROFS;
@@ -658,7 +1032,335 @@ int Card::writeBlock(const void *buf, int siz, uint16_t blockIdx)
 	return (ret >= 0 ? ret : -EIO);
 }
 
-// TODO: Add readBlocks() and writeBlocks() functions?
+/**
+ * Get the length of a contiguous run of block indexes.
+ * @param blockIdxs Block indexes.
+ * @param count Number of block indexes.
+ * @return Number of contiguous block indexes at the start of blockIdxs.
+ */
+static inline int contiguousRunLength(const uint16_t *blockIdxs, int count)
+{
+	int run = 1;
+	while (run < count && blockIdxs[run] == (uint16_t)(blockIdxs[0] + run)) {
+		run++;
+	}
+	return run;
+}
+
+/**
+ * Read multiple blocks.
+ * Contiguous runs of block indexes are read using a single read.
+ * @param buf Buffer to read the block data into.
+ * @param siz Size of buffer. (Must be >= blockSize * count.)
+ * @param blockIdxs Block indexes.
+ * @param count Number of block indexes.
+ * @return Bytes read on success; negative POSIX error code on error.
+ */
+int Card::readBlocks(void *buf, int siz, const uint16_t *blockIdxs, int count)
+{
+	Q_D(Card);
+	if (!isOpen())
+		return -EBADF;
+	else if (count < 0 || siz < (int)(d->blockSize * count))
+		return -EINVAL;
+	else if (count == 0)
+		return 0;
+
+	uint8_t *pDest = static_cast<uint8_t*>(buf);
+	int total = 0;
+
+	// NOTE: fileMutex must be locked even if the file is memory-mapped,
+	// since setMemoryMapped() and setReadOnly() unmap the file.
+	// Blocks that aren't mapped are read using QFile::read().
+	QMutexLocker locker(&d->fileMutex);
+	while (count > 0) {
+		const uint8_t *ptr = d->overlayBlock(blockIdxs[0]);
+		if (!ptr) {
+			ptr = d->mmapBlock(blockIdxs[0]);
+			if (!ptr) {
+				ptr = d->cachedBlock(blockIdxs[0]);
+			}
+		}
+		if (ptr) {
+			// Block is in the overlay, the memory-mapped file,
+			// or the block cache.
+			memcpy(pDest, ptr, d->blockSize);
+			total += d->blockSize;
+			blockIdxs++;
+			count--;
+			pDest += d->blockSize;
+			continue;
+		}
+
+		// Runs stop at the first block that's in the overlay
+		// or the block cache.
+		int run = contiguousRunLength(blockIdxs, count);
+		if (!d->overlay.isEmpty() || !d->blockCache.isEmpty()) {
+			for (int i = 1; i < run; i++) {
+				if (d->overlayBlock(blockIdxs[i]) || d->blockCache.contains(blockIdxs[i])) {
+					run = i;
+					break;
+				}
+			}
+		}
+		const qint64 runSize = (qint64)run * d->blockSize;
+		d->blockCacheMisses += run;
+
+		// Read the run.
+		const qint64 pos = ((qint64)blockIdxs[0] * d->blockSize) + d->headerSize;
+		if (!d->file->seek(pos))
+			return (total > 0 ? total : -EIO);
+		const qint64 ret = d->file->read((char*)pDest, runSize);
+		if (ret < 0)
+			return (total > 0 ? total : -EIO);
+		total += (int)ret;
+
+		// Cache the blocks that were read completely.
+		const int blocksRead = (int)(ret / d->blockSize);
+		for (int i = 0; i < blocksRead; i++) {
+			d->cacheBlock(pDest + ((qint64)i * d->blockSize), blockIdxs[i]);
+		}
+		if (ret != runSize) {
+			// Short read.
+			break;
+		}
+
+		blockIdxs += run;
+		count -= run;
+		pDest += runSize;
+	}
+
+	return total;
+}
+
+/**
+ * Write multiple blocks.
+ * Contiguous runs of block indexes are written using a single write.
+ * If the copy-on-write overlay is enabled, the blocks
+ * are written to the overlay instead of the image.
+ * @param buf Buffer containing the data to write.
+ * @param siz Size of buffer. (Must be >= blockSize * count.)
+ * @param blockIdxs Block indexes.
+ * @param count Number of block indexes.
+ * @return Bytes written on success; negative POSIX error code on error.
+ */
+int Card::writeBlocks(const void *buf, int siz, const uint16_t *blockIdxs, int count)
+{
+	Q_D(Card);
+	if (!isOpen())
+		return -EBADF;
+	else if (count < 0 || siz < (int)(d->blockSize * count))
+		return -EINVAL;
+	else if (count == 0)
+		return 0;
+
+	const uint8_t *pSrc = static_cast<const uint8_t*>(buf);
+	int total = 0;
+
+	QMutexLocker locker(&d->fileMutex);
+	for (int i = 0; i < count; i++) {
+		d->blockCache.remove(blockIdxs[i]);
+	}
+	if (d->overlayEnabled) {
+		// Write the blocks to the overlay.
+		// NOTE: This is allowed even if the card is read-only,
+		// since the image isn't modified until commitOverlay().
+		const bool hadChanges = !d->overlay.isEmpty();
+		for (int i = 0; i < count; i++, pSrc += d->blockSize) {
+			if (blockIdxs[i] >= d->totalPhysBlocks)
+				break;
+			d->overlayWrite(pSrc, blockIdxs[i]);
+			total += d->blockSize;
+		}
+		const bool hasChanges = !d->overlay.isEmpty();
+		locker.unlock();
+		if (!hadChanges && hasChanges) {
+			emit pendingChangesChanged(true);
+		}
+		return (total > 0 ? total : -EINVAL);
+	}
+
+	// Make sure the card isn't read-only.
+	if (d->readOnly)
+		return -EROFS;
+
+	while (count > 0) {
+		const int run = contiguousRunLength(blockIdxs, count);
+		const qint64 runSize = (qint64)run * d->blockSize;
+
+		// Write the run.
+		const qint64 pos = ((qint64)blockIdxs[0] * d->blockSize) + d->headerSize;
+		if (!d->file->seek(pos))
+			return (total > 0 ? total : -EIO);
+		const qint64 ret = d->file->write((const char*)pSrc, runSize);
+		if (ret < 0)
+			return (total > 0 ? total : -EIO);
+		total += (int)ret;
+		if (ret != runSize) {
+			// Short write.
+			break;
+		}
+
+		blockIdxs += run;
+		count -= run;
+		pSrc += runSize;
+	}
+
+	return total;
+}
+
+/**
+ * Get a pointer to a block in the memory-mapped file.
+ *
+ * The pointer is valid until the card is closed,
+ * setReadOnly() is called, or memory mapping is disabled.
+ * Writes done using writeBlock() are visible through it.
+ *
+ * If the block has been modified in the copy-on-write
+ * overlay, nullptr is returned; use readBlock() instead.
+ *
+ * @param blockIdx Block index.
+ * @return Pointer to the block data, or nullptr if the file isn't mapped or blockIdx is out of range.
+ */
+const uint8_t *Card::blockPtr(uint16_t blockIdx) const
+{
+	Q_D(const Card);
+	if (!d->mmapData)
+		return nullptr;
+
+	if (d->overlayCount.loadAcquire() > 0) {
+		// Modified blocks must be read using readBlock(),
+		// which copies them while fileMutex is locked.
+		QMutexLocker locker(&d->fileMutex);
+		if (d->overlayBlock(blockIdx))
+			return nullptr;
+	}
+
+	return d->mmapBlock(blockIdx);
+}
+
+/**
+ * Is the Memory Card image memory-mapped?
+ * @return True if memory-mapped; false if not.
+ */
+bool Card::isMemoryMapped(void) const
+{
+	Q_D(const Card);
+	return (d->mmapData != nullptr);
+}
+
+/**
+ * Enable or disable memory mapping for the Memory Card image.
+ *
+ * Memory mapping is enabled by default. If the file
+ * cannot be mapped, QFile::read() is used instead.
+ *
+ * NOTE: Disabling memory mapping invalidates all
+ * pointers returned by blockPtr().
+ *
+ * @param mapped True to memory-map the file; false to use QFile::read().
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int Card::setMemoryMapped(bool mapped)
+{
+	Q_D(Card);
+	d->useMmap = mapped;
+	if (!isOpen())
+		return 0;
+
+	QMutexLocker locker(&d->fileMutex);
+	if (mapped) {
+		return d->mapFile();
+	}
+	d->unmapFile();
+	return 0;
+}
+
+/**
+ * Are new Memory Card images memory-mapped by default?
+ * @return True if memory-mapped by default; false if not.
+ */
+bool Card::defaultMemoryMapped(void)
+{
+	return (DefaultMemoryMapped.loadAcquire() != 0);
+}
+
+/**
+ * Set whether new Memory Card images are memory-mapped by default.
+ *
+ * This only affects Card objects created after it's called.
+ * Images that aren't memory-mapped use QFile::read(), and
+ * blocks are kept in the block cache.
+ *
+ * @param mapped True to memory-map new images; false to use QFile::read().
+ */
+void Card::setDefaultMemoryMapped(bool mapped)
+{
+	DefaultMemoryMapped.storeRelease(mapped ? 1 : 0);
+}
+
+/**
+ * Get the block cache size.
+ * @return Maximum number of blocks in the block cache.
+ */
+int Card::blockCacheSize(void) const
+{
+	Q_D(const Card);
+	QMutexLocker locker(&d->fileMutex);
+	return d->blockCache.maxCost();
+}
+
+/**
+ * Set the block cache size.
+ *
+ * Blocks read using QFile::read() are cached, so each block
+ * is only read from the file once. Memory-mapped blocks are
+ * already cached by the OS, so they aren't cached here.
+ * The least recently used blocks are evicted first.
+ *
+ * The default size is the maximum number of blocks
+ * for the card type, i.e. the entire card is cached.
+ *
+ * @param blocks Maximum number of blocks to cache. (0 to disable)
+ */
+void Card::setBlockCacheSize(int blocks)
+{
+	Q_D(Card);
+	QMutexLocker locker(&d->fileMutex);
+	d->blockCache.setMaxCost(blocks > 0 ? blocks : 0);
+}
+
+/**
+ * Get the number of block reads that were handled by the block cache.
+ * @return Number of block cache hits.
+ */
+quint64 Card::blockCacheHits(void) const
+{
+	Q_D(const Card);
+	QMutexLocker locker(&d->fileMutex);
+	return d->blockCacheHits;
+}
+
+/**
+ * Get the number of block reads that had to read from the file.
+ * @return Number of block cache misses.
+ */
+quint64 Card::blockCacheMisses(void) const
+{
+	Q_D(const Card);
+	QMutexLocker locker(&d->fileMutex);
+	return d->blockCacheMisses;
+}
+
+/**
+ * Clear the block cache.
+ * The hit and miss counters are not reset.
+ */
+void Card::clearBlockCache(void)
+{
+	Q_D(Card);
+	d->clearBlockCache();
+}
 
 /** File management **/
 
@@ -17,6 +17,7 @@
 #include <QtCore/QObject>
 #include <QtCore/QString>
 #include <QtCore/QTextCodec>
+#include <QtCore/QVector>
 #include <QtGui/QColor>
 
 class File;
@@ -38,6 +39,7 @@ class Card : public QObject
 	Q_PROPERTY(int filesize READ filesize)
 	Q_PROPERTY(bool readOnly READ isReadOnly WRITE setReadOnly NOTIFY readOnlyChanged)
 	Q_PROPERTY(bool canMakeWritable READ canMakeWritable)
+	Q_PROPERTY(bool overlayEnabled READ isOverlayEnabled WRITE setOverlayEnabled)
 
 	// Card size.
 	Q_PROPERTY(int blockSize READ blockSize)
@@ -309,6 +311,8 @@ class Card : public QObject
 
 		/**
 		 * Write a block.
+		 * If the copy-on-write overlay is enabled, the block
+		 * is written to the overlay instead of the image.
 		 * @param buf Buffer containing the data to write.
 		 * @param siz Size of buffer. (Must be equal to blockSize.)
 		 * @param blockIdx Block index.
@@ -316,6 +320,149 @@ class Card : public QObject
 		 */
 		int writeBlock(const void *buf, int siz, uint16_t blockIdx);
 
+		/**
+		 * Read multiple blocks.
+		 * Contiguous runs of block indexes are read using a single read.
+		 * @param buf Buffer to read the block data into.
+		 * @param siz Size of buffer. (Must be >= blockSize * count.)
+		 * @param blockIdxs Block indexes.
+		 * @param count Number of block indexes.
+		 * @return Bytes read on success; negative POSIX error code on error.
+		 */
+		int readBlocks(void *buf, int siz, const uint16_t *blockIdxs, int count);
+
+		/**
+		 * Read multiple blocks.
+		 * Contiguous runs of block indexes are read using a single read.
+		 * @param buf Buffer to read the block data into.
+		 * @param siz Size of buffer. (Must be >= blockSize * blockIdxs.size().)
+		 * @param blockIdxs Block indexes.
+		 * @return Bytes read on success; negative POSIX error code on error.
+		 */
+		inline int readBlocks(void *buf, int siz, const QVector<uint16_t> &blockIdxs)
+		{
+			return readBlocks(buf, siz, blockIdxs.constData(), blockIdxs.size());
+		}
+
+		/**
+		 * Write multiple blocks.
+		 * Contiguous runs of block indexes are written using a single write.
+		 * If the copy-on-write overlay is enabled, the blocks
+		 * are written to the overlay instead of the image.
+		 * @param buf Buffer containing the data to write.
+		 * @param siz Size of buffer. (Must be >= blockSize * count.)
+		 * @param blockIdxs Block indexes.
+		 * @param count Number of block indexes.
+		 * @return Bytes written on success; negative POSIX error code on error.
+		 */
+		int writeBlocks(const void *buf, int siz, const uint16_t *blockIdxs, int count);
+
+		/**
+		 * Write multiple blocks.
+		 * Contiguous runs of block indexes are written using a single write.
+		 * If the copy-on-write overlay is enabled, the blocks
+		 * are written to the overlay instead of the image.
+		 * @param buf Buffer containing the data to write.
+		 * @param siz Size of buffer. (Must be >= blockSize * blockIdxs.size().)
+		 * @param blockIdxs Block indexes.
+		 * @return Bytes written on success; negative POSIX error code on error.
+		 */
+		inline int writeBlocks(const void *buf, int siz, const QVector<uint16_t> &blockIdxs)
+		{
+			return writeBlocks(buf, siz, blockIdxs.constData(), blockIdxs.size());
+		}
+
+		/**
+		 * Get a pointer to a block in the memory-mapped file.
+		 *
+		 * The pointer is valid until the card is closed,
+		 * setReadOnly() is called, or memory mapping is disabled.
+		 * Writes done using writeBlock() are visible through it.
+		 *
+		 * If the block has been modified in the copy-on-write
+		 * overlay, nullptr is returned; use readBlock() instead.
+		 *
+		 * @param blockIdx Block index.
+		 * @return Pointer to the block data, or nullptr if the file isn't mapped or blockIdx is out of range.
+		 */
+		const uint8_t *blockPtr(uint16_t blockIdx) const;
+
+		/**
+		 * Is the Memory Card image memory-mapped?
+		 * @return True if memory-mapped; false if not.
+		 */
+		bool isMemoryMapped(void) const;
+
+		/**
+		 * Enable or disable memory mapping for the Memory Card image.
+		 *
+		 * Memory mapping is enabled by default. If the file
+		 * cannot be mapped, QFile::read() is used instead.
+		 *
+		 * NOTE: Disabling memory mapping invalidates all
+		 * pointers returned by blockPtr().
+		 *
+		 * @param mapped True to memory-map the file; false to use QFile::read().
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int setMemoryMapped(bool mapped);
+
+		/**
+		 * Are new Memory Card images memory-mapped by default?
+		 * @return True if memory-mapped by default; false if not.
+		 */
+		static bool defaultMemoryMapped(void);
+
+		/**
+		 * Set whether new Memory Card images are memory-mapped by default.
+		 *
+		 * This only affects Card objects created after it's called.
+		 * Images that aren't memory-mapped use QFile::read(), and
+		 * blocks are kept in the block cache.
+		 *
+		 * @param mapped True to memory-map new images; false to use QFile::read().
+		 */
+		static void setDefaultMemoryMapped(bool mapped);
+
+		/**
+		 * Get the block cache size.
+		 * @return Maximum number of blocks in the block cache.
+		 */
+		int blockCacheSize(void) const;
+
+		/**
+		 * Set the block cache size.
+		 *
+		 * Blocks read using QFile::read() are cached, so each block
+		 * is only read from the file once. Memory-mapped blocks are
+		 * already cached by the OS, so they aren't cached here.
+		 * The least recently used blocks are evicted first.
+		 *
+		 * The default size is the maximum number of blocks
+		 * for the card type, i.e. the entire card is cached.
+		 *
+		 * @param blocks Maximum number of blocks to cache. (0 to disable)
+		 */
+		void setBlockCacheSize(int blocks);
+
+		/**
+		 * Get the number of block reads that were handled by the block cache.
+		 * @return Number of block cache hits.
+		 */
+		quint64 blockCacheHits(void) const;
+
+		/**
+		 * Get the number of block reads that had to read from the file.
+		 * @return Number of block cache misses.
+		 */
+		quint64 blockCacheMisses(void) const;
+
+		/**
+		 * Clear the block cache.
+		 * The hit and miss counters are not reset.
+		 */
+		void clearBlockCache(void);
+
 		/** File management **/
 	signals:
 		/**
@@ -441,6 +588,12 @@ class Card : public QObject
 		 */
 		void readOnlyChanged(bool readOnly);
 
+		/**
+		 * The copy-on-write overlay's pending changes status has changed.
+		 * @param hasPendingChanges True if any blocks have been modified; false if not.
+		 */
+		void pendingChangesChanged(bool hasPendingChanges);
+
 	public:
 		/**
 		 * Is this card read-only?
@@ -471,6 +624,76 @@ class Card : public QObject
 		 * @return True if it can; false if it can't.
 		 */
 		bool canMakeWritable(void) const;
+
+		/** Copy-on-write overlay **/
+
+		/**
+		 * Is the copy-on-write overlay enabled?
+		 * @return True if enabled; false if not.
+		 */
+		bool isOverlayEnabled(void) const;
+
+		/**
+		 * Enable or disable the copy-on-write overlay.
+		 *
+		 * If enabled, writeBlock() and writeBlocks() store modified
+		 * blocks in memory instead of writing them to the image.
+		 * This works even if the card is read-only, since the image
+		 * isn't modified until commitOverlay() is called.
+		 * Reads see the modified blocks. Use commitOverlay() to write
+		 * the modified blocks to the image, saveOverlayAs() to write
+		 * a new image, or discardOverlay() to throw them away.
+		 *
+		 * The overlay can't be disabled while it has pending changes.
+		 *
+		 * @param enabled True to enable; false to disable.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int setOverlayEnabled(bool enabled);
+
+		/**
+		 * Get the number of modified blocks in the copy-on-write overlay.
+		 * @return Number of modified blocks.
+		 */
+		int overlayBlockCount(void) const;
+
+		/**
+		 * Does the copy-on-write overlay have pending changes?
+		 * @return True if any blocks have been modified; false if not.
+		 */
+		bool hasPendingChanges(void) const;
+
+		/**
+		 * Write the modified blocks in the copy-on-write overlay to the image.
+		 *
+		 * Blocks are written in ascending order, and the image is
+		 * synced to disk before the overlay is cleared. If an error
+		 * occurs, the overlay is kept, so the commit can be retried.
+		 * The card must not be read-only.
+		 *
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int commitOverlay(void);
+
+		/**
+		 * Write a new image containing the original image
+		 * with the copy-on-write overlay applied.
+		 *
+		 * The original image and the overlay are not modified.
+		 *
+		 * @param filename Filename for the new image.
+		 * @return 0 on success; negative POSIX error code on error.
+		 * (Check this->errorString for more information.)
+		 */
+		int saveOverlayAs(const QString &filename);
+
+		/**
+		 * Discard all modified blocks in the copy-on-write overlay.
+		 *
+		 * NOTE: Cached file information isn't reloaded, so any
+		 * File objects that were modified should be reloaded.
+		 */
+		void discardOverlay(void);
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Card::Errors);
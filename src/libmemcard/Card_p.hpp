@@ -12,8 +12,12 @@
 #include "Card.hpp"
 
 // Qt includes.
+#include <QtCore/QAtomicInt>
+#include <QtCore/QCache>
 #include <QtCore/QFile>
 #include <QtCore/QFlags>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
 #include <QtCore/QString>
 #include <QtCore/QVector>
 #include <QtGui/QPixmap>
@@ -56,10 +60,115 @@ class CardPrivate
 		// File information.
 		QString filename;
 		QFile *file;
+		// Serializes seek() + read()/write() on file,
+		// and protects the overlay and the block cache.
+		mutable QMutex fileMutex;
 		quint64 filesize;
 		bool readOnly;
 		bool canMakeWritable;	// subclass should set this
 
+		// Memory-mapped file data.
+		// If mmapData is nullptr, the file is not mapped,
+		// and blocks are read using QFile::read().
+		uchar *mmapData;
+		qint64 mmapSize;
+		bool useMmap;		// map the file on open()
+
+		/**
+		 * Get a pointer to a block in the memory-mapped file.
+		 * This doesn't check the copy-on-write overlay.
+		 * @param blockIdx Block index.
+		 * @return Pointer to the block data, or nullptr if the file isn't mapped or blockIdx is out of range.
+		 */
+		inline const uint8_t *mmapBlock(uint16_t blockIdx) const {
+			if (!mmapData)
+				return nullptr;
+			const qint64 pos = ((qint64)blockIdx * blockSize) + headerSize;
+			if (pos + blockSize > mmapSize)
+				return nullptr;
+			return mmapData + pos;
+		}
+
+		// Copy-on-write overlay.
+		// If overlayEnabled is true, writeBlock() stores modified
+		// blocks here instead of writing them to the file.
+		// Reads check the overlay before reading from the file.
+		// Key is the physical block index; value is the block data.
+		// NOTE: Only accessed with fileMutex locked.
+		QHash<uint16_t, QByteArray> overlay;
+		bool overlayEnabled;
+
+		// Number of blocks in the overlay.
+		// blockPtr() and hasPendingChanges() check this
+		// without locking fileMutex.
+		QAtomicInt overlayCount;
+
+		/**
+		 * Get a block from the copy-on-write overlay.
+		 * NOTE: fileMutex must be locked by the caller.
+		 * @param blockIdx Block index.
+		 * @return Pointer to the block data, or nullptr if the block isn't in the overlay.
+		 */
+		inline const uint8_t *overlayBlock(uint16_t blockIdx) const {
+			if (overlay.isEmpty())
+				return nullptr;
+			QHash<uint16_t, QByteArray>::const_iterator iter = overlay.constFind(blockIdx);
+			return (iter != overlay.constEnd()
+				? reinterpret_cast<const uint8_t*>(iter->constData())
+				: nullptr);
+		}
+
+		/**
+		 * Write a block to the copy-on-write overlay.
+		 * NOTE: fileMutex must be locked by the caller.
+		 * @param buf Block data. (Must be blockSize bytes.)
+		 * @param blockIdx Block index.
+		 */
+		void overlayWrite(const void *buf, uint16_t blockIdx);
+
+		// Block cache.
+		// Used for blocks read with QFile::read() if the file
+		// isn't memory-mapped. Memory-mapped blocks are already
+		// cached by the OS, so they aren't cached here.
+		// Key is the physical block index; cost is 1 per block.
+		// NOTE: Only accessed with fileMutex locked.
+		QCache<uint16_t, QByteArray> blockCache;
+		quint64 blockCacheHits;
+		quint64 blockCacheMisses;
+
+		/**
+		 * Get a block from the block cache.
+		 * NOTE: fileMutex must be locked by the caller.
+		 * @param blockIdx Block index.
+		 * @return Pointer to the block data, or nullptr if the block isn't cached.
+		 */
+		inline const uint8_t *cachedBlock(uint16_t blockIdx) {
+			const QByteArray *const block = blockCache.object(blockIdx);
+			if (!block)
+				return nullptr;
+			blockCacheHits++;
+			return reinterpret_cast<const uint8_t*>(block->constData());
+		}
+
+		/**
+		 * Add a block to the block cache.
+		 * NOTE: fileMutex must be locked by the caller.
+		 * @param buf Block data. (Must be blockSize bytes.)
+		 * @param blockIdx Block index.
+		 */
+		inline void cacheBlock(const void *buf, uint16_t blockIdx) {
+			if (blockCache.maxCost() > 0) {
+				blockCache.insert(blockIdx,
+					new QByteArray(static_cast<const char*>(buf), blockSize));
+			}
+		}
+
+		/**
+		 * Clear the block cache.
+		 * This locks fileMutex.
+		 */
+		void clearBlockCache(void);
+
 		// Card properties.
 		Card::Encoding encoding;
 		QColor color;
@@ -136,6 +245,17 @@ class CardPrivate
 		 */
 		void close(void);
 
+		/**
+		 * Memory-map the currently-opened Memory Card image.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int mapFile(void);
+
+		/**
+		 * Unmap the currently-opened Memory Card image.
+		 */
+		void unmapFile(void);
+
 		/**
 		 * Find the most common byte in a block of data.
 		 * This is useful for determining header garbage.
@@ -44,7 +44,6 @@ FilePrivate::FilePrivate(File *q, Card *card)
 	: q_ptr(q)
 	, card(card)
 	, mode(0)
-	, gcBanner(nullptr)
 	, iconAnimMode(0)
 	, lostFile(false)
 { }
@@ -52,9 +51,11 @@ FilePrivate::FilePrivate(File *q, Card *card)
 FilePrivate::~FilePrivate()
 {
 	// Delete the GcImages.
-	delete gcBanner;
-	qDeleteAll(gcIcons);
-	gcIcons.clear();
+	delete lazyBanner.gcImage;
+	foreach (const LazyImage &lazyIcon, lazyIcons) {
+		delete lazyIcon.gcImage;
+	}
+	lazyIcons.clear();
 }
 
 /**
@@ -88,7 +89,6 @@ uint16_t FilePrivate::fileBlockAddrToPhysBlockAddr(uint16_t fileBlock) const
  */
 QByteArray FilePrivate::loadFileData(void)
 {
-	// TODO: Combine with readBlocks()?
 	// TODO: Add a generic read() function?
 	const int blockSize = card->blockSize();
 	if (this->size() > card->totalUserBlocks()) {
@@ -101,11 +101,8 @@ QByteArray FilePrivate::loadFileData(void)
 	// FIXME: Optimize blockSize multiplication by using shifts.
 	fileData.resize(this->size() * blockSize);
 
-	uint8_t *fileDataPtr = (uint8_t*)fileData.data();
-	for (int i = 0; i < this->size(); i++, fileDataPtr += blockSize) {
-		const uint16_t physBlockAddr = fileBlockAddrToPhysBlockAddr(i);
-		card->readBlock(fileDataPtr, blockSize, physBlockAddr);
-	}
+	// NOTE: Contiguous blocks are read using a single read.
+	card->readBlocks(fileData.data(), fileData.size(), fatEntries);
 	return fileData;
 }
 
@@ -137,11 +134,9 @@ QByteArray FilePrivate::readBlocks(uint16_t blockStart, int len)
 	QByteArray blockData;
 	blockData.resize(len * blockSize);
 
-	uint8_t *blockDataPtr = (uint8_t*)blockData.data();
-	for (int i = 0; i < len; i++, blockDataPtr += blockSize) {
-		const uint16_t physBlockAddr = fileBlockAddrToPhysBlockAddr(i);
-		card->readBlock(blockDataPtr, blockSize, physBlockAddr);
-	}
+	// NOTE: Contiguous blocks are read using a single read.
+	card->readBlocks(blockData.data(), blockData.size(),
+		fatEntries.constData() + blockStart, len);
 	return blockData;
 }
 
@@ -240,41 +235,106 @@ QString FilePrivate::decodeText_SJISorCP1252(const char *str, int len)
 /** Images **/
 
 /**
- * Load the banner and icon images.
+ * Prepare the banner and icon images.
+ * The raw image data is loaded, but the images
+ * aren't decoded until they're requested.
  * TODO: Move to File?
  */
 void FilePrivate::loadImages(void)
 {
-	// Load the banner.
-	this->gcBanner = loadBannerImage();
-	if (gcBanner) {
-		// Set the new banner image.
-		QImage qBanner = gcImageToQImage(gcBanner);
-		if (!qBanner.isNull())
-			banner = QPixmap::fromImage(qBanner);
-		else
-			banner = QPixmap();
-	} else {
-		// No banner image.
-		banner = QPixmap();
+	// Delete any previously-decoded images.
+	delete lazyBanner.gcImage;
+	lazyBanner = LazyImage();
+	foreach (const LazyImage &lazyIcon, lazyIcons) {
+		delete lazyIcon.gcImage;
+	}
+	lazyIcons.clear();
+
+	// Load the raw image data.
+	const int iconCount = loadImageData();
+	if (iconCount > 0) {
+		lazyIcons.resize(iconCount);
+	}
+}
+
+/**
+ * Get the banner image.
+ * The banner is decoded on first use.
+ * @return Banner image, or nullptr if there is no banner.
+ */
+const GcImage *FilePrivate::bannerImage(void) const
+{
+	QMutexLocker locker(&imgMutex);
+	if (!lazyBanner.gcImageLoaded) {
+		lazyBanner.gcImage = loadBannerImage();
+		lazyBanner.gcImageLoaded = true;
 	}
+	return lazyBanner.gcImage;
+}
 
-	// Load the icons.
-	this->gcIcons = loadIconImages();
-	icons.clear();
-	icons.reserve(gcIcons.size());
-	foreach (GcImage *gcIcon, gcIcons) {
+/**
+ * Get an icon image.
+ * The icon is decoded on first use.
+ * @param idx Icon number.
+ * @return Icon image, or nullptr if there is no icon.
+ */
+const GcImage *FilePrivate::iconImage(int idx) const
+{
+	if (idx < 0 || idx >= lazyIcons.size())
+		return nullptr;
+
+	QMutexLocker locker(&imgMutex);
+	LazyImage &lazyIcon = lazyIcons[idx];
+	if (!lazyIcon.gcImageLoaded) {
+		lazyIcon.gcImage = loadIconImage(idx);
+		lazyIcon.gcImageLoaded = true;
+	}
+	return lazyIcon.gcImage;
+}
+
+/**
+ * Get the banner image as a QPixmap.
+ * The banner is converted on first use.
+ * NOTE: Must be called from the GUI thread.
+ * @return Banner image, or null QPixmap if there is no banner.
+ */
+QPixmap FilePrivate::bannerPixmap(void) const
+{
+	if (!lazyBanner.pixmapLoaded) {
+		const GcImage *const gcBanner = bannerImage();
+		if (gcBanner) {
+			QImage qBanner = gcImageToQImage(gcBanner);
+			if (!qBanner.isNull())
+				lazyBanner.pixmap = QPixmap::fromImage(qBanner);
+		}
+		lazyBanner.pixmapLoaded = true;
+	}
+	return lazyBanner.pixmap;
+}
+
+/**
+ * Get an icon image as a QPixmap.
+ * The icon is converted on first use.
+ * NOTE: Must be called from the GUI thread.
+ * @param idx Icon number.
+ * @return Icon image, or null QPixmap if there is no icon.
+ */
+QPixmap FilePrivate::iconPixmap(int idx) const
+{
+	if (idx < 0 || idx >= lazyIcons.size())
+		return QPixmap();
+
+	LazyImage &lazyIcon = lazyIcons[idx];
+	if (!lazyIcon.pixmapLoaded) {
+		const GcImage *const gcIcon = iconImage(idx);
 		if (gcIcon) {
 			QImage qIcon = gcImageToQImage(gcIcon);
 			if (!qIcon.isNull())
-				icons.append(QPixmap::fromImage(qIcon));
-			else
-				icons.append(QPixmap());
-		} else {
-			// No icon image.
-			icons.append(QPixmap());
+				lazyIcon.pixmap = QPixmap::fromImage(qIcon);
 		}
+		lazyIcon.pixmapLoaded = true;
 	}
+	return lazyIcon.pixmap;
 }
 
 /** Checksums **/
@@ -284,16 +344,28 @@ void FilePrivate::loadImages(void)
  */
 void FilePrivate::calculateChecksum(void)
 {
-	checksumValues.clear();
-
 	if (checksumDefs.empty()) {
 		// No checksum definitions were set.
+		checksumValues.clear();
 		return;
 	}
 
 	// Load the file data.
-	QByteArray fileData = loadFileData();
-	if (fileData.isEmpty()) {
+	calculateChecksum(loadFileData());
+}
+
+/**
+ * Calculate the file checksum.
+ * @param fileData File data.
+ */
+void FilePrivate::calculateChecksum(QByteArray fileData)
+{
+	checksumValues.clear();
+
+	if (checksumDefs.empty()) {
+		// No checksum definitions were set.
+		return;
+	} else if (fileData.isEmpty()) {
 		// File is empty.
 		return;
 	}
@@ -301,6 +373,17 @@ void FilePrivate::calculateChecksum(void)
 	// Pointer to fileData's internal data array.
 	uint8_t *data = reinterpret_cast<uint8_t*>(fileData.data());
 
+	// Some algorithms calculate several checksums in a single pass,
+	// e.g. Pokémon XD. Cache their results so each data area is only
+	// processed once, regardless of how many ChecksumDefs use it.
+	struct MultiChecksum {
+		Checksum::ChkAlgorithm algorithm;
+		uint32_t start;
+		uint32_t length;
+		QVector<Checksum::ChecksumValue> values;
+	};
+	QVector<MultiChecksum> multiChecksums;
+
 	// Process all of the checksum definitions.
 	for (int i = 0; i < (int)checksumDefs.size(); i++) {
 		const Checksum::ChecksumDef &checksumDef = checksumDefs.at(i);
@@ -323,18 +406,46 @@ void FilePrivate::calculateChecksum(void)
 			continue;
 		}
 
+		const char *const start = (fileData.constData() + checksumDef.start);
+
+		const int multiIdx = Checksum::MultiIndex(checksumDef.algorithm, checksumDef.address);
+		if (multiIdx >= 0) {
+			// Multi-checksum algorithm.
+			// Check if this data area was already processed.
+			const MultiChecksum *pMulti = nullptr;
+			for (int j = 0; j < multiChecksums.size(); j++) {
+				const MultiChecksum &multi = multiChecksums.at(j);
+				if (multi.algorithm == checksumDef.algorithm &&
+				    multi.start == checksumDef.start &&
+				    multi.length == checksumDef.length)
+				{
+					pMulti = &multi;
+					break;
+				}
+			}
+
+			if (!pMulti) {
+				// Calculate all of the checksums for this data area.
+				MultiChecksum multi;
+				multi.algorithm = checksumDef.algorithm;
+				multi.start = checksumDef.start;
+				multi.length = checksumDef.length;
+				multi.values.resize(Checksum::MultiCount(checksumDef.algorithm));
+				Checksum::ExecMulti(checksumDef.algorithm, start,
+					checksumDef.length, multi.values.data());
+				multiChecksums.append(multi);
+				pMulti = &multiChecksums.at(multiChecksums.size() - 1);
+			}
+
+			checksumValues.push_back(pMulti->values.value(multiIdx));
+			continue;
+		}
+
 		// Get the expected checksum.
 		// NOTE: Assuming big-endian for all values.
 		uint32_t expected = 0;
 		Checksum::ChaoGardenChecksumData chaoChk_orig;
 
-		// Use Exec() for most algorithms.
-		// Some unusual ones need to be run manually.
-		bool useExec = true;
-
-		const char *const start = (fileData.constData() + checksumDef.start);
-		uint32_t actual = 0;
-
 		switch (checksumDef.algorithm) {
 			case Checksum::CHKALG_CRC16:
 			case Checksum::CHKALG_DREAMCASTVMU:
@@ -397,13 +508,6 @@ void FilePrivate::calculateChecksum(void)
 				break;
 			}
 
-			case Checksum::CHKALG_POKEMONXD:
-				// Pokémon XD has a more complicated checksum.
-				useExec = false;
-				actual = Checksum::PokemonXD(reinterpret_cast<const uint8_t*>(start),
-					checksumDef.length, checksumDef.address, &expected);
-				break;
-
 			case Checksum::CHKALG_NONE:
 			default:
 				// Unsupported algorithm.
@@ -411,11 +515,8 @@ void FilePrivate::calculateChecksum(void)
 				break;
 		}
 
-		if (useExec) {
-			// Use Checksum::Exec().
-			actual = Checksum::Exec(checksumDef.algorithm,
-				start, checksumDef.length, checksumDef.endian, checksumDef.param);
-		}
+		// Calculate the actual checksum.
+		const uint32_t actual = Checksum::Exec(checksumDef, start, checksumDef.length);
 
 		if (checksumDef.algorithm == Checksum::CHKALG_SONICCHAOGARDEN) {
 			// Restore the Chao Garden checksum data.
@@ -542,9 +643,15 @@ int File::write(uint32_t address, const void *const data, uint32_t length)
 	}
 
 	// Write entire blocks.
-	for (; length >= (uint32_t)blockSize; length -= blockSize, data_u8 += blockSize, address += blockSize) {
-		const uint16_t physBlockIdx = d->fileBlockAddrToPhysBlockAddr(address / blockSize);
-		d->card->writeBlock(data, blockSize, physBlockIdx);
+	// NOTE: Contiguous blocks are written using a single write.
+	const int fullBlocks = (int)(length / blockSize);
+	if (fullBlocks > 0) {
+		const uint32_t fullLength = ((uint32_t)fullBlocks * blockSize);
+		d->card->writeBlocks(data_u8, (int)fullLength,
+			d->fatEntries.constData() + (address / blockSize), fullBlocks);
+		length -= fullLength;
+		data_u8 += fullLength;
+		address += fullLength;
 	}
 
 	// Check if we still have data left (not a full block).
@@ -628,7 +735,7 @@ int File::size(void) const
 QPixmap File::banner(void) const
 {
 	Q_D(const File);
-	return d->banner;
+	return d->bannerPixmap();
 }
 
 /**
@@ -638,7 +745,7 @@ QPixmap File::banner(void) const
 int File::iconCount(void) const
 {
 	Q_D(const File);
-	return d->icons.size();
+	return d->lazyIcons.size();
 }
 
 /**
@@ -649,9 +756,7 @@ int File::iconCount(void) const
 QPixmap File::icon(int idx) const
 {
 	Q_D(const File);
-	if (idx < 0 || idx >= d->icons.size())
-		return QPixmap();
-	return d->icons.at(idx);
+	return d->iconPixmap(idx);
 }
 
 /**
@@ -733,7 +838,7 @@ int File::saveBanner(const QString &filenameNoExt) const
 	Q_D(const File);
 	// TODO: Make GcImageWriter more generic and move the
 	// internal image data here.
-	if (d->banner.isNull())
+	if (!d->bannerImage())
 		return -EINVAL;
 
 	// Append the correct extension.
@@ -770,11 +875,12 @@ int File::saveBanner(const QString &filenameNoExt) const
 int File::saveBanner(QIODevice *qioDevice) const
 {
 	Q_D(const File);
-	if (!d->gcBanner)
+	const GcImage *const gcBanner = d->bannerImage();
+	if (!gcBanner)
 		return -EINVAL;
 
 	GcImageWriter gcImageWriter;
-	int ret = gcImageWriter.write(d->gcBanner, GcImageWriter::IMGF_PNG);
+	int ret = gcImageWriter.write(gcBanner, GcImageWriter::IMGF_PNG);
 	if (!ret) {
 		const vector<uint8_t> *pngData = gcImageWriter.memBuffer();
 		ret = qioDevice->write(reinterpret_cast<const char*>(pngData->data()), pngData->size());
@@ -797,60 +903,11 @@ int File::saveBanner(QIODevice *qioDevice) const
 int File::saveIcon(const QString &filenameNoExt,
 	GcImageWriter::AnimImageFormat animImgf) const
 {
-	Q_D(const File);
-	if (d->gcIcons.isEmpty())
-		return -EINVAL;
-
-	// Append the correct extension.
-	const char *ext;
-	if (d->gcIcons.size() > 1) {
-		// Animated icon.
-		ext = GcImageWriter::extForAnimImageFormat(animImgf);
-	} else {
-		// Static icon.
-		ext = GcImageWriter::extForImageFormat(GcImageWriter::IMGF_PNG);
-	}
-
 	// NOTE: Due to PNG_FPF saving multiple files, we can't simply
 	// call a version of saveIcon() that takes a QIODevice.
 	GcImageWriter gcImageWriter;
-	int ret;
-	if (d->gcIcons.size() > 1) {
-		// Animated icon.
-		vector<const GcImage*> gcImages;
-		const int maxIcons = (d->gcIcons.size() * 2 - 2);
-		gcImages.reserve(maxIcons);
-		gcImages.resize(d->gcIcons.size());
-		for (int i = 0; i < d->gcIcons.size(); i++) {
-			gcImages[i] = d->gcIcons[i];
-		}
-
-		// Icon speed.
-		vector<int> gcIconDelays;
-		gcIconDelays.reserve(maxIcons);
-		gcIconDelays.resize(d->gcIcons.size());
-		for (int i = 0; i < d->gcIcons.size(); i++) {
-			gcIconDelays[i] = iconDelay(i);
-		}
-
-		if (gcImages.size() > 1 && iconAnimMode() == CARD_ANIM_BOUNCE) {
-			// BOUNCE animation.
-			int src = (gcImages.size() - 2);
-			int dest = gcImages.size();
-			gcImages.resize(maxIcons);
-			gcIconDelays.resize(maxIcons);
-			for (; src >= 1; src--, dest++) {
-				gcImages[dest] = gcImages[src];
-				gcIconDelays[dest] = gcIconDelays[src];
-			}
-		}
-
-		ret = gcImageWriter.write(&gcImages, &gcIconDelays, animImgf);
-	} else {
-		// Static icon.
-		ret = gcImageWriter.write(d->gcIcons.at(0), GcImageWriter::IMGF_PNG);
-	}
-
+	const char *ext;
+	int ret = encodeIcon(&gcImageWriter, animImgf, &ext);
 	if (ret != 0) {
 		// Error writing the icon.
 		return ret;
@@ -896,6 +953,75 @@ int File::saveIcon(const QString &filenameNoExt,
 	return ret;
 }
 
+/**
+ * Encode the icon in memory.
+ * The encoded files can be retrieved using
+ * gcImageWriter->numFiles() and gcImageWriter->memBuffer().
+ * @param gcImageWriter	[out] GcImageWriter to encode the icon with.
+ * @param animImgf	[in] Animated image format for animated icons.
+ * @param pExt		[out,opt] File extension for the encoded icon.
+ * @return 0 on success; non-zero on error.
+ */
+int File::encodeIcon(GcImageWriter *gcImageWriter,
+	GcImageWriter::AnimImageFormat animImgf,
+	const char **pExt) const
+{
+	Q_D(const File);
+	const int iconCount = d->lazyIcons.size();
+	if (iconCount <= 0)
+		return -EINVAL;
+
+	// Get the correct extension.
+	if (pExt) {
+		if (iconCount > 1) {
+			// Animated icon.
+			*pExt = GcImageWriter::extForAnimImageFormat(animImgf);
+		} else {
+			// Static icon.
+			*pExt = GcImageWriter::extForImageFormat(GcImageWriter::IMGF_PNG);
+		}
+	}
+
+	int ret;
+	if (iconCount > 1) {
+		// Animated icon.
+		vector<const GcImage*> gcImages;
+		const int maxIcons = (iconCount * 2 - 2);
+		gcImages.reserve(maxIcons);
+		gcImages.resize(iconCount);
+		for (int i = 0; i < iconCount; i++) {
+			gcImages[i] = d->iconImage(i);
+		}
+
+		// Icon speed.
+		vector<int> gcIconDelays;
+		gcIconDelays.reserve(maxIcons);
+		gcIconDelays.resize(iconCount);
+		for (int i = 0; i < iconCount; i++) {
+			gcIconDelays[i] = iconDelay(i);
+		}
+
+		if (gcImages.size() > 1 && iconAnimMode() == CARD_ANIM_BOUNCE) {
+			// BOUNCE animation.
+			int src = (gcImages.size() - 2);
+			int dest = gcImages.size();
+			gcImages.resize(maxIcons);
+			gcIconDelays.resize(maxIcons);
+			for (; src >= 1; src--, dest++) {
+				gcImages[dest] = gcImages[src];
+				gcIconDelays[dest] = gcIconDelays[src];
+			}
+		}
+
+		ret = gcImageWriter->write(&gcImages, &gcIconDelays, animImgf);
+	} else {
+		// Static icon.
+		ret = gcImageWriter->write(d->iconImage(0), GcImageWriter::IMGF_PNG);
+	}
+
+	return ret;
+}
+
 /** Checksum **/
 
 /**
@@ -919,6 +1045,25 @@ void File::setChecksumDefs(const QVector<Checksum::ChecksumDef> &checksumDefs)
 	d->calculateChecksum();
 }
 
+/**
+ * Set the checksum definitions.
+ * This version uses file data that was already loaded
+ * by the caller, so the Card isn't accessed.
+ *
+ * NOTE: This can be called from a worker thread, as long
+ * as no other thread is accessing this File.
+ *
+ * @param checksumDefs Checksum definitions.
+ * @param fileData File data.
+ */
+void File::setChecksumDefs(const QVector<Checksum::ChecksumDef> &checksumDefs,
+			   const QByteArray &fileData)
+{
+	Q_D(File);
+	d->checksumDefs = checksumDefs;
+	d->calculateChecksum(fileData);
+}
+
 /**
  * Get the checksum values.
  * @return Checksum values, or empty QVector if no checksum definitions were set.
@@ -974,12 +1119,14 @@ QVector<QString> File::checksumValuesFormatted(void) const
 
 /**
  * Is this file read-only?
- * This is true if either the underlying card is read-only,
+ * This is true if either the underlying card is read-only
+ * and doesn't have the copy-on-write overlay enabled,
  * or this is a lost file.
  * @return True if this file is read-only; false if not.
  */
 bool File::isReadOnly(void) const
 {
 	Q_D(const File);
-	return (d->lostFile || d->card->isReadOnly());
+	return (d->lostFile ||
+		(d->card->isReadOnly() && !d->card->isOverlayEnabled()));
 }
@@ -277,6 +277,19 @@ class File : public QObject
 		int saveIcon(const QString &filenameNoExt,
 			     GcImageWriter::AnimImageFormat animImgf) const;
 
+		/**
+		 * Encode the icon in memory.
+		 * The encoded files can be retrieved using
+		 * gcImageWriter->numFiles() and gcImageWriter->memBuffer().
+		 * @param gcImageWriter	[out] GcImageWriter to encode the icon with.
+		 * @param animImgf	[in] Animated image format for animated icons.
+		 * @param pExt		[out,opt] File extension for the encoded icon.
+		 * @return 0 on success; non-zero on error.
+		 */
+		int encodeIcon(GcImageWriter *gcImageWriter,
+			       GcImageWriter::AnimImageFormat animImgf,
+			       const char **pExt = nullptr) const;
+
 	public:
 		/** Checksums **/
 
@@ -292,6 +305,20 @@ class File : public QObject
 		 */
 		void setChecksumDefs(const QVector<Checksum::ChecksumDef> &checksumDefs);
 
+		/**
+		 * Set the checksum definitions.
+		 * This version uses file data that was already loaded
+		 * by the caller, so the Card isn't accessed.
+		 *
+		 * NOTE: This can be called from a worker thread, as long
+		 * as no other thread is accessing this File.
+		 *
+		 * @param checksumDefs Checksum definitions.
+		 * @param fileData File data.
+		 */
+		void setChecksumDefs(const QVector<Checksum::ChecksumDef> &checksumDefs,
+				     const QByteArray &fileData);
+
 		/**
 		 * Get the checksum values.
 		 * @return Checksum values, or empty QVector if no checksum definitions were set.
@@ -330,7 +357,8 @@ class File : public QObject
 	public:
 		/**
 		 * Is this file read-only?
-		 * This is true if either the underlying card is read-only,
+		 * This is true if either the underlying card is read-only
+		 * and doesn't have the copy-on-write overlay enabled,
 		 * or this is a lost file.
 		 * @return True if this file is read-only; false if not.
 		 */
@@ -18,6 +18,9 @@ class GcImage;
 // C includes.
 #include <stdint.h>
 
+// Qt includes.
+#include <QtCore/QMutex>
+
 class FilePrivate
 {
 	public:
@@ -51,17 +54,39 @@ class FilePrivate
 		uint32_t mode;		// Mode. (attributes, permissions)
 		// Size is calculated using fatEntries.size().
 
-		// GcImages. (internal use only)
-		GcImage *gcBanner;
-		QVector<GcImage*> gcIcons;
 		// FIXME: Use system-independent values.
 		// Currently uses GCN values.
 		QVector<uint8_t> iconSpeed;
 		uint8_t iconAnimMode;
 
-		// QPixmap images.
-		QPixmap banner;
-		QVector<QPixmap> icons;
+		// Raw image data.
+		// Cached by loadImageData() so the banner and
+		// icons can be decoded later without more I/O.
+		QByteArray imgData;
+
+		/**
+		 * Banner or icon image, decoded on demand.
+		 * Use bannerImage(), iconImage(), bannerPixmap(),
+		 * and iconPixmap() to access these.
+		 */
+		struct LazyImage {
+			GcImage *gcImage;
+			QPixmap pixmap;
+			bool gcImageLoaded;
+			bool pixmapLoaded;
+
+			LazyImage()
+				: gcImage(nullptr)
+				, gcImageLoaded(false)
+				, pixmapLoaded(false)
+			{ }
+		};
+		mutable LazyImage lazyBanner;
+		mutable QVector<LazyImage> lazyIcons;
+
+		// Serializes GcImage decoding, since exporters
+		// may request images from other threads.
+		mutable QMutex imgMutex;
 
 		// Lost File information.
 		bool lostFile;
@@ -113,21 +138,64 @@ class FilePrivate
 		/** Images **/
 
 		/**
-		 * Load the banner and icon images.
+		 * Prepare the banner and icon images.
+		 * The raw image data is loaded, but the images
+		 * aren't decoded until they're requested.
 		 */
 		void loadImages(void);
 
 		/**
-		 * Load the banner image.
+		 * Load the raw image data and icon animation information.
+		 * The raw image data should be stored in imgData.
+		 * iconSpeed and iconAnimMode must be set here.
+		 * @return Number of icons.
+		 */
+		virtual int loadImageData(void) = 0;
+
+		/**
+		 * Decode the banner image from imgData.
 		 * @return GcImage containing the banner image, or nullptr on error.
 		 */
-		virtual GcImage *loadBannerImage(void) = 0;
+		virtual GcImage *loadBannerImage(void) const = 0;
+
+		/**
+		 * Decode an icon image from imgData.
+		 * @param idx Icon number.
+		 * @return GcImage containing the icon image, or nullptr on error.
+		 */
+		virtual GcImage *loadIconImage(int idx) const = 0;
 
 		/**
-		 * Load the icon images.
-		 * @return QVector<GcImage*> containing the icon images, or empty QVector on error.
+		 * Get the banner image.
+		 * The banner is decoded on first use.
+		 * @return Banner image, or nullptr if there is no banner.
 		 */
-		virtual QVector<GcImage*> loadIconImages(void) = 0;
+		const GcImage *bannerImage(void) const;
+
+		/**
+		 * Get an icon image.
+		 * The icon is decoded on first use.
+		 * @param idx Icon number.
+		 * @return Icon image, or nullptr if there is no icon.
+		 */
+		const GcImage *iconImage(int idx) const;
+
+		/**
+		 * Get the banner image as a QPixmap.
+		 * The banner is converted on first use.
+		 * NOTE: Must be called from the GUI thread.
+		 * @return Banner image, or null QPixmap if there is no banner.
+		 */
+		QPixmap bannerPixmap(void) const;
+
+		/**
+		 * Get an icon image as a QPixmap.
+		 * The icon is converted on first use.
+		 * NOTE: Must be called from the GUI thread.
+		 * @param idx Icon number.
+		 * @return Icon image, or null QPixmap if there is no icon.
+		 */
+		QPixmap iconPixmap(int idx) const;
 
 		/** Checksums **/
 
@@ -139,6 +207,12 @@ class FilePrivate
 		 * Calculate the file checksum.
 		 */
 		void calculateChecksum(void);
+
+		/**
+		 * Calculate the file checksum.
+		 * @param fileData File data.
+		 */
+		void calculateChecksum(QByteArray fileData);
 };
 
 #endif /* __LIBMEMCARD_FILE_P_HPP__ */
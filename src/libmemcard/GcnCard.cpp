@@ -860,6 +860,9 @@ void GcnCard::setActiveDatIdx(int idx)
 		return;
 	const int old_idx = d->dat_info.active;
 	d->mc_dat = &d->mc_dat_int[idx];
+	// The file list is reloaded from the new table,
+	// so don't keep blocks cached for the old one.
+	d->clearBlockCache();
 	d->loadGcnFileList();
 	if (old_idx != idx) {
 		emit activeDatIdxChanged(idx);
@@ -880,6 +883,9 @@ void GcnCard::setActiveBatIdx(int idx)
 		return;
 	const int old_idx = d->dat_info.active;
 	d->mc_bat = &d->mc_bat_int[idx];
+	// The file list is reloaded from the new table,
+	// so don't keep blocks cached for the old one.
+	d->clearBlockCache();
 	d->loadGcnFileList();
 	if (old_idx != idx) {
 		emit activeBatIdxChanged(idx);
@@ -1007,6 +1013,48 @@ QList<GcnFile*> GcnCard::addLostFiles(const std::list<GcnSearchData> &filesFound
 	return files;
 }
 
+/**
+ * Add "lost" files in front of the "lost" files that are already on the card.
+ *
+ * This is used for batches from a streaming search.
+ * The search starts at the last block, so each batch
+ * belongs in front of the previous batches in order
+ * to match the order used by addLostFiles().
+ *
+ * @param filesFound Files found, sorted by block number.
+ * @return List of GcnFiles added to the GcnCard, or empty list on error.
+ */
+QList<GcnFile*> GcnCard::prependLostFiles(const QVector<GcnSearchData> &filesFound)
+{
+	QList<GcnFile*> files;
+	if (!isOpen())
+		return files;
+	if (filesFound.isEmpty())
+		return files;
+
+	// "Lost" files are always after the regular files.
+	// Find the first "lost" file.
+	Q_D(GcnCard);
+	int idx = d->lstFiles.size();
+	while (idx > 0 && d->lstFiles.at(idx - 1)->isLostFile()) {
+		idx--;
+	}
+
+	const int idxLast = idx + filesFound.size() - 1;
+	emit filesAboutToBeInserted(idx, idxLast);
+
+	files.reserve(filesFound.size());
+	foreach (const GcnSearchData &searchData, filesFound) {
+		GcnFile *file = new GcnFile(this, &searchData.dirEntry, searchData.fatEntries);
+		file->setChecksumDefs(searchData.checksumDefs);
+		files.append(file);
+		d->lstFiles.insert(idx++, file);
+	}
+
+	emit filesInserted();
+	return files;
+}
+
 /**
  * Get the header checksum value.
  * NOTE: Header checksum is always AddInvDual16.
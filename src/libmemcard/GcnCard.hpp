@@ -114,6 +114,19 @@ class GcnCard : public Card
 		 */
 		QList<GcnFile*> addLostFiles(const std::list<GcnSearchData> &filesFoundList);
 
+		/**
+		 * Add "lost" files in front of the "lost" files that are already on the card.
+		 *
+		 * This is used for batches from a streaming search.
+		 * The search starts at the last block, so each batch
+		 * belongs in front of the previous batches in order
+		 * to match the order used by addLostFiles().
+		 *
+		 * @param filesFound Files found, sorted by block number.
+		 * @return List of GcnFiles added to the GcnCard, or empty list on error.
+		 */
+		QList<GcnFile*> prependLostFiles(const QVector<GcnSearchData> &filesFound);
+
 		/**
 		 * Get the header checksum value.
 		 * NOTE: Header checksum is always AddInvDual16.
@@ -14,6 +14,7 @@
 #include "GcnCard.hpp"
 #include "GcImage.hpp"
 #include "GcImageLoader.hpp"
+#include "GcPalette.hpp"
 #include "TimeFuncs.hpp"
 
 // C includes. (C++ namespace)
@@ -107,17 +108,40 @@ class GcnFilePrivate : public FilePrivate
 		QString gameDesc;
 		QString fileDesc;
 
+		// Image addresses in imgData.
+		uint32_t bannerAddr;
+		uint32_t sharedPaletteAddr;	// CI8 palette for CARD_ICON_CI_SHARED.
+
+		// Decoded CARD_ICON_CI_SHARED palette.
+		// Decoded on first use and shared by all CI_SHARED frames.
+		// NOTE: Protected by imgMutex.
+		mutable GcPalette *sharedPalette;
+
+		// Icon frames.
+		struct IconFrame {
+			uint8_t fmt;	// Icon format. (CARD_ICON_NONE if missing)
+			uint32_t addr;	// Icon address in imgData.
+		};
+		QVector<IconFrame> iconFrames;
+
 		/**
-		 * Load the banner image.
+		 * Load the raw image data and icon animation information.
+		 * @return Number of icons.
+		 */
+		int loadImageData(void) final;
+
+		/**
+		 * Decode the banner image from imgData.
 		 * @return GcImage containing the banner image, or nullptr on error.
 		 */
-		GcImage *loadBannerImage(void) final;
+		GcImage *loadBannerImage(void) const final;
 
 		/**
-		 * Load the icon images.
-		 * @return QVector<GcImage*> containing the icon images, or empty QVector on error.
+		 * Decode an icon image from imgData.
+		 * @param idx Icon number.
+		 * @return GcImage containing the icon image, or nullptr on error.
 		 */
-		QVector<GcImage*> loadIconImages(void) final;
+		GcImage *loadIconImage(int idx) const final;
 };
 
 /**
@@ -134,6 +158,9 @@ GcnFilePrivate::GcnFilePrivate(GcnFile *q, Card *card,
 	: super(q, card)
 	, mc_bat(mc_bat)
 	, dirEntry(dirEntry)
+	, bannerAddr(0)
+	, sharedPaletteAddr(0)
+	, sharedPalette(nullptr)
 {
 	if (!dirEntry || !mc_bat) {
 		// Invalid data.
@@ -191,6 +218,9 @@ GcnFilePrivate::GcnFilePrivate(GcnFile *q, Card *card,
 	: super(q, card)
 	, mc_bat(nullptr)
 	, dirEntry(dirEntry)
+	, bannerAddr(0)
+	, sharedPaletteAddr(0)
+	, sharedPalette(nullptr)
 {
 	if (!dirEntry) {
 		// Invalid data.
@@ -235,6 +265,10 @@ GcnFilePrivate::GcnFilePrivate(GcnFile *q, Card *card,
 
 GcnFilePrivate::~GcnFilePrivate()
 {
+	if (sharedPalette) {
+		sharedPalette->unref();
+	}
+
 	if (lostFile) {
 		// dirEntry was allocated by us.
 		// Free it.
@@ -336,12 +370,19 @@ void GcnFilePrivate::loadFileInfo(void)
 	const int commentBlock = (dirEntry->commentaddr / blockSize);
 	const int commentOffset = (dirEntry->commentaddr % blockSize);
 
-	unique_ptr<char[]> commentData(new char[blockSize]);
-	int ret = card->readBlock(commentData.get(), blockSize, fileBlockAddrToPhysBlockAddr(commentBlock));
-	if (ret != blockSize) {
-		// Read error.
-		// File is probably invalid.
-		return;
+	// If the card is memory-mapped, read the comments in place.
+	const uint16_t commentPhysBlock = fileBlockAddrToPhysBlockAddr(commentBlock);
+	unique_ptr<char[]> commentBuf;
+	const char *commentData = reinterpret_cast<const char*>(card->blockPtr(commentPhysBlock));
+	if (!commentData) {
+		commentBuf.reset(new char[blockSize]);
+		int ret = card->readBlock(commentBuf.get(), blockSize, commentPhysBlock);
+		if (ret != blockSize) {
+			// Read error.
+			// File is probably invalid.
+			return;
+		}
+		commentData = commentBuf.get();
 	}
 
 	// Load the file comments. (64 bytes)
@@ -376,221 +417,246 @@ void GcnFilePrivate::loadFileInfo(void)
 	// pointing to description.
 	description = gameDesc + QChar(L'\0') + fileDesc;
 
-	// Load the banner and icon images.
+	// Prepare the banner and icon images.
+	// They're decoded on demand.
 	loadImages();
 }
 
 /**
- * Load the banner image.
- * @return GcImage* containing the banner image, or nullptr on error.
+ * Load the raw image data and icon animation information.
+ * The banner and all icons are stored contiguously,
+ * starting at dirEntry->iconaddr.
+ * @return Number of icons.
  */
-GcImage *GcnFilePrivate::loadBannerImage(void)
+int GcnFilePrivate::loadImageData(void)
 {
-	// Determine the banner length.
-	uint32_t imgSize = 0;
-	switch (dirEntry->bannerfmt & CARD_BANNER_MASK) {
-		case CARD_BANNER_CI:
-			imgSize = (CARD_BANNER_W * CARD_BANNER_H * 1);
-			break;
-		case CARD_BANNER_RGB:
-			imgSize = (CARD_BANNER_W * CARD_BANNER_H * 2);
-			break;
-		default:
-			// No banner.
-			return nullptr;
-	}
-
-	// Load the banner.
-	uint32_t imgAddr = dirEntry->iconaddr;
-	const int blockSize = card->blockSize();
-	const uint16_t blockStart = (imgAddr / blockSize);
-	QByteArray imgData = readBlocks(blockStart, 1);
-	if (imgData.size() != blockSize)
-		return nullptr;
-	imgAddr &= 0x1FFF;
-
-	GcImage *gcBannerImg = nullptr;
-	switch (dirEntry->bannerfmt & CARD_BANNER_MASK) {
-		case CARD_BANNER_CI:
-			// CI8 palette is right after the banner.
-			// (256 entries in RGB5A3 format.)
-			gcBannerImg = GcImageLoader::fromCI8(CARD_BANNER_W, CARD_BANNER_H,
-					(const uint8_t*)&imgData.constData()[imgAddr], imgSize,
-					(const uint16_t*)&imgData.constData()[imgAddr + imgSize], 0x200);
-			break;
-
-		case CARD_BANNER_RGB:
-			gcBannerImg = GcImageLoader::fromRGB5A3(CARD_BANNER_W, CARD_BANNER_H,
-					(const uint16_t*)&imgData.constData()[imgAddr], imgSize);
-			break;
-
-		default:
-			break;
+	imgData.clear();
+	iconFrames.clear();
+	bannerAddr = 0;
+	sharedPaletteAddr = 0;
+	if (sharedPalette) {
+		sharedPalette->unref();
+		sharedPalette = nullptr;
 	}
 
-	return gcBannerImg;
-}
-
-/**
- * Load the icon images.
- * @return QVector<GcImage*> containing the icon images, or empty QVector on error.
- */
-QVector<GcImage*> GcnFilePrivate::loadIconImages(void)
-{
 	// TODO: Convert these to system-independent values.
 	// Icon animation metadata.
-	// TODO: Should be part of a struct that's returned...
 	this->iconAnimMode = (dirEntry->bannerfmt & CARD_ANIM_MASK);
+	this->iconSpeed.clear();
 
-	// Calculate the first icon address.
-	uint32_t imgAddr = dirEntry->iconaddr;
+	// Determine the banner length.
+	uint32_t bannerLen = 0;
 	switch (dirEntry->bannerfmt & CARD_BANNER_MASK) {
 		case CARD_BANNER_CI:
-			imgAddr += (CARD_BANNER_W * CARD_BANNER_H * 1);
-			imgAddr += 0x200; // palette
+			bannerLen = (CARD_BANNER_W * CARD_BANNER_H * 1);
+			bannerLen += 0x200; // palette
 			break;
 		case CARD_BANNER_RGB:
-			imgAddr += (CARD_BANNER_W * CARD_BANNER_H * 2);
+			bannerLen = (CARD_BANNER_W * CARD_BANNER_H * 2);
 			break;
 		default:
 			// No banner.
 			break;
 	}
 
-	// Calculate the icon sizes.
-	int iconSizes[8];
-	int iconLenTotal = 0;
+	// Determine the icon formats and addresses.
+	// Addresses are relative to the start of the banner for now.
+	uint32_t imgAddr = bannerLen;
 	bool isShared = false;
 	uint16_t iconfmt = dirEntry->iconfmt;
 	uint16_t iconspeed = dirEntry->iconspeed;
 	for (int i = 0; i < CARD_MAXICONS; i++, iconfmt >>= 2, iconspeed >>= 2) {
 		if ((iconspeed & CARD_SPEED_MASK) == CARD_SPEED_END)
 			break;
+		// TODO: Should be part of a struct that's returned...
+		this->iconSpeed.append(iconspeed & CARD_SPEED_MASK);
+
+		IconFrame frame;
+		frame.fmt = (iconfmt & CARD_ICON_MASK);
+		frame.addr = imgAddr;
+		iconFrames.append(frame);
 
-		switch (iconfmt & CARD_ICON_MASK) {
+		switch (frame.fmt) {
 			case CARD_ICON_CI_SHARED:
-				iconSizes[i] = (CARD_ICON_W * CARD_ICON_H * 1);
-				iconLenTotal += iconSizes[i];
+				// CI8 palette is after *all* the icons.
+				imgAddr += (CARD_ICON_W * CARD_ICON_H * 1);
 				isShared = true;
 				break;
 			case CARD_ICON_CI_UNIQUE:
-				iconSizes[i] = (CARD_ICON_W * CARD_ICON_H * 1);
-				iconLenTotal += iconSizes[i] + 0x200;
+				// CI8 palette is right after the icon.
+				imgAddr += (CARD_ICON_W * CARD_ICON_H * 1) + 0x200;
 				break;
-			case CARD_BANNER_RGB:
-				iconSizes[i] = (CARD_ICON_W * CARD_ICON_H * 2);
-				iconLenTotal += iconSizes[i];
+			case CARD_ICON_RGB:
+				imgAddr += (CARD_ICON_W * CARD_ICON_H * 2);
+				break;
+			default:
+				// No icon.
 				break;
 		}
 	}
 
+	sharedPaletteAddr = imgAddr;
+	uint32_t totalLen = imgAddr;
 	if (isShared) {
 		// CARD_ICON_CI_SHARED has a palette stored
 		// after all of the icons.
-		iconLenTotal += 0x200;
+		totalLen += 0x200;
 	}
 
-	// Load the icon data.
-	const int blockSize = card->blockSize();
-	const uint16_t blockStart = (imgAddr / blockSize);
-	const uint16_t blockEnd = ((imgAddr + iconLenTotal) / blockSize);
-	const int blockLen = ((blockEnd - blockStart) + 1);
-	QByteArray imgData = readBlocks(blockStart, blockLen);
-	if (imgData.size() != (blockLen * blockSize))
-		return QVector<GcImage*>();
-	imgAddr &= 0x1FFF;
-
-	// Info for icons using a shared CI8 palette.
-	struct CI8_SHARED_data {
-		int iconIdx;
-		uint32_t iconAddr;
-	};
-
-	// Decode the icon(s).
-	QVector<CI8_SHARED_data> lst_CI8_SHARED;
-	QVector<GcImage*> gcImages;
-	// TODO: Should be part of a struct that's returned...
-	this->iconSpeed.clear();
+	// Load the image data.
+	if (totalLen > 0) {
+		const int blockSize = card->blockSize();
+		const uint32_t blockStart = (dirEntry->iconaddr / blockSize);
+		const uint32_t blockEnd = ((dirEntry->iconaddr + totalLen - 1) / blockSize);
+		if (blockStart < (uint32_t)this->size() && blockEnd >= blockStart) {
+			imgData = readBlocks((uint16_t)blockStart, (int)(blockEnd - blockStart + 1));
+		}
 
-	iconfmt = dirEntry->iconfmt;
-	iconspeed = dirEntry->iconspeed;
-	for (int i = 0; i < CARD_MAXICONS; i++, iconfmt >>= 2, iconspeed >>= 2) {
-		if ((iconspeed & CARD_SPEED_MASK) == CARD_SPEED_END)
+		// Make the addresses relative to imgData.
+		const uint32_t imgBase = (dirEntry->iconaddr - (blockStart * blockSize));
+		bannerAddr = imgBase;
+		sharedPaletteAddr += imgBase;
+		for (int i = 0; i < iconFrames.size(); i++) {
+			iconFrames[i].addr += imgBase;
+		}
+	}
+
+	// Icons that aren't present in the image data can't be decoded.
+	// Trailing missing icons aren't counted.
+	const uint32_t imgDataSize = (uint32_t)imgData.size();
+	int iconCount = 0;
+	for (int i = 0; i < iconFrames.size(); i++) {
+		IconFrame &frame = iconFrames[i];
+		uint32_t frameEnd;
+		switch (frame.fmt) {
+			case CARD_ICON_CI_SHARED:
+				frameEnd = frame.addr + (CARD_ICON_W * CARD_ICON_H * 1);
+				if (sharedPaletteAddr + 0x200 > imgDataSize)
+					frameEnd = ~0U;
+				break;
+			case CARD_ICON_CI_UNIQUE:
+				frameEnd = frame.addr + (CARD_ICON_W * CARD_ICON_H * 1) + 0x200;
+				break;
+			case CARD_ICON_RGB:
+				frameEnd = frame.addr + (CARD_ICON_W * CARD_ICON_H * 2);
+				break;
+			default:
+				// No icon.
+				continue;
+		}
+
+		if (frameEnd > imgDataSize) {
+			// Icon data is missing.
+			frame.fmt = CARD_ICON_NONE;
+			continue;
+		}
+		iconCount = i + 1;
+	}
+
+	return iconCount;
+}
+
+/**
+ * Decode the banner image from imgData.
+ * @return GcImage* containing the banner image, or nullptr on error.
+ */
+GcImage *GcnFilePrivate::loadBannerImage(void) const
+{
+	// Determine the banner length.
+	uint32_t imgSize = 0;
+	switch (dirEntry->bannerfmt & CARD_BANNER_MASK) {
+		case CARD_BANNER_CI:
+			imgSize = (CARD_BANNER_W * CARD_BANNER_H * 1);
+			if ((uint32_t)imgData.size() < bannerAddr + imgSize + 0x200)
+				return nullptr;
 			break;
-		// TODO: Should be part of a struct that's returned...
-		this->iconSpeed.append(iconspeed & CARD_SPEED_MASK);
+		case CARD_BANNER_RGB:
+			imgSize = (CARD_BANNER_W * CARD_BANNER_H * 2);
+			if ((uint32_t)imgData.size() < bannerAddr + imgSize)
+				return nullptr;
+			break;
+		default:
+			// No banner.
+			return nullptr;
+	}
 
-		switch (iconfmt & CARD_ICON_MASK) {
-			case CARD_ICON_CI_SHARED: {
-				// CI8 palette is after *all* the icons.
-				// (256 entries in RGB5A3 format.)
-				// This is handled after the rest of the icons.
-				CI8_SHARED_data data;
-				data.iconIdx = i;
-				data.iconAddr = imgAddr;
-				lst_CI8_SHARED.append(data);
+	GcImage *gcBannerImg = nullptr;
+	switch (dirEntry->bannerfmt & CARD_BANNER_MASK) {
+		case CARD_BANNER_CI:
+			// CI8 palette is right after the banner.
+			// (256 entries in RGB5A3 format.)
+			gcBannerImg = GcImageLoader::fromCI8(CARD_BANNER_W, CARD_BANNER_H,
+					(const uint8_t*)&imgData.constData()[bannerAddr], imgSize,
+					(const uint16_t*)&imgData.constData()[bannerAddr + imgSize], 0x200);
+			break;
 
-				// Add a nullptr as a placeholder.
-				gcImages.append(nullptr);
+		case CARD_BANNER_RGB:
+			gcBannerImg = GcImageLoader::fromRGB5A3(CARD_BANNER_W, CARD_BANNER_H,
+					(const uint16_t*)&imgData.constData()[bannerAddr], imgSize);
+			break;
 
-				// Next icon.
-				imgAddr += (CARD_ICON_W * CARD_ICON_H * 1);
-				continue;
-			}
+		default:
+			break;
+	}
 
-			case CARD_ICON_CI_UNIQUE: {
-				// CI8 palette is right after the icon.
-				// (256 entries in RGB5A3 format.)
-				const int imageSize = (CARD_ICON_W * CARD_ICON_H * 1);
-				GcImage *gcIcon = GcImageLoader::fromCI8(CARD_ICON_W, CARD_ICON_H,
-						(const uint8_t*)&imgData.constData()[imgAddr], imageSize,
-						(const uint16_t*)&imgData.constData()[imgAddr + imageSize], 0x200);
-				gcImages.append(gcIcon);
-				imgAddr += imageSize + 0x200;
-				break;
-			}
+	return gcBannerImg;
+}
 
-			case CARD_BANNER_RGB: {
-				const int imageSize = (CARD_ICON_W * CARD_ICON_H * 2);
-				GcImage *gcIcon = GcImageLoader::fromRGB5A3(CARD_ICON_W, CARD_ICON_H,
-						(const uint16_t*)&imgData.constData()[imgAddr], imageSize);
-				gcImages.append(gcIcon);
-				imgAddr += imageSize;
-				break;
+/**
+ * Decode an icon image from imgData.
+ * @param idx Icon number.
+ * @return GcImage containing the icon image, or nullptr on error.
+ */
+GcImage *GcnFilePrivate::loadIconImage(int idx) const
+{
+	if (idx < 0 || idx >= iconFrames.size())
+		return nullptr;
+
+	// NOTE: loadImageData() already verified that
+	// the icon is present in imgData.
+	const IconFrame &frame = iconFrames.at(idx);
+	GcImage *gcIcon = nullptr;
+	switch (frame.fmt) {
+		case CARD_ICON_CI_SHARED: {
+			// CI8 palette is after *all* the icons.
+			// (256 entries in RGB5A3 format.)
+			// It's only decoded once, and all frames share it.
+			if (!sharedPalette) {
+				sharedPalette = GcImageLoader::decodePalette(
+					(const uint16_t*)&imgData.constData()[sharedPaletteAddr], 0x200);
+				if (!sharedPalette)
+					break;
 			}
+			const int imageSize = (CARD_ICON_W * CARD_ICON_H * 1);
+			gcIcon = GcImageLoader::fromCI8(CARD_ICON_W, CARD_ICON_H,
+					(const uint8_t*)&imgData.constData()[frame.addr], imageSize,
+					sharedPalette);
+			break;
+		}
 
-			default:
-				// No icon.
-				// Add a nullptr as a placeholder.
-				gcImages.append(nullptr);
-				break;
+		case CARD_ICON_CI_UNIQUE: {
+			// CI8 palette is right after the icon.
+			// (256 entries in RGB5A3 format.)
+			const int imageSize = (CARD_ICON_W * CARD_ICON_H * 1);
+			gcIcon = GcImageLoader::fromCI8(CARD_ICON_W, CARD_ICON_H,
+					(const uint8_t*)&imgData.constData()[frame.addr], imageSize,
+					(const uint16_t*)&imgData.constData()[frame.addr + imageSize], 0x200);
+			break;
 		}
-	}
 
-	if (!lst_CI8_SHARED.isEmpty()) {
-		// Process CI8 SHARED icons.
-		// TODO: Convert the palette once instead of every time?
-		const int imageSize = (CARD_ICON_W * CARD_ICON_H * 1);
-		foreach (const CI8_SHARED_data& data, lst_CI8_SHARED) {
-			GcImage *gcIcon = GcImageLoader::fromCI8(CARD_ICON_W, CARD_ICON_H,
-						(const uint8_t*)&imgData.constData()[data.iconAddr], imageSize,
-						(const uint16_t*)&imgData.constData()[imgAddr], 0x200);
-			gcImages[data.iconIdx] = gcIcon;
+		case CARD_ICON_RGB: {
+			const int imageSize = (CARD_ICON_W * CARD_ICON_H * 2);
+			gcIcon = GcImageLoader::fromRGB5A3(CARD_ICON_W, CARD_ICON_H,
+					(const uint16_t*)&imgData.constData()[frame.addr], imageSize);
+			break;
 		}
-	}
 
-	// Shrink the QVector.
-	int iconCount = gcImages.size();
-	for (; iconCount > 0; iconCount--) {
-		if (gcImages.at(iconCount-1))
+		default:
+			// No icon.
 			break;
 	}
-	if (iconCount > 0)
-		gcImages.resize(iconCount);
-	else
-		gcImages.clear();
 
-	return gcImages;
+	return gcIcon;
 }
 
 /** GcnFile **/
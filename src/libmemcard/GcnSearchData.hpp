@@ -13,6 +13,7 @@
 #include "Checksum.hpp"
 
 // Qt includes.
+#include <QtCore/QMetaType>
 #include <QtCore/QVector>
 
 struct GcnSearchData
@@ -22,4 +23,7 @@ struct GcnSearchData
 	QVector<Checksum::ChecksumDef> checksumDefs;
 };
 
+// Needed for GcnSearchWorker::filesFound() across threads.
+Q_DECLARE_METATYPE(GcnSearchData)
+
 #endif /* __LIBMEMCARD_GCNSEARCHDATA_HPP__ */
@@ -88,22 +88,32 @@ class VmuFilePrivate : public FilePrivate
 
 		// VMU icons. (ICONDATA_VMS)
 		// NOTE: These must NOT be the same as
-		// gcBanner or any icon in gcIcons.
+		// lazyBanner or any icon in lazyIcons.
 		bool isIconData;
 		GcImage *vmu_icon_mono;
 		GcImage *vmu_icon_color;
 
+		// Icon count. (normal VMU files only)
+		int vmuIconCount;
+
+		/**
+		 * Load the raw image data and icon animation information.
+		 * @return Number of icons.
+		 */
+		int loadImageData(void) final;
+
 		/**
-		 * Load the banner image.
+		 * Decode the banner image from imgData.
 		 * @return GcImage containing the banner image, or nullptr on error.
 		 */
-		GcImage *loadBannerImage(void) final;
+		GcImage *loadBannerImage(void) const final;
 
 		/**
-		 * Load the icon images.
-		 * @return QVector<GcImage*> containing the icon images, or empty QVector on error.
+		 * Decode an icon image from imgData.
+		 * @param idx Icon number.
+		 * @return GcImage containing the icon image, or nullptr on error.
 		 */
-		QVector<GcImage*> loadIconImages(void) final;
+		GcImage *loadIconImage(int idx) const final;
 
 		/**
 		 * Load the icon images.
@@ -134,6 +144,7 @@ VmuFilePrivate::VmuFilePrivate(VmuFile *q, VmuCard *card,
 	, isIconData(false)
 	, vmu_icon_mono(nullptr)
 	, vmu_icon_color(nullptr)
+	, vmuIconCount(0)
 {
 	if (!dirEntry || !mc_fat) {
 		// Invalid data.
@@ -285,15 +296,82 @@ void VmuFilePrivate::loadFileInfo(void)
 		description = filename + QChar(L'\0') + dc_desc;
 	}
 
-	// Load the banner and icon images.
+	// Prepare the banner and icon images.
+	// They're decoded on demand.
 	loadImages();
 }
 
 /**
- * Load the banner image.
+ * Load the raw image data and icon animation information.
+ * @return Number of icons.
+ */
+int VmuFilePrivate::loadImageData(void)
+{
+	// DC only supports looping icon animations.
+	// TODO: Use system-independent values?
+	this->iconAnimMode = 0;
+	this->iconSpeed.clear();
+	vmuIconCount = 0;
+
+	// Load the file into memory.
+	// VMU files are small, so the entire file is cached.
+	// TODO: Optimize by only reading in required data.
+	imgData = this->loadFileData();
+
+	if (isIconData) {
+		// ICONDATA_VMS
+
+		// NOTE: This file *may* have a different icon
+		// for the File Manager, but it's usually the
+		// same as the color icon. In addition, this
+		// file is hidden in the File Manager, so a
+		// custom icon wouldn't be visible.
+
+		// Load the ICONDATA_VMS icons for CardView.
+		// These are decoded immediately, since VmuCard
+		// needs them, and there's only one such file.
+		loadIconImages_ICONDATA_VMS();
+		return (vmu_icon_color || vmu_icon_mono ? 1 : 0);
+	}
+
+	if (!fileHeader || fileHeader->icon_count == 0) {
+		// No file header or icons.
+		return 0;
+	}
+
+	// Sanity check: Clamp to 8 icons maximum.
+	int iconCount = fileHeader->icon_count;
+	if (iconCount > 8)
+		iconCount = 8;
+
+	// Icon start address.
+	int iconStart = (dirEntry->header_addr * card->blockSize());
+	iconStart += sizeof(*fileHeader);
+
+	// Calculate the total icon length.
+	const int totalIconLen = sizeof(vmu_icon_palette) +
+				(sizeof(vmu_icon_data) * iconCount);
+	if (imgData.size() < (int)(iconStart + totalIconLen)) {
+		// File is too small.
+		// The icons aren't actually there...
+		return 0;
+	}
+
+	for (int i = 0; i < iconCount; i++) {
+		// TODO: Should be part of a struct that's returned...
+		// TODO: Convert DC icon speed to system-independent value.
+		this->iconSpeed.append(3);
+	}
+
+	vmuIconCount = iconCount;
+	return iconCount;
+}
+
+/**
+ * Decode the banner image from imgData.
  * @return GcImage* containing the banner image, or nullptr on error.
  */
-GcImage *VmuFilePrivate::loadBannerImage(void)
+GcImage *VmuFilePrivate::loadBannerImage(void) const
 {
 	if (isIconData) {
 		// ICONDATA_VMS
@@ -313,12 +391,6 @@ GcImage *VmuFilePrivate::loadBannerImage(void)
 		return nullptr;
 	}
 
-	// Load the file into memory.
-	// TODO: Optimize by only reading in required data.
-	// TODO: Copy over the block code from GcnFile::loadIconImages(),
-	// but move the "read from X to Y" code down to File.
-	QByteArray data = this->loadFileData();
-
 	// Eyecatch start address.
 	int eyecatchStart = (dirEntry->header_addr * card->blockSize());
 	eyecatchStart += sizeof(*fileHeader);
@@ -329,13 +401,13 @@ GcImage *VmuFilePrivate::loadBannerImage(void)
 
 	// TODO: Other variants.
 	const int eyecatchSize = VMU_EYECATCH_PALETTE_16_LEN;
-	if (data.size() < (int)(eyecatchStart + eyecatchSize)) {
+	if (imgData.size() < (int)(eyecatchStart + eyecatchSize)) {
 		// File is too small.
 		// The eyecatch isn't actually there...
 		return nullptr;
 	}
 
-	const vmu_eyecatch_palette_16 *eyecatch16 = (const vmu_eyecatch_palette_16*)(data.data() + eyecatchStart);
+	const vmu_eyecatch_palette_16 *eyecatch16 = (const vmu_eyecatch_palette_16*)(imgData.constData() + eyecatchStart);
 	GcImage *gcImage = DcImageLoader::fromPalette16(
 				VMU_EYECATCH_W, VMU_EYECATCH_H,
 				eyecatch16->eyecatch, sizeof(eyecatch16->eyecatch),
@@ -344,94 +416,48 @@ GcImage *VmuFilePrivate::loadBannerImage(void)
 }
 
 /**
- * Load the icon images.
- * @return QVector<GcImage*> containing the icon images, or empty QVector on error.
+ * Decode an icon image from imgData.
+ * @param idx Icon number.
+ * @return GcImage containing the icon image, or nullptr on error.
  */
-QVector<GcImage*> VmuFilePrivate::loadIconImages(void)
+GcImage *VmuFilePrivate::loadIconImage(int idx) const
 {
 	if (isIconData) {
 		// ICONDATA_VMS
-
-		// NOTE: This file *may* have a different icon
-		// for the File Manager, but it's usually the
-		// same as the color icon. In addition, this
-		// file is hidden in the File Manager, so a
-		// custom icon wouldn't be visible.
-
-		// Load the ICONDATA_VMS icons for CardView.
-		// The "regular" icon will be loaded here.
-		loadIconImages_ICONDATA_VMS();
-
 		// TODO: If the ICONDATA_VMS icon doesn't start
 		// at 0x60, load a separate icon. For now, just
 		// return either the color or monochrome icon.
-		GcImage *ret_icon = nullptr;
-		if (vmu_icon_color) {
+		if (idx != 0) {
+			return nullptr;
+		} else if (vmu_icon_color) {
 			// Color icon was loaded.
-			ret_icon = new GcImage(*vmu_icon_color);
+			return new GcImage(*vmu_icon_color);
 		} else if (vmu_icon_mono) {
 			// Monochrome icon was loaded.
-			ret_icon = new GcImage(*vmu_icon_mono);
-		}
-
-		QVector<GcImage*> ret;
-		if (ret_icon) {
-			ret.append(ret_icon);
+			return new GcImage(*vmu_icon_mono);
 		}
-		return ret;
+		return nullptr;
 	}
 
-	// DC only supports looping icon animations.
-	// TODO: Use system-independent values?
-	this->iconAnimMode = 0;
-
-	if (!fileHeader || fileHeader->icon_count == 0) {
-		// No file header or icons.
-		return QVector<GcImage*>();
+	if (idx < 0 || idx >= vmuIconCount) {
+		// Invalid icon index.
+		return nullptr;
 	}
 
-	// Sanity check: Clamp to 8 icons maximum.
-	int iconCount = fileHeader->icon_count;
-	if (iconCount > 8)
-		iconCount = 8;
-
-	// Load the file into memory.
-	// TODO: Optimize by only reading in required data.
-	// TODO: Copy over the block code from GcnFile::loadIconImages(),
-	// but move the "read from X to Y" code down to File.
-	QByteArray data = this->loadFileData();
-
 	// Icon start address.
+	// NOTE: loadImageData() already verified that
+	// the icons are present in imgData.
 	int iconStart = (dirEntry->header_addr * card->blockSize());
 	iconStart += sizeof(*fileHeader);
 
-	// Calculate the total icon length.
-	const int totalIconLen = sizeof(vmu_icon_palette) +
-				(sizeof(vmu_icon_data) * iconCount);
-	if (data.size() < (int)(iconStart + totalIconLen)) {
-		// File is too small.
-		// The icons aren't actually there...
-		return QVector<GcImage*>();
-	}
-
-	const char *pIconStart = (data.data() + iconStart);
+	const char *pIconStart = (imgData.constData() + iconStart);
 	const vmu_icon_palette *palette = (const vmu_icon_palette*)pIconStart;
 	const vmu_icon_data *iconData = (const vmu_icon_data*)(pIconStart + sizeof(*palette));
-	QVector<GcImage*> gcImages;
-	// TODO: Should be part of a struct that's returned...
-	this->iconSpeed.clear();
-	for (int i = 0; i < iconCount; i++, iconData++) {
-		// TODO: Should be part of a struct that's returned...
-		// TODO: Convert DC icon speed to system-independent value.
-		this->iconSpeed.append(3);
-		GcImage *gcImage = DcImageLoader::fromPalette16(
-					VMU_ICON_W, VMU_ICON_H,
-					iconData->icon, sizeof(iconData->icon),
-					palette->palette, sizeof(palette->palette));
-		gcImages.append(gcImage);
-	}
-
-	return gcImages;
+	iconData += idx;
+	return DcImageLoader::fromPalette16(
+			VMU_ICON_W, VMU_ICON_H,
+			iconData->icon, sizeof(iconData->icon),
+			palette->palette, sizeof(palette->palette));
 }
 
 /**
@@ -450,15 +476,9 @@ void VmuFilePrivate::loadIconImages_ICONDATA_VMS(void)
 	delete vmu_icon_color;
 	vmu_icon_color = nullptr;
 
-	// DC only supports looping icon animations.
-	// TODO: Use system-independent values?
-	this->iconAnimMode = 0;
-
-	// Load the file into memory.
-	// TODO: Optimize by only reading in required data.
-	// TODO: Copy over the block code from GcnFile::loadIconImages(),
-	// but move the "read from X to Y" code down to File.
-	QByteArray data = this->loadFileData();
+	// NOTE: The file data was loaded into imgData
+	// by loadImageData().
+	const QByteArray &data = imgData;
 
 	// Get the ICONDATA_VMS header.
 	const int headerStart = (dirEntry->header_addr * card->blockSize());
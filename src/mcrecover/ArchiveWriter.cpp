@@ -0,0 +1,623 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * ArchiveWriter.cpp: Streaming ZIP/tar archive writer.                    *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "ArchiveWriter.hpp"
+
+// zlib
+#include <zlib.h>
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// Qt includes.
+#include <QtCore/QIODevice>
+#include <QtCore/QVector>
+
+/** ArchiveWriterPrivate **/
+
+class ArchiveWriterPrivate
+{
+	public:
+		ArchiveWriterPrivate(ArchiveWriter *q, QIODevice *qioDevice,
+			ArchiveWriter::ArchiveFormat format,
+			ArchiveWriter::Compression compression);
+		~ArchiveWriterPrivate();
+
+	protected:
+		ArchiveWriter *const q_ptr;
+		Q_DECLARE_PUBLIC(ArchiveWriter)
+	private:
+		Q_DISABLE_COPY(ArchiveWriterPrivate)
+
+	public:
+		QIODevice *const qioDevice;
+		const ArchiveWriter::ArchiveFormat format;
+		const ArchiveWriter::Compression compression;
+
+		// Sticky error code. Once an error occurs,
+		// nothing else is written to the archive.
+		int err;
+
+		// Has the archive been finished?
+		bool finished;
+
+		/** ZIP **/
+
+		// Central directory entry.
+		struct CentralDirEntry {
+			QByteArray name;	// UTF-8
+			quint32 crc32;
+			quint32 compSize;
+			quint32 size;
+			quint32 offset;		// Offset of the local file header.
+			quint16 method;
+			quint16 dosTime;
+			quint16 dosDate;
+		};
+		QVector<CentralDirEntry> centralDir;
+
+		// Current offset in the ZIP archive.
+		// NOTE: ZIP64 isn't supported, so this must fit in 32 bits.
+		quint64 offset;
+
+		/** tar **/
+
+		// gzip stream for compressed tar archives.
+		z_stream strm;
+		bool strmInit;
+
+		// ustar header block size.
+		static const int TAR_BLOCK_SIZE = 512;
+
+		/**
+		 * Write data to the QIODevice.
+		 * For compressed tar archives, the data is compressed first.
+		 * @param data Data.
+		 * @param size Size of data.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int write(const char *data, qint64 size);
+
+		/**
+		 * Compress data into the gzip stream and write the output.
+		 * @param data Data.
+		 * @param size Size of data.
+		 * @param flush zlib flush mode.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int gzipWrite(const char *data, uInt size, int flush);
+
+		/**
+		 * Write a ZIP entry.
+		 * @param entry Archive entry.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int writeZipEntry(const ArchiveWriter::Entry &entry);
+
+		/**
+		 * Write the ZIP central directory.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int writeZipCentralDir(void);
+
+		/**
+		 * Write a tar entry.
+		 * @param entry Archive entry.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int writeTarEntry(const ArchiveWriter::Entry &entry);
+
+		/**
+		 * Convert a QDateTime to MS-DOS date and time.
+		 * @param mtime		[in] QDateTime.
+		 * @param pDosTime	[out] MS-DOS time.
+		 * @param pDosDate	[out] MS-DOS date.
+		 */
+		static void toDosDateTime(const QDateTime &mtime, quint16 *pDosTime, quint16 *pDosDate);
+
+		/**
+		 * Compress data using raw deflate.
+		 * @param out	[out] Compressed data.
+		 * @param data	[in] Uncompressed data.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		static int deflateRaw(QByteArray &out, const QByteArray &data);
+
+		/**
+		 * Append a 16-bit little-endian value to a QByteArray.
+		 * @param ba QByteArray.
+		 * @param val Value.
+		 */
+		static inline void appendLE16(QByteArray &ba, quint16 val)
+		{
+			ba.append(static_cast<char>(val & 0xFF));
+			ba.append(static_cast<char>(val >> 8));
+		}
+
+		/**
+		 * Append a 32-bit little-endian value to a QByteArray.
+		 * @param ba QByteArray.
+		 * @param val Value.
+		 */
+		static inline void appendLE32(QByteArray &ba, quint32 val)
+		{
+			appendLE16(ba, static_cast<quint16>(val & 0xFFFF));
+			appendLE16(ba, static_cast<quint16>(val >> 16));
+		}
+};
+
+ArchiveWriterPrivate::ArchiveWriterPrivate(ArchiveWriter *q, QIODevice *qioDevice,
+		ArchiveWriter::ArchiveFormat format,
+		ArchiveWriter::Compression compression)
+	: q_ptr(q)
+	, qioDevice(qioDevice)
+	, format(format)
+	, compression(compression)
+	, err(0)
+	, finished(false)
+	, offset(0)
+	, strmInit(false)
+{
+	memset(&strm, 0, sizeof(strm));
+	if (format == ArchiveWriter::FORMAT_TAR &&
+	    compression == ArchiveWriter::COMPRESS_DEFLATE)
+	{
+		// Compressed tar archive. (gzip)
+		// NOTE: windowBits + 16 writes a gzip header.
+		int ret = deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+				       MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+		if (ret == Z_OK) {
+			strmInit = true;
+		} else {
+			err = -ENOMEM;
+		}
+	}
+}
+
+ArchiveWriterPrivate::~ArchiveWriterPrivate()
+{
+	if (strmInit) {
+		deflateEnd(&strm);
+	}
+}
+
+/**
+ * Write data to the QIODevice.
+ * For compressed tar archives, the data is compressed first.
+ * @param data Data.
+ * @param size Size of data.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ArchiveWriterPrivate::write(const char *data, qint64 size)
+{
+	if (err != 0)
+		return err;
+	if (size <= 0)
+		return 0;
+
+	if (strmInit) {
+		return gzipWrite(data, static_cast<uInt>(size), Z_NO_FLUSH);
+	}
+
+	if (qioDevice->write(data, size) != size) {
+		err = -EIO;
+		return err;
+	}
+	offset += size;
+	return 0;
+}
+
+/**
+ * Compress data into the gzip stream and write the output.
+ * @param data Data.
+ * @param size Size of data.
+ * @param flush zlib flush mode.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ArchiveWriterPrivate::gzipWrite(const char *data, uInt size, int flush)
+{
+	char out[16384];
+	strm.next_in = (z_const Bytef*)data;
+	strm.avail_in = size;
+
+	int ret;
+	do {
+		strm.next_out = reinterpret_cast<Bytef*>(out);
+		strm.avail_out = sizeof(out);
+		ret = deflate(&strm, flush);
+		if (ret == Z_STREAM_ERROR) {
+			err = -EIO;
+			return err;
+		}
+
+		const qint64 have = (qint64)(sizeof(out) - strm.avail_out);
+		if (have > 0 && qioDevice->write(out, have) != have) {
+			err = -EIO;
+			return err;
+		}
+	} while (strm.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+
+	return 0;
+}
+
+/**
+ * Write a ZIP entry.
+ * @param entry Archive entry.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ArchiveWriterPrivate::writeZipEntry(const ArchiveWriter::Entry &entry)
+{
+	CentralDirEntry cdEntry;
+	cdEntry.name = entry.name.toUtf8();
+	cdEntry.crc32 = entry.crc32;
+	cdEntry.compSize = static_cast<quint32>(entry.data.size());
+	cdEntry.size = entry.size;
+	cdEntry.method = entry.method;
+	toDosDateTime(entry.mtime, &cdEntry.dosTime, &cdEntry.dosDate);
+
+	if (cdEntry.name.size() > 0xFFFF)
+		return -ENAMETOOLONG;
+	if (centralDir.size() >= 0xFFFF)
+		return -EFBIG;
+
+	// Local file header.
+	QByteArray header;
+	header.reserve(30 + cdEntry.name.size());
+	appendLE32(header, 0x04034B50);		// Signature
+	appendLE16(header, 20);			// Version needed to extract (2.0)
+	appendLE16(header, 0x0800);		// Flags: UTF-8 filename
+	appendLE16(header, cdEntry.method);
+	appendLE16(header, cdEntry.dosTime);
+	appendLE16(header, cdEntry.dosDate);
+	appendLE32(header, cdEntry.crc32);
+	appendLE32(header, cdEntry.compSize);
+	appendLE32(header, cdEntry.size);
+	appendLE16(header, static_cast<quint16>(cdEntry.name.size()));
+	appendLE16(header, 0);			// Extra field length
+	header += cdEntry.name;
+
+	// ZIP64 isn't supported.
+	if (offset + header.size() + cdEntry.compSize > 0xFFFFFFFFULL)
+		return -EFBIG;
+	cdEntry.offset = static_cast<quint32>(offset);
+
+	int ret = write(header.constData(), header.size());
+	if (ret != 0)
+		return ret;
+	ret = write(entry.data.constData(), entry.data.size());
+	if (ret != 0)
+		return ret;
+
+	centralDir.append(cdEntry);
+	return 0;
+}
+
+/**
+ * Write the ZIP central directory.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ArchiveWriterPrivate::writeZipCentralDir(void)
+{
+	const quint64 cdOffset = offset;
+
+	QByteArray cd;
+	const CentralDirEntry *pCdEntry = centralDir.constData();
+	const CentralDirEntry *const pCdEnd = pCdEntry + centralDir.size();
+	for (; pCdEntry != pCdEnd; pCdEntry++) {
+		appendLE32(cd, 0x02014B50);		// Signature
+		appendLE16(cd, (3 << 8) | 20);		// Version made by (Unix, 2.0)
+		appendLE16(cd, 20);			// Version needed to extract (2.0)
+		appendLE16(cd, 0x0800);			// Flags: UTF-8 filename
+		appendLE16(cd, pCdEntry->method);
+		appendLE16(cd, pCdEntry->dosTime);
+		appendLE16(cd, pCdEntry->dosDate);
+		appendLE32(cd, pCdEntry->crc32);
+		appendLE32(cd, pCdEntry->compSize);
+		appendLE32(cd, pCdEntry->size);
+		appendLE16(cd, static_cast<quint16>(pCdEntry->name.size()));
+		appendLE16(cd, 0);			// Extra field length
+		appendLE16(cd, 0);			// File comment length
+		appendLE16(cd, 0);			// Disk number start
+		appendLE16(cd, 0);			// Internal file attributes
+		appendLE32(cd, 0100644U << 16);		// External file attributes (Unix mode)
+		appendLE32(cd, pCdEntry->offset);
+		cd += pCdEntry->name;
+	}
+
+	const quint32 cdSize = static_cast<quint32>(cd.size());
+	if (cdOffset + cdSize > 0xFFFFFFFFULL)
+		return -EFBIG;
+
+	// End of central directory record.
+	const quint16 count = static_cast<quint16>(centralDir.size());
+	appendLE32(cd, 0x06054B50);		// Signature
+	appendLE16(cd, 0);			// Number of this disk
+	appendLE16(cd, 0);			// Disk where the central directory starts
+	appendLE16(cd, count);			// Number of entries on this disk
+	appendLE16(cd, count);			// Total number of entries
+	appendLE32(cd, cdSize);			// Size of the central directory
+	appendLE32(cd, static_cast<quint32>(cdOffset));
+	appendLE16(cd, 0);			// Comment length
+
+	return write(cd.constData(), cd.size());
+}
+
+/**
+ * Write a tar entry.
+ * @param entry Archive entry.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ArchiveWriterPrivate::writeTarEntry(const ArchiveWriter::Entry &entry)
+{
+	// POSIX ustar header.
+	char header[TAR_BLOCK_SIZE];
+	memset(header, 0, sizeof(header));
+
+	// Filenames longer than 100 bytes are split into
+	// a prefix (up to 155 bytes) and a name.
+	const QByteArray name = entry.name.toUtf8();
+	int prefixLen = 0;
+	if (name.size() > 100) {
+		prefixLen = name.lastIndexOf('/', 155);
+		if (prefixLen <= 0 || name.size() - prefixLen - 1 > 100)
+			return -ENAMETOOLONG;
+		memcpy(&header[345], name.constData(), prefixLen);
+		prefixLen++;	// Skip the slash.
+	}
+	memcpy(&header[0], name.constData() + prefixLen, name.size() - prefixLen);
+
+	qint64 mtime = entry.mtime.isValid() ? (entry.mtime.toMSecsSinceEpoch() / 1000) : 0;
+	if (mtime < 0)
+		mtime = 0;
+	else if (mtime > 077777777777LL)
+		mtime = 077777777777LL;	// Maximum value for 11 octal digits.
+
+	snprintf(&header[100], 8, "%07o", 0644);	// Mode
+	snprintf(&header[108], 8, "%07o", 0);		// UID
+	snprintf(&header[116], 8, "%07o", 0);		// GID
+	snprintf(&header[124], 12, "%011o", entry.size);
+	snprintf(&header[136], 12, "%011llo", (unsigned long long)mtime);
+	header[156] = '0';				// Type: Regular file
+	memcpy(&header[257], "ustar", 6);		// Magic
+	memcpy(&header[263], "00", 2);			// Version
+
+	// Checksum is calculated with the checksum field set to spaces.
+	memset(&header[148], ' ', 8);
+	unsigned int chksum = 0;
+	for (int i = 0; i < TAR_BLOCK_SIZE; i++) {
+		chksum += static_cast<unsigned char>(header[i]);
+	}
+	snprintf(&header[148], 8, "%06o", chksum);
+	header[155] = ' ';
+
+	int ret = write(header, sizeof(header));
+	if (ret != 0)
+		return ret;
+	ret = write(entry.data.constData(), entry.data.size());
+	if (ret != 0)
+		return ret;
+
+	// Pad the data to a multiple of the block size.
+	const int padding = (TAR_BLOCK_SIZE - (entry.data.size() % TAR_BLOCK_SIZE)) % TAR_BLOCK_SIZE;
+	if (padding > 0) {
+		memset(header, 0, padding);
+		ret = write(header, padding);
+	}
+	return ret;
+}
+
+/**
+ * Convert a QDateTime to MS-DOS date and time.
+ * @param mtime		[in] QDateTime.
+ * @param pDosTime	[out] MS-DOS time.
+ * @param pDosDate	[out] MS-DOS date.
+ */
+void ArchiveWriterPrivate::toDosDateTime(const QDateTime &mtime, quint16 *pDosTime, quint16 *pDosDate)
+{
+	const QDate date = mtime.date();
+	const QTime time = mtime.time();
+	if (!mtime.isValid() || date.year() < 1980 || date.year() > 2107) {
+		// Out of range. Use 1980/01/01 00:00:00.
+		*pDosTime = 0;
+		*pDosDate = (1 << 5) | 1;
+		return;
+	}
+
+	*pDosTime = static_cast<quint16>((time.hour() << 11) | (time.minute() << 5) | (time.second() / 2));
+	*pDosDate = static_cast<quint16>(((date.year() - 1980) << 9) | (date.month() << 5) | date.day());
+}
+
+/**
+ * Compress data using raw deflate.
+ * @param out	[out] Compressed data.
+ * @param data	[in] Uncompressed data.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ArchiveWriterPrivate::deflateRaw(QByteArray &out, const QByteArray &data)
+{
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	// NOTE: Negative windowBits writes a raw deflate stream.
+	int ret = deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+			       -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+	if (ret != Z_OK)
+		return -ENOMEM;
+
+	out.resize(static_cast<int>(deflateBound(&zs, static_cast<uLong>(data.size()))));
+	zs.next_in = (z_const Bytef*)data.constData();
+	zs.avail_in = static_cast<uInt>(data.size());
+	zs.next_out = reinterpret_cast<Bytef*>(out.data());
+	zs.avail_out = static_cast<uInt>(out.size());
+
+	// deflateBound() guarantees the output fits in a single call.
+	ret = deflate(&zs, Z_FINISH);
+	deflateEnd(&zs);
+	if (ret != Z_STREAM_END) {
+		out.clear();
+		return -EIO;
+	}
+
+	out.resize(static_cast<int>(zs.total_out));
+	return 0;
+}
+
+/** ArchiveWriter **/
+
+/**
+ * Create an archive writer.
+ * @param qioDevice QIODevice to write to. (Must be open for writing.)
+ * @param format Archive format.
+ * @param compression Compression method.
+ */
+ArchiveWriter::ArchiveWriter(QIODevice *qioDevice, ArchiveFormat format, Compression compression)
+	: d_ptr(new ArchiveWriterPrivate(this, qioDevice, format, compression))
+{ }
+
+ArchiveWriter::~ArchiveWriter()
+{
+	Q_D(ArchiveWriter);
+	delete d;
+}
+
+/**
+ * Prepare an archive entry.
+ * This compresses the data for ZIP archives, and doesn't
+ * access the QIODevice, so it's safe to call from
+ * multiple threads at the same time.
+ * @param entry		[out] Archive entry.
+ * @param name		[in] Filename within the archive. ('/' separators)
+ * @param data		[in] File data.
+ * @param mtime		[in] Modification time.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ArchiveWriter::prepareEntry(Entry &entry, const QString &name,
+	const QByteArray &data, const QDateTime &mtime) const
+{
+	Q_D(const ArchiveWriter);
+	entry.name = name;
+	entry.mtime = mtime;
+	entry.size = static_cast<quint32>(data.size());
+	entry.crc32 = 0;
+	entry.method = 0;	// Stored
+
+	if (d->format != FORMAT_ZIP) {
+		// tar archives are compressed as a whole.
+		entry.data = data;
+		return 0;
+	}
+
+	entry.crc32 = static_cast<quint32>(crc32(crc32(0L, Z_NULL, 0),
+		reinterpret_cast<const Bytef*>(data.constData()),
+		static_cast<uInt>(data.size())));
+
+	if (d->compression == COMPRESS_DEFLATE && !data.isEmpty()) {
+		int ret = ArchiveWriterPrivate::deflateRaw(entry.data, data);
+		if (ret != 0)
+			return ret;
+		if (entry.data.size() < data.size()) {
+			entry.method = 8;	// Deflated
+			return 0;
+		}
+		// Compressed data is larger than the original.
+	}
+
+	// Store the file uncompressed.
+	entry.data = data;
+	return 0;
+}
+
+/**
+ * Write a prepared archive entry.
+ * @param entry Archive entry from prepareEntry().
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ArchiveWriter::writeEntry(const Entry &entry)
+{
+	Q_D(ArchiveWriter);
+	if (d->err != 0)
+		return d->err;
+	if (d->finished)
+		return -EINVAL;
+
+	if (d->format == FORMAT_ZIP) {
+		return d->writeZipEntry(entry);
+	}
+	return d->writeTarEntry(entry);
+}
+
+/**
+ * Add a file to the archive.
+ * This is equivalent to prepareEntry() followed by writeEntry().
+ * @param name Filename within the archive. ('/' separators)
+ * @param data File data.
+ * @param mtime Modification time.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ArchiveWriter::addFile(const QString &name, const QByteArray &data, const QDateTime &mtime)
+{
+	Entry entry;
+	int ret = prepareEntry(entry, name, data, mtime);
+	if (ret != 0)
+		return ret;
+	return writeEntry(entry);
+}
+
+/**
+ * Finish the archive.
+ * This writes the ZIP central directory or the tar
+ * end-of-archive marker, and flushes the gzip stream.
+ * No more files can be added afterwards.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int ArchiveWriter::finish(void)
+{
+	Q_D(ArchiveWriter);
+	if (d->err != 0)
+		return d->err;
+	if (d->finished)
+		return 0;
+	d->finished = true;
+
+	if (d->format == FORMAT_ZIP) {
+		return d->writeZipCentralDir();
+	}
+
+	// tar: End of archive is marked by two empty blocks.
+	char zero[ArchiveWriterPrivate::TAR_BLOCK_SIZE * 2];
+	memset(zero, 0, sizeof(zero));
+	int ret = d->write(zero, sizeof(zero));
+	if (ret != 0)
+		return ret;
+
+	if (d->strmInit) {
+		// Flush the gzip stream.
+		ret = d->gzipWrite(nullptr, 0, Z_FINISH);
+	}
+	return ret;
+}
+
+/**
+ * Get the default file extension for an archive format.
+ * @param format Archive format.
+ * @param compression Compression method.
+ * @return File extension, without the leading dot.
+ */
+const char *ArchiveWriter::extForFormat(ArchiveFormat format, Compression compression)
+{
+	switch (format) {
+		case FORMAT_ZIP:
+			return "zip";
+		case FORMAT_TAR:
+			return (compression == COMPRESS_DEFLATE ? "tar.gz" : "tar");
+		default:
+			break;
+	}
+	return nullptr;
+}
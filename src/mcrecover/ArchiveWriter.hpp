@@ -0,0 +1,123 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * ArchiveWriter.hpp: Streaming ZIP/tar archive writer.                    *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __MCRECOVER_ARCHIVEWRITER_HPP__
+#define __MCRECOVER_ARCHIVEWRITER_HPP__
+
+// Qt includes.
+#include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
+#include <QtCore/QString>
+
+// Qt classes.
+class QIODevice;
+
+/**
+ * Streaming archive writer.
+ *
+ * Files are written to the QIODevice as soon as they're added,
+ * so the device doesn't need to be seekable.
+ *
+ * ZIP archives are compressed per file, so compressed entries
+ * can be prepared on other threads using prepareEntry().
+ * tar archives are compressed as a single gzip stream.
+ */
+class ArchiveWriterPrivate;
+class ArchiveWriter
+{
+	public:
+		enum ArchiveFormat {
+			FORMAT_ZIP,	// PKZIP
+			FORMAT_TAR,	// POSIX ustar
+		};
+
+		enum Compression {
+			COMPRESS_STORE,		// No compression.
+			COMPRESS_DEFLATE,	// Deflate. (tar: gzip)
+		};
+
+		/**
+		 * Create an archive writer.
+		 * @param qioDevice QIODevice to write to. (Must be open for writing.)
+		 * @param format Archive format.
+		 * @param compression Compression method.
+		 */
+		ArchiveWriter(QIODevice *qioDevice, ArchiveFormat format, Compression compression);
+		~ArchiveWriter();
+
+	protected:
+		ArchiveWriterPrivate *const d_ptr;
+		Q_DECLARE_PRIVATE(ArchiveWriter)
+	private:
+		Q_DISABLE_COPY(ArchiveWriter)
+
+	public:
+		/**
+		 * Archive entry.
+		 * For ZIP archives, this contains the file data
+		 * as it will be stored in the archive.
+		 */
+		struct Entry {
+			QString name;		// Filename within the archive. ('/' separators)
+			QDateTime mtime;	// Modification time.
+			QByteArray data;	// Stored data. (compressed if method != 0)
+			quint32 size;		// Uncompressed size.
+			quint32 crc32;		// CRC32 of the uncompressed data. (ZIP only)
+			quint16 method;		// ZIP compression method.
+		};
+
+		/**
+		 * Prepare an archive entry.
+		 * This compresses the data for ZIP archives, and doesn't
+		 * access the QIODevice, so it's safe to call from
+		 * multiple threads at the same time.
+		 * @param entry		[out] Archive entry.
+		 * @param name		[in] Filename within the archive. ('/' separators)
+		 * @param data		[in] File data.
+		 * @param mtime		[in] Modification time.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int prepareEntry(Entry &entry, const QString &name,
+			const QByteArray &data, const QDateTime &mtime) const;
+
+		/**
+		 * Write a prepared archive entry.
+		 * @param entry Archive entry from prepareEntry().
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int writeEntry(const Entry &entry);
+
+		/**
+		 * Add a file to the archive.
+		 * This is equivalent to prepareEntry() followed by writeEntry().
+		 * @param name Filename within the archive. ('/' separators)
+		 * @param data File data.
+		 * @param mtime Modification time.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int addFile(const QString &name, const QByteArray &data, const QDateTime &mtime);
+
+		/**
+		 * Finish the archive.
+		 * This writes the ZIP central directory or the tar
+		 * end-of-archive marker, and flushes the gzip stream.
+		 * No more files can be added afterwards.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int finish(void);
+
+		/**
+		 * Get the default file extension for an archive format.
+		 * @param format Archive format.
+		 * @param compression Compression method.
+		 * @return File extension, without the leading dot.
+		 */
+		static const char *extForFormat(ArchiveFormat format, Compression compression);
+};
+
+#endif /* __MCRECOVER_ARCHIVEWRITER_HPP__ */
@@ -0,0 +1,596 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * FileExporter.cpp: Background file exporter.                             *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "FileExporter.hpp"
+
+// File class.
+#include "libmemcard/File.hpp"
+
+// C includes. (C++ namespace)
+#include <cerrno>
+#include <cstdio>
+
+// C++ includes.
+#include <vector>
+using std::vector;
+
+// Qt includes.
+#include <QtCore/QAtomicInt>
+#include <QtCore/QBuffer>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QSaveFile>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+
+/** FileExporterPrivate **/
+
+class FileExporterPrivate
+{
+	public:
+		explicit FileExporterPrivate(FileExporter *q);
+		~FileExporterPrivate();
+
+	protected:
+		FileExporter *const q_ptr;
+		Q_DECLARE_PUBLIC(FileExporter)
+	private:
+		Q_DISABLE_COPY(FileExporterPrivate)
+
+	public:
+		// Files being exported.
+		// NOTE: This must not be modified while tasks are running.
+		QVector<FileExporter::Job> jobs;
+
+		// Animated image format for icons.
+		GcImageWriter::AnimImageFormat animImgf;
+		// Animated image format for the current export.
+		GcImageWriter::AnimImageFormat curAnimImgf;
+
+		// Thread pool for the export tasks.
+		QThreadPool threadPool;
+
+		// Next job index. (Shared by all tasks.)
+		QAtomicInt nextIdx;
+		// Set to cancel the export.
+		QAtomicInt cancelRequested;
+
+		// Export status.
+		// NOTE: Only accessed from the thread that owns FileExporter.
+		bool exporting;
+		int tasksRunning;
+		int filesProcessed;
+		int filesSaved;
+
+		/**
+		 * Export a single file.
+		 * NOTE: Called from the worker threads.
+		 * @param job Job.
+		 * @return 0 if the file was saved; non-zero on error.
+		 */
+		int exportFile(const FileExporter::Job &job) const;
+
+		/**
+		 * Start the export tasks.
+		 * @param jobs Files to export.
+		 */
+		void startExport(const QVector<FileExporter::Job> &jobs);
+
+		/**
+		 * Finish the current export and emit exportFinished().
+		 */
+		void finishExport(void);
+
+		/** Archive export **/
+
+		// Archive file and writer.
+		// If archiveWriter is nullptr, files are exported
+		// as individual files.
+		QSaveFile *archiveFile;
+		ArchiveWriter *archiveWriter;
+
+		// Prepared archive entries for a single job.
+		struct ArchiveResult {
+			QVector<ArchiveWriter::Entry> entries;
+			int ret;	// Return value for the main file.
+			bool ready;	// True once the entries are prepared.
+
+			ArchiveResult()
+				: ret(0)
+				, ready(false) { }
+		};
+		QVector<ArchiveResult> archiveResults;
+
+		// Next job to write to the archive.
+		// Entries are written in the order of the job list.
+		int nextWriteIdx;
+
+		// Serializes archiveWriter, archiveResults, and nextWriteIdx.
+		QMutex archiveMutex;
+
+		/**
+		 * Export a single file to the archive.
+		 * The entries are prepared by the calling thread.
+		 * Prepared entries are written by whichever thread
+		 * completes the next job in order.
+		 * NOTE: Called from the worker threads.
+		 * @param idx Job index.
+		 */
+		void exportFileToArchive(int idx);
+
+		/**
+		 * Delete the archive writer and file.
+		 * If the archive wasn't committed, it's discarded.
+		 */
+		void closeArchive(void);
+};
+
+/** FileExporterTask **/
+
+/**
+ * Export task.
+ * Jobs are taken from the shared job list until
+ * all jobs have been processed or the export
+ * is cancelled.
+ */
+class FileExporterTask : public QRunnable
+{
+	public:
+		FileExporterTask(FileExporter *q, FileExporterPrivate *d)
+			: q(q)
+			, d(d) { }
+
+		void run(void) final;
+
+	private:
+		Q_DISABLE_COPY(FileExporterTask)
+		FileExporter *const q;
+		FileExporterPrivate *const d;
+};
+
+void FileExporterTask::run(void)
+{
+	const int totalFiles = d->jobs.size();
+	for (int idx = d->nextIdx.fetchAndAddRelaxed(1); idx < totalFiles;
+	     idx = d->nextIdx.fetchAndAddRelaxed(1))
+	{
+		if (d->cancelRequested.loadAcquire())
+			break;
+
+		if (d->archiveWriter) {
+			// NOTE: The file might be written to the
+			// archive by a different task.
+			d->exportFileToArchive(idx);
+		} else {
+			const int ret = d->exportFile(d->jobs.at(idx));
+			QMetaObject::invokeMethod(q, "fileProcessed_slot",
+				Qt::QueuedConnection, Q_ARG(int, ret));
+		}
+	}
+
+	// NOTE: This is queued after all of this task's
+	// fileProcessed_slot() calls.
+	QMetaObject::invokeMethod(q, "taskFinished_slot", Qt::QueuedConnection);
+}
+
+FileExporterPrivate::FileExporterPrivate(FileExporter *q)
+	: q_ptr(q)
+	, animImgf(GcImageWriter::ANIMGF_APNG)
+	, curAnimImgf(GcImageWriter::ANIMGF_APNG)
+	, exporting(false)
+	, tasksRunning(0)
+	, filesProcessed(0)
+	, filesSaved(0)
+	, archiveFile(nullptr)
+	, archiveWriter(nullptr)
+	, nextWriteIdx(0)
+{ }
+
+FileExporterPrivate::~FileExporterPrivate()
+{
+	// Stop the running export.
+	cancelRequested.storeRelease(1);
+	threadPool.waitForDone();
+	closeArchive();
+}
+
+/**
+ * Export a single file.
+ * NOTE: Called from the worker threads.
+ * @param job Job.
+ * @return 0 if the file was saved; non-zero on error.
+ */
+int FileExporterPrivate::exportFile(const FileExporter::Job &job) const
+{
+	// NOTE: Card reads are serialized by the Card,
+	// so only image encoding and file output run in parallel.
+	File *const file = job.file;
+
+	// Save the file.
+	const int ret = file->exportToFile(job.filename);
+
+	// Extract the banner.
+	if (!job.bannerFilenameNoExt.isEmpty()) {
+		// TODO: Error handling and details.
+		file->saveBanner(job.bannerFilenameNoExt);
+	}
+
+	// Extract the icon.
+	if (!job.iconFilenameNoExt.isEmpty() && file->iconCount() >= 1) {
+		// TODO: Error handling and details.
+		file->saveIcon(job.iconFilenameNoExt, curAnimImgf);
+	}
+
+	return ret;
+}
+
+/**
+ * Start the export tasks.
+ * @param jobs Files to export.
+ */
+void FileExporterPrivate::startExport(const QVector<FileExporter::Job> &jobs)
+{
+	Q_Q(FileExporter);
+	this->jobs = jobs;
+	curAnimImgf = animImgf;
+	nextIdx.storeRelease(0);
+	cancelRequested.storeRelease(0);
+	filesProcessed = 0;
+	filesSaved = 0;
+	exporting = true;
+
+	const int totalFiles = jobs.size();
+	emit q->exportStarted(totalFiles);
+	if (totalFiles == 0) {
+		// Nothing to export.
+		finishExport();
+		return;
+	}
+
+	// Start the export tasks.
+	int threadCount = QThread::idealThreadCount();
+	if (threadCount < 1)
+		threadCount = 1;
+	if (threadCount > totalFiles)
+		threadCount = totalFiles;
+
+	threadPool.setMaxThreadCount(threadCount);
+	tasksRunning = threadCount;
+	for (int i = threadCount; i > 0; i--) {
+		// NOTE: QThreadPool deletes the task when it's done.
+		threadPool.start(new FileExporterTask(q, this));
+	}
+}
+
+/**
+ * Finish the current export and emit exportFinished().
+ */
+void FileExporterPrivate::finishExport(void)
+{
+	const int totalFiles = jobs.size();
+	exporting = false;
+	tasksRunning = 0;
+	jobs.clear();
+
+	if (archiveWriter) {
+		// Finish the archive.
+		// It's only kept if all files were written.
+		bool ok = false;
+		if (!cancelRequested.loadAcquire() && filesProcessed == totalFiles) {
+			ok = (archiveWriter->finish() == 0 && archiveFile->commit());
+		}
+		if (!ok) {
+			filesSaved = 0;
+		}
+		closeArchive();
+	}
+
+	Q_Q(FileExporter);
+	emit q->exportFinished(filesSaved, totalFiles);
+}
+
+/**
+ * Export a single file to the archive.
+ * The entries are prepared by the calling thread.
+ * Prepared entries are written by whichever thread
+ * completes the next job in order.
+ * NOTE: Called from the worker threads.
+ * @param idx Job index.
+ */
+void FileExporterPrivate::exportFileToArchive(int idx)
+{
+	const FileExporter::Job &job = jobs.at(idx);
+	File *const file = job.file;
+	const QDateTime mtime = file->mtime();
+
+	// NOTE: prepareEntry() doesn't access the archive,
+	// so it doesn't need to be locked.
+	QVector<ArchiveWriter::Entry> entries;
+	ArchiveWriter::Entry entry;
+
+	// Save the file.
+	QBuffer buffer;
+	buffer.open(QIODevice::WriteOnly);
+	int ret = file->exportToFile(&buffer);
+	if (ret == 0) {
+		ret = archiveWriter->prepareEntry(entry, job.filename, buffer.data(), mtime);
+		if (ret == 0) {
+			entries.append(entry);
+		}
+	}
+	buffer.close();
+
+	// Extract the banner.
+	if (!job.bannerFilenameNoExt.isEmpty()) {
+		// TODO: Error handling and details.
+		QBuffer bannerBuffer;
+		bannerBuffer.open(QIODevice::WriteOnly);
+		if (file->saveBanner(&bannerBuffer) == 0) {
+			const char *const ext = GcImageWriter::extForImageFormat(GcImageWriter::IMGF_PNG);
+			QString filename = job.bannerFilenameNoExt;
+			if (ext)
+				filename += QChar(L'.') + QLatin1String(ext);
+			if (archiveWriter->prepareEntry(entry, filename, bannerBuffer.data(), mtime) == 0) {
+				entries.append(entry);
+			}
+		}
+	}
+
+	// Extract the icon.
+	if (!job.iconFilenameNoExt.isEmpty() && file->iconCount() >= 1) {
+		// TODO: Error handling and details.
+		GcImageWriter gcImageWriter;
+		const char *ext;
+		if (file->encodeIcon(&gcImageWriter, curAnimImgf, &ext) == 0) {
+			// NOTE: Same naming scheme as File::saveIcon().
+			const int numFiles = gcImageWriter.numFiles();
+			for (int i = 0; i < numFiles; i++) {
+				QString filename = job.iconFilenameNoExt;
+				if (numFiles > 1) {
+					// Multiple files.
+					// Append the file number.
+					char tmp[8];
+					snprintf(tmp, sizeof(tmp), "%02d", i+1);
+					filename += QChar(L'.') + QLatin1String(tmp);
+				}
+				if (ext)
+					filename += QChar(L'.') + QLatin1String(ext);
+
+				const vector<uint8_t> *pngData = gcImageWriter.memBuffer(i);
+				const QByteArray data(reinterpret_cast<const char*>(pngData->data()), (int)pngData->size());
+				if (archiveWriter->prepareEntry(entry, filename, data, mtime) == 0) {
+					entries.append(entry);
+				}
+			}
+		}
+	}
+
+	// Write all prepared entries that are next in order.
+	Q_Q(FileExporter);
+	QMutexLocker locker(&archiveMutex);
+	ArchiveResult &result = archiveResults[idx];
+	result.entries = entries;
+	result.ret = ret;
+	result.ready = true;
+
+	const int totalFiles = jobs.size();
+	for (; nextWriteIdx < totalFiles; nextWriteIdx++) {
+		ArchiveResult &nextResult = archiveResults[nextWriteIdx];
+		if (!nextResult.ready)
+			break;
+
+		int writeRet = nextResult.ret;
+		const ArchiveWriter::Entry *pEntry = nextResult.entries.constData();
+		const ArchiveWriter::Entry *const pEntryEnd = pEntry + nextResult.entries.size();
+		for (; pEntry != pEntryEnd; pEntry++) {
+			int entryRet = archiveWriter->writeEntry(*pEntry);
+			if (entryRet != 0 && writeRet == 0) {
+				writeRet = entryRet;
+			}
+		}
+
+		// Free the entries now that they've been written.
+		nextResult.entries.clear();
+		QMetaObject::invokeMethod(q, "fileProcessed_slot",
+			Qt::QueuedConnection, Q_ARG(int, writeRet));
+	}
+}
+
+/**
+ * Delete the archive writer and file.
+ * If the archive wasn't committed, it's discarded.
+ */
+void FileExporterPrivate::closeArchive(void)
+{
+	delete archiveWriter;
+	archiveWriter = nullptr;
+	if (archiveFile) {
+		// NOTE: QSaveFile discards the file if it wasn't committed.
+		archiveFile->cancelWriting();
+		delete archiveFile;
+		archiveFile = nullptr;
+	}
+	archiveResults.clear();
+	nextWriteIdx = 0;
+}
+
+/** FileExporter **/
+
+FileExporter::FileExporter(QObject *parent)
+	: super(parent)
+	, d_ptr(new FileExporterPrivate(this))
+{ }
+
+FileExporter::~FileExporter()
+{
+	Q_D(FileExporter);
+	delete d;
+}
+
+/** Properties. **/
+
+/**
+ * Is an export currently running?
+ * @return True if an export is running; false if not.
+ */
+bool FileExporter::isExporting(void) const
+{
+	Q_D(const FileExporter);
+	return d->exporting;
+}
+
+/**
+ * Get the animated image format used for animated icons.
+ * @return Animated image format.
+ */
+GcImageWriter::AnimImageFormat FileExporter::animImgf(void) const
+{
+	Q_D(const FileExporter);
+	return d->animImgf;
+}
+
+/**
+ * Set the animated image format used for animated icons.
+ * This only takes effect for exports started afterwards.
+ * @param animImgf Animated image format.
+ */
+void FileExporter::setAnimImgf(GcImageWriter::AnimImageFormat animImgf)
+{
+	Q_D(FileExporter);
+	d->animImgf = animImgf;
+}
+
+/**
+ * Export files in the background.
+ *
+ * File data is read, images are encoded, and the output
+ * files are written on a thread pool. The File objects
+ * must not be deleted until exportFinished() is emitted.
+ *
+ * @param jobs Files to export.
+ * @return 0 if the export was started; non-zero on error.
+ */
+int FileExporter::exportFiles_async(const QVector<Job> &jobs)
+{
+	Q_D(FileExporter);
+	if (d->exporting) {
+		// Export is already running.
+		return -EBUSY;
+	}
+
+	d->startExport(jobs);
+	return 0;
+}
+
+/**
+ * Export files to an archive in the background.
+ *
+ * File data is read and images are encoded on a thread pool.
+ * ZIP entries are compressed on the thread pool as well.
+ * Entries are written to the archive in the order of the
+ * job list. The archive is discarded if the export is
+ * cancelled or if the archive can't be written.
+ *
+ * @param jobs Files to export.
+ * @param archiveFilename Archive filename.
+ * @param format Archive format.
+ * @param compression Compression method.
+ * @return 0 if the export was started; non-zero on error.
+ */
+int FileExporter::exportToArchive_async(const QVector<Job> &jobs, const QString &archiveFilename,
+	ArchiveWriter::ArchiveFormat format, ArchiveWriter::Compression compression)
+{
+	Q_D(FileExporter);
+	if (d->exporting) {
+		// Export is already running.
+		return -EBUSY;
+	}
+
+	// NOTE: QSaveFile writes to a temporary file, so an
+	// existing archive is only replaced on success.
+	d->archiveFile = new QSaveFile(archiveFilename);
+	if (!d->archiveFile->open(QIODevice::WriteOnly)) {
+		// Error opening the archive.
+		// TODO: Convert QFileError to a POSIX error code.
+		d->closeArchive();
+		return -EIO;
+	}
+
+	d->archiveWriter = new ArchiveWriter(d->archiveFile, format, compression);
+	d->archiveResults.resize(jobs.size());
+	d->nextWriteIdx = 0;
+	d->startExport(jobs);
+	return 0;
+}
+
+/**
+ * Cancel the running export.
+ * Files that are currently being written will be finished.
+ * exportFinished() is emitted once the export has stopped.
+ * @param wait If true, wait for the export to stop before returning.
+ */
+void FileExporter::cancel(bool wait)
+{
+	Q_D(FileExporter);
+	if (!d->exporting)
+		return;
+
+	d->cancelRequested.storeRelease(1);
+	if (!wait)
+		return;
+
+	// Wait for the tasks to stop, then process their
+	// status updates immediately so exportFinished()
+	// is emitted before returning.
+	d->threadPool.waitForDone();
+	QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+	if (d->exporting) {
+		// Shouldn't happen, but make sure the export is finished.
+		d->finishExport();
+	}
+}
+
+/** Private slots. **/
+
+/**
+ * A file has been processed.
+ * NOTE: Called from the worker threads using a queued connection.
+ * @param ret 0 if the file was saved; non-zero on error.
+ */
+void FileExporter::fileProcessed_slot(int ret)
+{
+	Q_D(FileExporter);
+	if (!d->exporting)
+		return;
+
+	d->filesProcessed++;
+	if (ret == 0) {
+		// File saved successfully.
+		d->filesSaved++;
+	}
+
+	emit exportUpdate(d->filesProcessed, d->jobs.size());
+}
+
+/**
+ * A worker task has finished.
+ * NOTE: Called from the worker threads using a queued connection.
+ */
+void FileExporter::taskFinished_slot(void)
+{
+	Q_D(FileExporter);
+	if (!d->exporting)
+		return;
+
+	d->tasksRunning--;
+	if (d->tasksRunning <= 0) {
+		// All tasks have finished.
+		d->finishExport();
+	}
+}
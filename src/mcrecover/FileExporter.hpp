@@ -0,0 +1,159 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * FileExporter.hpp: Background file exporter.                             *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __MCRECOVER_FILEEXPORTER_HPP__
+#define __MCRECOVER_FILEEXPORTER_HPP__
+
+// GcImageWriter.
+#include "GcImageWriter.hpp"
+
+// Archive writer.
+#include "ArchiveWriter.hpp"
+
+// Qt includes.
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+class File;
+
+class FileExporterPrivate;
+class FileExporter : public QObject
+{
+	Q_OBJECT
+	typedef QObject super;
+
+	public:
+		explicit FileExporter(QObject *parent = 0);
+		virtual ~FileExporter();
+
+	protected:
+		FileExporterPrivate *const d_ptr;
+		Q_DECLARE_PRIVATE(FileExporter)
+	private:
+		Q_DISABLE_COPY(FileExporter)
+
+	public:
+		/**
+		 * File to export.
+		 * All filenames must be resolved before the export
+		 * is started; existing files will be overwritten.
+		 * For archive exports, filenames are relative
+		 * to the root of the archive.
+		 */
+		struct Job {
+			File *file;
+
+			// Filename for the exported file.
+			QString filename;
+
+			// Filenames for the banner and icon, sans extension.
+			// If empty, the image won't be saved.
+			QString bannerFilenameNoExt;
+			QString iconFilenameNoExt;
+		};
+
+	signals:
+		/**
+		 * Export has started.
+		 * @param totalFiles Number of files being exported.
+		 */
+		void exportStarted(int totalFiles);
+
+		/**
+		 * Update export status.
+		 * @param filesProcessed Number of files processed so far.
+		 * @param totalFiles Number of files being exported.
+		 */
+		void exportUpdate(int filesProcessed, int totalFiles);
+
+		/**
+		 * Export has completed.
+		 * This is also emitted if the export was cancelled.
+		 * @param filesSaved Number of files saved successfully.
+		 * @param totalFiles Number of files that were supposed to be exported.
+		 */
+		void exportFinished(int filesSaved, int totalFiles);
+
+	public:
+		/** Properties. **/
+
+		/**
+		 * Is an export currently running?
+		 * @return True if an export is running; false if not.
+		 */
+		bool isExporting(void) const;
+
+		/**
+		 * Get the animated image format used for animated icons.
+		 * @return Animated image format.
+		 */
+		GcImageWriter::AnimImageFormat animImgf(void) const;
+
+		/**
+		 * Set the animated image format used for animated icons.
+		 * This only takes effect for exports started afterwards.
+		 * @param animImgf Animated image format.
+		 */
+		void setAnimImgf(GcImageWriter::AnimImageFormat animImgf);
+
+	public:
+		/**
+		 * Export files in the background.
+		 *
+		 * File data is read, images are encoded, and the output
+		 * files are written on a thread pool. The File objects
+		 * must not be deleted until exportFinished() is emitted.
+		 *
+		 * @param jobs Files to export.
+		 * @return 0 if the export was started; non-zero on error.
+		 */
+		int exportFiles_async(const QVector<Job> &jobs);
+
+		/**
+		 * Export files to an archive in the background.
+		 *
+		 * File data is read and images are encoded on a thread pool.
+		 * ZIP entries are compressed on the thread pool as well.
+		 * Entries are written to the archive in the order of the
+		 * job list. The archive is discarded if the export is
+		 * cancelled or if the archive can't be written.
+		 *
+		 * @param jobs Files to export.
+		 * @param archiveFilename Archive filename.
+		 * @param format Archive format.
+		 * @param compression Compression method.
+		 * @return 0 if the export was started; non-zero on error.
+		 */
+		int exportToArchive_async(const QVector<Job> &jobs, const QString &archiveFilename,
+			ArchiveWriter::ArchiveFormat format, ArchiveWriter::Compression compression);
+
+		/**
+		 * Cancel the running export.
+		 * Files that are currently being written will be finished.
+		 * exportFinished() is emitted once the export has stopped.
+		 * @param wait If true, wait for the export to stop before returning.
+		 */
+		void cancel(bool wait = false);
+
+	private slots:
+		/**
+		 * A file has been processed.
+		 * NOTE: Called from the worker threads using a queued connection.
+		 * @param ret 0 if the file was saved; non-zero on error.
+		 */
+		void fileProcessed_slot(int ret);
+
+		/**
+		 * A worker task has finished.
+		 * NOTE: Called from the worker threads using a queued connection.
+		 */
+		void taskFinished_slot(void);
+};
+
+#endif /* __MCRECOVER_FILEEXPORTER_HPP__ */
@@ -31,26 +31,90 @@ class VarReplacePrivate
 			}
 			return true;
 		}
+
+		/**
+		 * Parse a variable name as a capture reference. ($Gn, $Fn)
+		 * @param varName	[in] Variable name.
+		 * @param pSource	[out] Variable source. (VarReplace::VarSource_t)
+		 * @param pIndex	[out] Capture index.
+		 * @return True if the name is a capture reference; false if not.
+		 */
+		static bool parseVarRef(const QString &varName, uint8_t *pSource, int *pIndex);
+
+		/**
+		 * Get a variable's value.
+		 * @param source Variable source. (VarReplace::VarSource_t)
+		 * @param index Capture index.
+		 * @param gameDescVars GameDesc variables.
+		 * @param fileDescVars FileDesc variables.
+		 * @return Pointer to the value, or nullptr if the capture isn't present.
+		 */
+		static inline const QString *getVar(uint8_t source, int index,
+			const QStringList &gameDescVars, const QStringList &fileDescVars)
+		{
+			const QStringList &vars = (source == VarReplace::VARSRC_GAMEDESC ? gameDescVars : fileDescVars);
+			return (index < vars.size() ? &vars.at(index) : nullptr);
+		}
+
+		static inline QString *getVar(uint8_t source, int index,
+			QStringList &gameDescVars, QStringList &fileDescVars)
+		{
+			QStringList &vars = (source == VarReplace::VARSRC_GAMEDESC ? gameDescVars : fileDescVars);
+			return (index < vars.size() ? &vars[index] : nullptr);
+		}
 };
 
+/**
+ * Parse a variable name as a capture reference. ($Gn, $Fn)
+ * @param varName	[in] Variable name.
+ * @param pSource	[out] Variable source. (VarReplace::VarSource_t)
+ * @param pIndex	[out] Capture index.
+ * @return True if the name is a capture reference; false if not.
+ */
+bool VarReplacePrivate::parseVarRef(const QString &varName, uint8_t *pSource, int *pIndex)
+{
+	if (varName.size() < 2)
+		return false;
+
+	switch (varName.at(0).unicode()) {
+		case L'G':
+			*pSource = VarReplace::VARSRC_GAMEDESC;
+			break;
+		case L'F':
+			*pSource = VarReplace::VARSRC_FILEDESC;
+			break;
+		default:
+			return false;
+	}
+
+	// Capture index. This must be formatted exactly the
+	// same way as QString::number(), e.g. no leading zeroes.
+	const QString indexStr = varName.mid(1);
+	bool ok;
+	const int index = indexStr.toInt(&ok, 10);
+	if (!ok || index < 0 || QString::number(index) != indexStr)
+		return false;
+
+	*pIndex = index;
+	return true;
+}
+
 /** VarReplace **/
 
 /**
- * Replace variables in a given string.
- * @param str String to replace variables in.
- * @param vars QHash containing variables for replacement.
- *
- * QHash format:
- * - key: variable name
- * - value: variable value
- *
- * @return str with replaced variables.
+ * Compile a template string.
+ * Variable format: $VAR, ${VAR}, $(VAR)
+ * References to anything other than $Gn and $Fn
+ * are kept as literal text.
+ * @param str Template string.
+ * @return Compiled template.
  */
-QString VarReplace::Exec(const QString &str, const QHash<QString, QString> &vars)
+VarReplace::Template VarReplace::Compile(const QString &str)
 {
 	// Variable format: $VAR, ${VAR}, $(VAR)
-	QString workStr;
-	workStr.reserve(str.size() * 3 / 2);
+	Template tmpl;
+	QString workStr;	// Current literal segment.
+	workStr.reserve(str.size());
 
 	// Valid variable name characters: [a-zA-Z_]
 	bool inVar = false;	// True if we're currently processing a variable.
@@ -152,16 +216,32 @@ QString VarReplace::Exec(const QString &str, const QHash<QString, QString> &vars
 					// TODO: Print a warning message.
 					isVarInvalid = true;
 				} else {
-					// Check if the variable is in the QHash.
-					// NOTE: This requires two lookups.
-					// Just get the value instead of checking contains()?
-					if (!vars.contains(varName)) {
-						// Variable is not in the QHash.
+					// Check if the variable is a capture reference.
+					Segment seg;
+					if (!VarReplacePrivate::parseVarRef(varName, &seg.source, &seg.index)) {
+						// Not a capture reference.
 						// TODO: Print a warning message?
 						isVarInvalid = true;
 					} else {
-						// Variable is in the QHash.
-						workStr += vars.value(varName);
+						// Finish the current literal segment.
+						if (!workStr.isEmpty()) {
+							Segment litSeg;
+							litSeg.source = VARSRC_LITERAL;
+							litSeg.index = 0;
+							litSeg.text = workStr;
+							tmpl.append(litSeg);
+							workStr.clear();
+						}
+
+						// Save the original variable reference
+						// in case the capture isn't present.
+						seg.text = QChar(L'$');
+						if (!varDelimStart.isNull())
+							seg.text += varDelimStart;
+						seg.text += varName;
+						if (!varDelimEnd.isNull())
+							seg.text += varDelimEnd;
+						tmpl.append(seg);
 					}
 				}
 
@@ -189,39 +269,79 @@ QString VarReplace::Exec(const QString &str, const QHash<QString, QString> &vars
 		}
 	}
 
-	// Return the processed string.
-	return workStr;
+	// Finish the last literal segment.
+	if (!workStr.isEmpty()) {
+		Segment litSeg;
+		litSeg.source = VARSRC_LITERAL;
+		litSeg.index = 0;
+		litSeg.text = workStr;
+		tmpl.append(litSeg);
+	}
+
+	// Return the compiled template.
+	return tmpl;
+}
+
+/**
+ * Compile variable modifiers.
+ * Modifiers for anything other than $Gn and $Fn are ignored.
+ * @param varModifierDefs Variable modifier definitions. (key == ID)
+ * @return Compiled variable modifiers.
+ */
+VarReplace::Modifiers VarReplace::CompileModifiers(const QHash<QString, VarModifierDef> &varModifierDefs)
+{
+	Modifiers modifiers;
+	modifiers.reserve(varModifierDefs.size());
+
+	const auto iter_end = varModifierDefs.cend();
+	for (auto iter = varModifierDefs.cbegin(); iter != iter_end; ++iter) {
+		Modifier modifier;
+		if (!VarReplacePrivate::parseVarRef(iter.key(), &modifier.source, &modifier.index)) {
+			// Not a capture reference.
+			// TODO: Print a warning message?
+			continue;
+		}
+		modifier.def = iter.value();
+		modifiers.append(modifier);
+	}
+
+	return modifiers;
 }
 
 /**
- * Combine QStringLists of GameDesc variables and FileDesc variables into a QHash.
+ * Replace variables in a compiled template.
+ * @param tmpl Compiled template.
  * @param gameDescVars GameDesc variables.
  * @param fileDescVars FileDesc variables.
- *
- * NOTE: The first variable in each match ($G0, $F0) is
- * the full match from PCRE. This usually won't be used,
- * but is included in the variable hash anyway.
- *
- * @return QHash containing the variables. (key == ID)
+ * @return Template with replaced variables.
  */
-QHash<QString, QString> VarReplace::StringListsToHash(
+QString VarReplace::Exec(const Template &tmpl,
 	const QStringList &gameDescVars,
 	const QStringList &fileDescVars)
 {
-	QHash<QString, QString> vars;
-	QString varName;
-	varName.reserve(4);
-
-	for (int i = gameDescVars.size()-1; i >= 0; i--) {
-		varName = QChar(L'G') + QString::number(i);
-		vars.insert(varName, gameDescVars.at(i));
+	if (tmpl.size() == 1 && tmpl.at(0).source == VARSRC_LITERAL) {
+		// Literal text only. Share the string.
+		return tmpl.at(0).text;
 	}
-	for (int i = fileDescVars.size()-1; i >= 0; i--) {
-		varName = QChar(L'F') + QString::number(i);
-		vars.insert(varName, fileDescVars.at(i));
+
+	QString workStr;
+	workStr.reserve(32);
+
+	const Segment *const pEnd = tmpl.constData() + tmpl.size();
+	for (const Segment *seg = tmpl.constData(); seg != pEnd; seg++) {
+		if (seg->source == VARSRC_LITERAL) {
+			workStr += seg->text;
+			continue;
+		}
+
+		const QString *const var = VarReplacePrivate::getVar(
+			seg->source, seg->index, gameDescVars, fileDescVars);
+		// If the capture isn't present, use the original variable reference.
+		workStr += (var ? *var : seg->text);
 	}
 
-	return vars;
+	// Return the processed string.
+	return workStr;
 }
 
 /**
@@ -286,14 +406,16 @@ int VarReplace::strToInt(const QString &str)
 }
 
 /**
- * Apply variable modifiers to a QHash containing variables.
- * @param varModifierDefs	[in] Variable modifier definitions.
- * @param vars			[in, out] Variables to modify.
- * @param qDateTime		[out, opt] If specified, QDateTime for the timestamp.
+ * Apply compiled variable modifiers.
+ * @param modifiers	[in] Compiled variable modifiers.
+ * @param gameDescVars	[in, out] GameDesc variables to modify.
+ * @param fileDescVars	[in, out] FileDesc variables to modify.
+ * @param qDateTime	[out, opt] If specified, QDateTime for the timestamp.
  * @return 0 on success; non-zero if any modifiers failed.
  */
-int VarReplace::ApplyModifiers(const QHash<QString, VarModifierDef> &varModifierDefs,
-			       QHash<QString, QString> &vars,
+int VarReplace::ApplyModifiers(const Modifiers &modifiers,
+			       QStringList &gameDescVars,
+			       QStringList &fileDescVars,
 			       QDateTime *qDateTime)
 {
 	// Timestamp construction.
@@ -304,13 +426,17 @@ int VarReplace::ApplyModifiers(const QHash<QString, VarModifierDef> &varModifier
 	// TODO: Verify that all variables to be modified
 	// were present in vars.
 
-	QList<QString> varIDs = vars.keys();
-	foreach (const QString &id, varIDs) {
-		if (!varModifierDefs.contains(id))
+	const Modifier *const pEnd = modifiers.constData() + modifiers.size();
+	for (const Modifier *modifier = modifiers.constData(); modifier != pEnd; modifier++) {
+		QString *const pVar = VarReplacePrivate::getVar(
+			modifier->source, modifier->index, gameDescVars, fileDescVars);
+		if (!pVar) {
+			// Capture isn't present in this match.
 			continue;
+		}
 
-		QString var = vars.value(id);
-		const VarModifierDef &varModifierDef = varModifierDefs[id];
+		QString var = *pVar;
+		const VarModifierDef &varModifierDef = modifier->def;
 
 		// Always convert the string to num and char,
 		// in case it's needed for e.g. useAs==month.
@@ -437,8 +563,8 @@ int VarReplace::ApplyModifiers(const QHash<QString, VarModifierDef> &varModifier
 				break;
 		}
 
-		// Update the variable in the hash.
-		vars.insert(id, var);
+		// Update the variable.
+		*pVar = var;
 	}
 
 	if (qDateTime) {
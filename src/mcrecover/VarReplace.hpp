@@ -17,6 +17,8 @@
 #include <QtCore/QDateTime>
 #include <QtCore/QHash>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
 #include <QtCore/QRegularExpression>
 
 class VarReplace
@@ -30,30 +32,82 @@ class VarReplace
 
 	public:
 		/**
-		 * Replace variables in a given string.
-		 * @param str String to replace variables in.
-		 * @param vars QHash containing variables for replacement.
+		 * Variable sources.
+		 * Variables are regex captures from the GameDesc ($Gn)
+		 * and FileDesc ($Fn) search patterns.
 		 *
-		 * QHash format:
-		 * - key: variable name
-		 * - value: variable value
-		 *
-		 * @return str with replaced variables.
+		 * NOTE: The first variable in each match ($G0, $F0) is
+		 * the full match from PCRE. This usually won't be used,
+		 * but it can be referenced anyway.
+		 */
+		enum VarSource_t {
+			VARSRC_LITERAL	= 0,	// Not a variable.
+			VARSRC_GAMEDESC,	// $Gn
+			VARSRC_FILEDESC,	// $Fn
+		};
+
+		/**
+		 * Compiled template segment.
+		 */
+		struct Segment {
+			uint8_t source;		// VarSource_t
+			int index;		// Capture index. (variables only)
+
+			/**
+			 * Literal text.
+			 * For variables, this is the original variable
+			 * reference, which is used if the capture isn't
+			 * present in the match.
+			 */
+			QString text;
+		};
+
+		/**
+		 * Compiled template.
+		 * Segments are concatenated in order.
 		 */
-		static QString Exec(const QString &str, const QHash<QString, QString> &vars);
+		typedef QVector<Segment> Template;
 
 		/**
-		 * Combine QStringLists of GameDesc variables and FileDesc variables into a QHash.
+		 * Compiled variable modifier.
+		 */
+		struct Modifier {
+			uint8_t source;		// VarSource_t
+			int index;		// Capture index.
+			VarModifierDef def;	// Variable modifier definition.
+		};
+
+		/**
+		 * Compiled variable modifiers.
+		 */
+		typedef QVector<Modifier> Modifiers;
+
+		/**
+		 * Compile a template string.
+		 * Variable format: $VAR, ${VAR}, $(VAR)
+		 * References to anything other than $Gn and $Fn
+		 * are kept as literal text.
+		 * @param str Template string.
+		 * @return Compiled template.
+		 */
+		static Template Compile(const QString &str);
+
+		/**
+		 * Compile variable modifiers.
+		 * Modifiers for anything other than $Gn and $Fn are ignored.
+		 * @param varModifierDefs Variable modifier definitions. (key == ID)
+		 * @return Compiled variable modifiers.
+		 */
+		static Modifiers CompileModifiers(const QHash<QString, VarModifierDef> &varModifierDefs);
+
+		/**
+		 * Replace variables in a compiled template.
+		 * @param tmpl Compiled template.
 		 * @param gameDescVars GameDesc variables.
 		 * @param fileDescVars FileDesc variables.
-		 *
-		 * NOTE: The first variable in each match ($G0, $F0) is
-		 * the full match from PCRE. This usually won't be used,
-		 * but is included in the variable hash anyway.
-		 *
-		 * @return QHash containing the variables. (key == ID)
+		 * @return Template with replaced variables.
 		 */
-		static QHash<QString, QString> StringListsToHash(
+		static QString Exec(const Template &tmpl,
 			const QStringList &gameDescVars,
 			const QStringList &fileDescVars);
 
@@ -66,14 +120,16 @@ class VarReplace
 		static int strToInt(const QString &str);
 
 		/**
-		* Apply variable modifiers to a QHash containing variables.
-		* @param varModifierDefs	[in] Variable modifier definitions.
-		* @param vars			[in, out] Variables to modify.
-		* @param qDateTime		[out, opt] If specified, QDateTime for the timestamp.
-		* @return 0 on success; non-zero if any modifiers failed.
-		*/
-		static int ApplyModifiers(const QHash<QString, VarModifierDef> &varModifierDefs,
-					  QHash<QString, QString> &vars,
+		 * Apply compiled variable modifiers.
+		 * @param modifiers	[in] Compiled variable modifiers.
+		 * @param gameDescVars	[in, out] GameDesc variables to modify.
+		 * @param fileDescVars	[in, out] FileDesc variables to modify.
+		 * @param qDateTime	[out, opt] If specified, QDateTime for the timestamp.
+		 * @return 0 on success; non-zero if any modifiers failed.
+		 */
+		static int ApplyModifiers(const Modifiers &modifiers,
+					  QStringList &gameDescVars,
+					  QStringList &fileDescVars,
 					  QDateTime *qDateTime);
 };
 
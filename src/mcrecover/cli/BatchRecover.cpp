@@ -0,0 +1,717 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * BatchRecover.cpp: Headless batch recovery of memory card images.        *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "BatchRecover.hpp"
+
+#include "libmemcard/GcnCard.hpp"
+#include "libmemcard/File.hpp"
+#include "db/GcnSearchWorker.hpp"
+#include "db/GcnCheckFiles.hpp"
+#include "Checksum.hpp"
+
+// C includes.
+#include <stdio.h>
+
+// C includes. (C++ namespace)
+#include <cerrno>
+
+// Qt includes.
+#include <QtCore/QAtomicInt>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QIODevice>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRunnable>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+
+/** BatchRecoverPrivate **/
+
+class BatchRecoverPrivate
+{
+	public:
+		explicit BatchRecoverPrivate(BatchRecover *q);
+
+	protected:
+		BatchRecover *const q_ptr;
+		Q_DECLARE_PUBLIC(BatchRecover)
+	private:
+		Q_DISABLE_COPY(BatchRecoverPrivate)
+
+	public:
+		// Properties.
+		QString outputDir;
+		int jobCount;
+		char preferredRegion;
+		bool searchUsedBlocks;
+		bool exportAllFiles;
+		bool overwrite;
+		bool verbose;
+
+		/**
+		 * Result for a single file.
+		 */
+		struct FileResult {
+			QString gameID;
+			QString filename;
+			QString description;
+			QDateTime mtime;
+			int size;		// Size, in blocks.
+			int startBlock;		// First block, or -1 if unknown.
+			bool lostFile;
+			Checksum::ChkStatus checksumStatus;
+
+			// Export status.
+			// exportFilename is empty if the file wasn't exported.
+			QString exportFilename;
+			QString exportError;
+		};
+
+		/**
+		 * Result for a memory card image.
+		 */
+		struct ImageResult {
+			QString image;		// Memory card image.
+			QString exportDir;	// Export directory. (empty if not exporting)
+
+			int status;		// 0 on success; negative POSIX error code on error.
+			QString error;		// Error message, if status != 0.
+
+			int totalPhysBlocks;
+			int freeBlocks;
+			int lostFilesFound;
+			int filesExported;
+			qint64 elapsedMs;	// Processing time, in milliseconds.
+
+			// Block cache statistics.
+			// Only used if the image isn't memory-mapped.
+			bool memoryMapped;
+			quint64 blockCacheHits;
+			quint64 blockCacheMisses;
+
+			QVector<FileResult> files;
+		};
+
+		// Results from the last run, in image order.
+		QVector<ImageResult> results;
+		// Number of databases used in the last run.
+		int dbCount;
+
+		// Progress messages.
+		QMutex printMutex;
+		int imagesDone;
+
+		/**
+		 * Assign an export subdirectory to each image.
+		 * Subdirectories are named after the images.
+		 * Duplicate names get a numeric suffix.
+		 */
+		void assignExportDirs(void);
+
+		/**
+		 * Scan a memory card image and export the recovered files.
+		 * @param result	[in,out] Image result. (image and exportDir must be set)
+		 * @param databases	[in] Databases to search with.
+		 * @param scanThreads	[in] Number of threads to use for scanning this image.
+		 */
+		void processImage(ImageResult *result, const GcnMcFileDbSnapshot &databases, int scanThreads) const;
+
+		/**
+		 * Print a progress message for a processed image.
+		 * @param result Image result.
+		 */
+		void printResult(const ImageResult *result);
+
+		/**
+		 * Convert a checksum status to a report string.
+		 * @param checksumStatus Checksum status.
+		 * @return Report string.
+		 */
+		static QString checksumStatusToString(Checksum::ChkStatus checksumStatus);
+};
+
+BatchRecoverPrivate::BatchRecoverPrivate(BatchRecover *q)
+	: q_ptr(q)
+	, jobCount(0)
+	, preferredRegion(0)
+	, searchUsedBlocks(false)
+	, exportAllFiles(false)
+	, overwrite(false)
+	, verbose(true)
+	, dbCount(0)
+	, imagesDone(0)
+{ }
+
+/**
+ * Assign an export subdirectory to each image.
+ * Subdirectories are named after the images.
+ * Duplicate names get a numeric suffix.
+ */
+void BatchRecoverPrivate::assignExportDirs(void)
+{
+	if (outputDir.isEmpty())
+		return;
+
+	// NOTE: Names are compared case-insensitively, since
+	// the output directory might be on a case-insensitive
+	// file system.
+	QSet<QString> usedNames;
+	usedNames.reserve(results.size());
+	for (int i = 0; i < results.size(); i++) {
+		ImageResult &result = results[i];
+		const QString baseName = QFileInfo(result.image).completeBaseName();
+		QString name = baseName;
+		for (int suffix = 2; usedNames.contains(name.toLower()); suffix++) {
+			name = baseName + QChar(L'_') + QString::number(suffix);
+		}
+		usedNames.insert(name.toLower());
+		result.exportDir = outputDir + QChar(L'/') + name;
+	}
+}
+
+/**
+ * Scan a memory card image and export the recovered files.
+ * @param result	[in,out] Image result. (image and exportDir must be set)
+ * @param databases	[in] Databases to search with.
+ * @param scanThreads	[in] Number of threads to use for scanning this image.
+ */
+void BatchRecoverPrivate::processImage(ImageResult *result,
+	const GcnMcFileDbSnapshot &databases, int scanThreads) const
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	// Open the memory card image.
+	// NOTE: The card is owned by this thread, so it must
+	// not have a parent object.
+	GcnCard *const card = GcnCard::open(result->image, nullptr);
+	if (!card || !card->isOpen()) {
+		result->status = -EIO;
+		if (card) {
+			result->error = card->errorString();
+		}
+		if (result->error.isEmpty()) {
+			result->error = BatchRecover::tr("Unable to open the memory card image.");
+		}
+		delete card;
+		result->elapsedMs = timer.elapsed();
+		return;
+	}
+
+	result->totalPhysBlocks = card->totalPhysBlocks();
+	result->freeBlocks = card->freeBlocks();
+
+	// Search the card for lost files.
+	// NOTE: searchMemCard() is synchronous, so the worker
+	// doesn't need an event loop.
+	GcnSearchWorker worker;
+	worker.setCard(card);
+	worker.setDatabases(databases);
+	worker.setPreferredRegion(preferredRegion);
+	worker.setSearchUsedBlocks(searchUsedBlocks);
+	worker.setThreadCount(scanThreads);
+	int ret = worker.searchMemCard();
+	if (ret < 0) {
+		result->status = ret;
+		result->error = worker.errorString();
+		delete card;
+		result->elapsedMs = timer.elapsed();
+		return;
+	}
+	card->addLostFiles(worker.filesFoundList());
+
+	// Check the checksums of the files in the directory.
+	// Lost files already have checksum definitions.
+	GcnCheckFiles checkFiles;
+	checkFiles.setThreadCount(scanThreads);
+	if (checkFiles.loadDatabases() == 0) {
+		checkFiles.addChecksumDefs(card);
+	}
+
+	// Create the export directory.
+	bool canExport = false;
+	if (!result->exportDir.isEmpty()) {
+		canExport = QDir().mkpath(result->exportDir);
+		if (!canExport) {
+			result->status = -EIO;
+			result->error = BatchRecover::tr("Unable to create the export directory %1.")
+				.arg(QDir::toNativeSeparators(result->exportDir));
+		}
+	}
+
+	const QVector<File*> files = card->getFiles(Card::FTYPE_ALL);
+	result->files.reserve(files.size());
+
+	// Lost files may have the same default export filename,
+	// so files with duplicate filenames get a number appended.
+	QSet<QString> usedFilenames;
+	usedFilenames.reserve(files.size());
+
+	foreach (File *file, files) {
+		FileResult fileResult;
+		fileResult.gameID = file->gameID();
+		fileResult.filename = file->filename();
+		fileResult.description = file->description();
+		fileResult.mtime = file->mtime();
+		fileResult.size = file->size();
+		const QVector<uint16_t> fatEntries = file->fatEntries();
+		fileResult.startBlock = (!fatEntries.isEmpty() ? fatEntries.at(0) : -1);
+		fileResult.lostFile = file->isLostFile();
+		fileResult.checksumStatus = file->checksumStatus();
+		if (fileResult.lostFile) {
+			result->lostFilesFound++;
+		}
+
+		if (canExport && (fileResult.lostFile || exportAllFiles)) {
+			QString exportFilename = file->defaultExportFilename();
+			if (usedFilenames.contains(exportFilename.toLower())) {
+				// Append a number before the file extension.
+				const int dotPos = exportFilename.lastIndexOf(QChar(L'.'));
+				const QString base = (dotPos > 0 ? exportFilename.left(dotPos) : exportFilename);
+				const QString ext = (dotPos > 0 ? exportFilename.mid(dotPos) : QString());
+				int i = 2;
+				do {
+					exportFilename = base + QString(QLatin1String(" (%1)")).arg(i++) + ext;
+				} while (usedFilenames.contains(exportFilename.toLower()));
+			}
+			usedFilenames.insert(exportFilename.toLower());
+
+			const QString filename = result->exportDir + QChar(L'/') + exportFilename;
+			if (!overwrite && QFile::exists(filename)) {
+				// Don't overwrite existing files.
+				fileResult.exportError = BatchRecover::tr("File already exists.");
+			} else if (file->exportToFile(filename) != 0) {
+				// TODO: Error details.
+				fileResult.exportError = BatchRecover::tr("Unable to write the file.");
+			} else {
+				// File exported successfully.
+				fileResult.exportFilename = filename;
+				result->filesExported++;
+			}
+		}
+
+		result->files.append(fileResult);
+	}
+
+	result->memoryMapped = card->isMemoryMapped();
+	result->blockCacheHits = card->blockCacheHits();
+	result->blockCacheMisses = card->blockCacheMisses();
+
+	delete card;
+	result->elapsedMs = timer.elapsed();
+}
+
+/**
+ * Print a progress message for a processed image.
+ * @param result Image result.
+ */
+void BatchRecoverPrivate::printResult(const ImageResult *result)
+{
+	QMutexLocker locker(&printMutex);
+	imagesDone++;
+	if (!verbose)
+		return;
+
+	QString msg = QLatin1String("[") + QString::number(imagesDone) +
+		      QChar(L'/') + QString::number(results.size()) +
+		      QLatin1String("] ") + QDir::toNativeSeparators(result->image) +
+		      QLatin1String(": ");
+	if (result->status != 0) {
+		msg += BatchRecover::tr("ERROR: %1").arg(result->error);
+	} else if (!result->exportDir.isEmpty()) {
+		msg += BatchRecover::tr("%Ln lost file(s) found", "", result->lostFilesFound) +
+		       QLatin1String(", ") +
+		       BatchRecover::tr("%Ln file(s) exported", "", result->filesExported);
+	} else {
+		msg += BatchRecover::tr("%Ln lost file(s) found", "", result->lostFilesFound);
+	}
+	msg += QChar(L'\n');
+
+	fputs(msg.toLocal8Bit().constData(), stderr);
+}
+
+/**
+ * Convert a checksum status to a report string.
+ * @param checksumStatus Checksum status.
+ * @return Report string.
+ */
+QString BatchRecoverPrivate::checksumStatusToString(Checksum::ChkStatus checksumStatus)
+{
+	switch (checksumStatus) {
+		case Checksum::CHKST_GOOD:
+			return QLatin1String("good");
+		case Checksum::CHKST_INVALID:
+			return QLatin1String("invalid");
+		default:
+		case Checksum::CHKST_UNKNOWN:
+			return QLatin1String("unknown");
+	}
+}
+
+/** BatchRecoverTask **/
+
+/**
+ * Image processing task.
+ * Each task processes images until there are no images left.
+ */
+class BatchRecoverTask : public QRunnable
+{
+	public:
+		BatchRecoverTask(BatchRecoverPrivate *d,
+				 BatchRecoverPrivate::ImageResult *results, int totalImages,
+				 const GcnMcFileDbSnapshot &databases,
+				 int scanThreads, QAtomicInt &nextIdx)
+			: d(d)
+			, results(results)
+			, totalImages(totalImages)
+			, databases(databases)
+			, scanThreads(scanThreads)
+			, nextIdx(nextIdx)
+		{ }
+
+	private:
+		Q_DISABLE_COPY(BatchRecoverTask)
+
+	public:
+		void run(void) final;
+
+	private:
+		BatchRecoverPrivate *const d;
+		// NOTE: Each task only writes to the results it claims.
+		BatchRecoverPrivate::ImageResult *const results;
+		const int totalImages;
+		const GcnMcFileDbSnapshot &databases;
+		const int scanThreads;
+		QAtomicInt &nextIdx;
+};
+
+void BatchRecoverTask::run(void)
+{
+	for (int idx = nextIdx.fetchAndAddRelaxed(1); idx < totalImages;
+	     idx = nextIdx.fetchAndAddRelaxed(1))
+	{
+		d->processImage(&results[idx], databases, scanThreads);
+		d->printResult(&results[idx]);
+	}
+}
+
+/** BatchRecover **/
+
+BatchRecover::BatchRecover()
+	: d_ptr(new BatchRecoverPrivate(this))
+{ }
+
+BatchRecover::~BatchRecover()
+{
+	Q_D(BatchRecover);
+	delete d;
+}
+
+/** Properties. **/
+
+/**
+ * Get the output directory.
+ * @return Output directory. (If empty, files won't be exported.)
+ */
+QString BatchRecover::outputDir(void) const
+{
+	Q_D(const BatchRecover);
+	return d->outputDir;
+}
+
+/**
+ * Set the output directory.
+ * Files from each image are exported to a subdirectory
+ * named after the image.
+ * @param outputDir Output directory. (If empty, files won't be exported.)
+ */
+void BatchRecover::setOutputDir(const QString &outputDir)
+{
+	Q_D(BatchRecover);
+	d->outputDir = outputDir;
+}
+
+/**
+ * Get the number of images to process at the same time.
+ * @return Number of jobs. (If 0, QThread::idealThreadCount() will be used.)
+ */
+int BatchRecover::jobCount(void) const
+{
+	Q_D(const BatchRecover);
+	return d->jobCount;
+}
+
+/**
+ * Set the number of images to process at the same time.
+ * @param jobCount Number of jobs. (If 0, QThread::idealThreadCount() will be used.)
+ */
+void BatchRecover::setJobCount(int jobCount)
+{
+	Q_D(BatchRecover);
+	d->jobCount = (jobCount >= 0 ? jobCount : 0);
+}
+
+/**
+ * Get the preferred region.
+ * @return Preferred region.
+ */
+char BatchRecover::preferredRegion(void) const
+{
+	Q_D(const BatchRecover);
+	return d->preferredRegion;
+}
+
+/**
+ * Set the preferred region.
+ * @param preferredRegion Preferred region.
+ */
+void BatchRecover::setPreferredRegion(char preferredRegion)
+{
+	Q_D(BatchRecover);
+	d->preferredRegion = preferredRegion;
+}
+
+/**
+ * Should used blocks be searched?
+ * @return True if used blocks should be searched.
+ */
+bool BatchRecover::searchUsedBlocks(void) const
+{
+	Q_D(const BatchRecover);
+	return d->searchUsedBlocks;
+}
+
+/**
+ * Set whether used blocks should be searched.
+ * @param searchUsedBlocks True if used blocks should be searched.
+ */
+void BatchRecover::setSearchUsedBlocks(bool searchUsedBlocks)
+{
+	Q_D(BatchRecover);
+	d->searchUsedBlocks = searchUsedBlocks;
+}
+
+/**
+ * Should files in the directory be exported in addition to lost files?
+ * @return True if all files should be exported.
+ */
+bool BatchRecover::exportAllFiles(void) const
+{
+	Q_D(const BatchRecover);
+	return d->exportAllFiles;
+}
+
+/**
+ * Set whether files in the directory should be exported in addition to lost files.
+ * @param exportAllFiles True if all files should be exported.
+ */
+void BatchRecover::setExportAllFiles(bool exportAllFiles)
+{
+	Q_D(BatchRecover);
+	d->exportAllFiles = exportAllFiles;
+}
+
+/**
+ * Should existing files be overwritten?
+ * @return True if existing files should be overwritten.
+ */
+bool BatchRecover::overwrite(void) const
+{
+	Q_D(const BatchRecover);
+	return d->overwrite;
+}
+
+/**
+ * Set whether existing files should be overwritten.
+ * If false, existing files are skipped and reported as such.
+ * @param overwrite True if existing files should be overwritten.
+ */
+void BatchRecover::setOverwrite(bool overwrite)
+{
+	Q_D(BatchRecover);
+	d->overwrite = overwrite;
+}
+
+/**
+ * Should progress messages be printed to stderr?
+ * @return True if progress messages should be printed.
+ */
+bool BatchRecover::verbose(void) const
+{
+	Q_D(const BatchRecover);
+	return d->verbose;
+}
+
+/**
+ * Set whether progress messages should be printed to stderr.
+ * @param verbose True if progress messages should be printed.
+ */
+void BatchRecover::setVerbose(bool verbose)
+{
+	Q_D(BatchRecover);
+	d->verbose = verbose;
+}
+
+/**
+ * Scan memory card images and export the recovered files.
+ * Images are processed in parallel.
+ * @param images Memory card images.
+ * @param databases Databases to search with.
+ * @return Number of images that couldn't be processed.
+ */
+int BatchRecover::run(const QStringList &images, const GcnMcFileDbSnapshot &databases)
+{
+	Q_D(BatchRecover);
+	d->results.clear();
+	d->dbCount = databases.size();
+	d->imagesDone = 0;
+	if (images.isEmpty())
+		return 0;
+
+	d->results.resize(images.size());
+	for (int i = 0; i < images.size(); i++) {
+		BatchRecoverPrivate::ImageResult &result = d->results[i];
+		result.image = images.at(i);
+		result.status = 0;
+		result.totalPhysBlocks = 0;
+		result.freeBlocks = 0;
+		result.lostFilesFound = 0;
+		result.filesExported = 0;
+		result.elapsedMs = 0;
+		result.memoryMapped = false;
+		result.blockCacheHits = 0;
+		result.blockCacheMisses = 0;
+	}
+	d->assignExportDirs();
+
+	// Determine the number of jobs.
+	// If there are fewer images than CPUs, each image
+	// is scanned using multiple threads.
+	const int idealThreadCount = QThread::idealThreadCount();
+	int jobCount = (d->jobCount > 0 ? d->jobCount : idealThreadCount);
+	if (jobCount > images.size()) {
+		jobCount = images.size();
+	}
+	if (jobCount < 1) {
+		jobCount = 1;
+	}
+	int scanThreads = idealThreadCount / jobCount;
+	if (scanThreads < 1) {
+		scanThreads = 1;
+	}
+
+	BatchRecoverPrivate::ImageResult *const pResults = d->results.data();
+	QAtomicInt nextIdx(0);
+	QThreadPool threadPool;
+	threadPool.setMaxThreadCount(jobCount);
+	for (int i = jobCount; i > 0; i--) {
+		// NOTE: QThreadPool deletes the task when it's done.
+		threadPool.start(new BatchRecoverTask(d, pResults, images.size(),
+			databases, scanThreads, nextIdx));
+	}
+	threadPool.waitForDone();
+
+	int failed = 0;
+	foreach (const BatchRecoverPrivate::ImageResult &result, d->results) {
+		if (result.status != 0) {
+			failed++;
+		}
+	}
+	return failed;
+}
+
+/**
+ * Write a machine-readable report of the last run.
+ * The report is in JSON format.
+ * @param qioDevice QIODevice to write to.
+ * @return 0 on success; negative POSIX error code on error.
+ */
+int BatchRecover::writeReport(QIODevice *qioDevice) const
+{
+	Q_D(const BatchRecover);
+
+	QJsonArray jsonImages;
+	int failed = 0, lostFilesFound = 0, filesExported = 0;
+	foreach (const BatchRecoverPrivate::ImageResult &result, d->results) {
+		QJsonObject jsonImage;
+		jsonImage.insert(QLatin1String("image"), result.image);
+		jsonImage.insert(QLatin1String("status"),
+			QLatin1String(result.status == 0 ? "ok" : "error"));
+		if (result.status != 0) {
+			jsonImage.insert(QLatin1String("error"), result.error);
+			failed++;
+		}
+		if (!result.exportDir.isEmpty()) {
+			jsonImage.insert(QLatin1String("exportDir"), result.exportDir);
+		}
+		jsonImage.insert(QLatin1String("totalBlocks"), result.totalPhysBlocks);
+		jsonImage.insert(QLatin1String("freeBlocks"), result.freeBlocks);
+		jsonImage.insert(QLatin1String("lostFilesFound"), result.lostFilesFound);
+		jsonImage.insert(QLatin1String("filesExported"), result.filesExported);
+		jsonImage.insert(QLatin1String("elapsedMs"), (double)result.elapsedMs);
+		if (result.status == 0 && !result.memoryMapped) {
+			QJsonObject jsonBlockCache;
+			jsonBlockCache.insert(QLatin1String("hits"), (double)result.blockCacheHits);
+			jsonBlockCache.insert(QLatin1String("misses"), (double)result.blockCacheMisses);
+			jsonImage.insert(QLatin1String("blockCache"), jsonBlockCache);
+		}
+		lostFilesFound += result.lostFilesFound;
+		filesExported += result.filesExported;
+
+		QJsonArray jsonFiles;
+		foreach (const BatchRecoverPrivate::FileResult &fileResult, result.files) {
+			QJsonObject jsonFile;
+			jsonFile.insert(QLatin1String("gameID"), fileResult.gameID);
+			jsonFile.insert(QLatin1String("filename"), fileResult.filename);
+			jsonFile.insert(QLatin1String("description"), fileResult.description);
+			jsonFile.insert(QLatin1String("mtime"), fileResult.mtime.toString(Qt::ISODate));
+			jsonFile.insert(QLatin1String("size"), fileResult.size);
+			jsonFile.insert(QLatin1String("startBlock"), fileResult.startBlock);
+			jsonFile.insert(QLatin1String("lost"), fileResult.lostFile);
+			jsonFile.insert(QLatin1String("checksum"),
+				BatchRecoverPrivate::checksumStatusToString(fileResult.checksumStatus));
+			if (!fileResult.exportFilename.isEmpty()) {
+				jsonFile.insert(QLatin1String("exported"), fileResult.exportFilename);
+			}
+			if (!fileResult.exportError.isEmpty()) {
+				jsonFile.insert(QLatin1String("exportError"), fileResult.exportError);
+			}
+			jsonFiles.append(jsonFile);
+		}
+		jsonImage.insert(QLatin1String("files"), jsonFiles);
+
+		jsonImages.append(jsonImage);
+	}
+
+	QJsonObject jsonSummary;
+	jsonSummary.insert(QLatin1String("images"), d->results.size());
+	jsonSummary.insert(QLatin1String("failed"), failed);
+	jsonSummary.insert(QLatin1String("lostFilesFound"), lostFilesFound);
+	jsonSummary.insert(QLatin1String("filesExported"), filesExported);
+
+	QJsonObject jsonReport;
+	jsonReport.insert(QLatin1String("version"), QCoreApplication::applicationVersion());
+	jsonReport.insert(QLatin1String("databases"), d->dbCount);
+	jsonReport.insert(QLatin1String("summary"), jsonSummary);
+	jsonReport.insert(QLatin1String("images"), jsonImages);
+
+	const QByteArray json = QJsonDocument(jsonReport).toJson();
+	if (qioDevice->write(json) != json.size()) {
+		return -EIO;
+	}
+	return 0;
+}
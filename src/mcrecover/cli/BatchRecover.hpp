@@ -0,0 +1,147 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * BatchRecover.hpp: Headless batch recovery of memory card images.        *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __MCRECOVER_CLI_BATCHRECOVER_HPP__
+#define __MCRECOVER_CLI_BATCHRECOVER_HPP__
+
+// GCN Memory Card File Database manager.
+#include "db/GcnMcFileDbManager.hpp"
+
+// Qt includes.
+#include <QtCore/QCoreApplication>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+// Qt classes.
+class QIODevice;
+
+class BatchRecoverPrivate;
+class BatchRecover
+{
+	Q_DECLARE_TR_FUNCTIONS(BatchRecover)
+
+	public:
+		BatchRecover();
+		~BatchRecover();
+
+	protected:
+		BatchRecoverPrivate *const d_ptr;
+		Q_DECLARE_PRIVATE(BatchRecover)
+	private:
+		Q_DISABLE_COPY(BatchRecover)
+
+	public:
+		/** Properties. **/
+
+		/**
+		 * Get the output directory.
+		 * @return Output directory. (If empty, files won't be exported.)
+		 */
+		QString outputDir(void) const;
+
+		/**
+		 * Set the output directory.
+		 * Files from each image are exported to a subdirectory
+		 * named after the image.
+		 * @param outputDir Output directory. (If empty, files won't be exported.)
+		 */
+		void setOutputDir(const QString &outputDir);
+
+		/**
+		 * Get the number of images to process at the same time.
+		 * @return Number of jobs. (If 0, QThread::idealThreadCount() will be used.)
+		 */
+		int jobCount(void) const;
+
+		/**
+		 * Set the number of images to process at the same time.
+		 * @param jobCount Number of jobs. (If 0, QThread::idealThreadCount() will be used.)
+		 */
+		void setJobCount(int jobCount);
+
+		/**
+		 * Get the preferred region.
+		 * @return Preferred region.
+		 */
+		char preferredRegion(void) const;
+
+		/**
+		 * Set the preferred region.
+		 * @param preferredRegion Preferred region.
+		 */
+		void setPreferredRegion(char preferredRegion);
+
+		/**
+		 * Should used blocks be searched?
+		 * @return True if used blocks should be searched.
+		 */
+		bool searchUsedBlocks(void) const;
+
+		/**
+		 * Set whether used blocks should be searched.
+		 * @param searchUsedBlocks True if used blocks should be searched.
+		 */
+		void setSearchUsedBlocks(bool searchUsedBlocks);
+
+		/**
+		 * Should files in the directory be exported in addition to lost files?
+		 * @return True if all files should be exported.
+		 */
+		bool exportAllFiles(void) const;
+
+		/**
+		 * Set whether files in the directory should be exported in addition to lost files.
+		 * @param exportAllFiles True if all files should be exported.
+		 */
+		void setExportAllFiles(bool exportAllFiles);
+
+		/**
+		 * Should existing files be overwritten?
+		 * @return True if existing files should be overwritten.
+		 */
+		bool overwrite(void) const;
+
+		/**
+		 * Set whether existing files should be overwritten.
+		 * If false, existing files are skipped and reported as such.
+		 * @param overwrite True if existing files should be overwritten.
+		 */
+		void setOverwrite(bool overwrite);
+
+		/**
+		 * Should progress messages be printed to stderr?
+		 * @return True if progress messages should be printed.
+		 */
+		bool verbose(void) const;
+
+		/**
+		 * Set whether progress messages should be printed to stderr.
+		 * @param verbose True if progress messages should be printed.
+		 */
+		void setVerbose(bool verbose);
+
+	public:
+		/**
+		 * Scan memory card images and export the recovered files.
+		 * Images are processed in parallel.
+		 * @param images Memory card images.
+		 * @param databases Databases to search with.
+		 * @return Number of images that couldn't be processed.
+		 */
+		int run(const QStringList &images, const GcnMcFileDbSnapshot &databases);
+
+		/**
+		 * Write a machine-readable report of the last run.
+		 * The report is in JSON format.
+		 * @param qioDevice QIODevice to write to.
+		 * @return 0 on success; negative POSIX error code on error.
+		 */
+		int writeReport(QIODevice *qioDevice) const;
+};
+
+#endif /* __MCRECOVER_CLI_BATCHRECOVER_HPP__ */
@@ -0,0 +1,262 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * mcrecover-cli.cpp: Headless batch recovery program.                     *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "config.mcrecover.h"
+#include "BatchRecover.hpp"
+#include "db/GcnMcFileDbManager.hpp"
+#include "libmemcard/Card.hpp"
+
+// C includes.
+#include <stdio.h>
+#include <stdlib.h>
+
+// Qt includes.
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QDirIterator>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+
+/**
+ * Print a message to stderr.
+ * @param msg Message.
+ */
+static void printErr(const QString &msg)
+{
+	fputs(msg.toLocal8Bit().constData(), stderr);
+	fputc('\n', stderr);
+}
+
+/**
+ * Add memory card images from a directory.
+ * @param images	[in,out] List of images.
+ * @param path		[in] Directory.
+ * @param recursive	[in] If true, search subdirectories.
+ */
+static void addImagesFromDir(QStringList &images, const QString &path, bool recursive)
+{
+	// NOTE: Name filters are case-insensitive by default.
+	QStringList dirImages;
+	QDirIterator iter(path, QStringList(QLatin1String("*.raw")), QDir::Files,
+		(recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags));
+	while (iter.hasNext()) {
+		dirImages.append(iter.next());
+	}
+
+	// Process images in a consistent order.
+	dirImages.sort();
+	images += dirImages;
+}
+
+/**
+ * Add memory card images from a list file.
+ * Each line contains one image or directory.
+ * Empty lines and lines starting with '#' are ignored.
+ * @param images	[in,out] List of images.
+ * @param listFile	[in] List file. ("-" for stdin)
+ * @param recursive	[in] If true, search subdirectories.
+ * @return 0 on success; non-zero on error.
+ */
+static int addImagesFromList(QStringList &images, const QString &listFile, bool recursive)
+{
+	QFile file;
+	bool isOpen;
+	if (listFile == QLatin1String("-")) {
+		isOpen = file.open(stdin, QIODevice::ReadOnly | QIODevice::Text);
+	} else {
+		file.setFileName(listFile);
+		isOpen = file.open(QIODevice::ReadOnly | QIODevice::Text);
+	}
+	if (!isOpen)
+		return -1;
+
+	QTextStream ts(&file);
+	while (!ts.atEnd()) {
+		const QString line = ts.readLine().trimmed();
+		if (line.isEmpty() || line.startsWith(QChar(L'#')))
+			continue;
+
+		const QString path = QDir::fromNativeSeparators(line);
+		if (QFileInfo(path).isDir()) {
+			addImagesFromDir(images, path, recursive);
+		} else {
+			images.append(path);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Main entry point.
+ * @param argc Number of arguments.
+ * @param argv Array of arguments.
+ * @return 0 if all images were processed; 1 if any images failed; 2 on usage errors.
+ */
+int main(int argc, char *argv[])
+{
+	// NOTE: QCoreApplication is used so a display server isn't needed.
+	// The organization and application names must match the GUI
+	// so the same configuration directory is used.
+	QCoreApplication app(argc, argv);
+	QCoreApplication::setOrganizationName(QLatin1String("GerbilSoft"));
+	QCoreApplication::setApplicationName(QLatin1String("GCN MemCard Recover"));
+	QCoreApplication::setApplicationVersion(QString::fromLatin1(MCRECOVER_VERSION_STRING));
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription(BatchRecover::tr(
+		"Recover lost files from GameCube memory card images.\n"
+		"Each image's files are exported to a subdirectory of the output directory."));
+	parser.addHelpOption();
+	parser.addVersionOption();
+	parser.addPositionalArgument(QLatin1String("images"),
+		BatchRecover::tr("Memory card images or directories containing *.raw images."),
+		QLatin1String("[images...]"));
+
+	const QCommandLineOption outputOption(QStringList() << QLatin1String("o") << QLatin1String("output"),
+		BatchRecover::tr("Export recovered files to <dir>."), QLatin1String("dir"));
+	const QCommandLineOption reportOption(QStringList() << QLatin1String("report"),
+		BatchRecover::tr("Write a JSON report to <file>. (\"-\" for stdout; default is report.json in the output directory)"),
+		QLatin1String("file"));
+	const QCommandLineOption listOption(QStringList() << QLatin1String("l") << QLatin1String("list"),
+		BatchRecover::tr("Read images or directories from <file>, one per line. (\"-\" for stdin)"),
+		QLatin1String("file"));
+	const QCommandLineOption recursiveOption(QStringList() << QLatin1String("r") << QLatin1String("recursive"),
+		BatchRecover::tr("Search directories recursively."));
+	const QCommandLineOption jobsOption(QStringList() << QLatin1String("j") << QLatin1String("jobs"),
+		BatchRecover::tr("Process <n> images at the same time. (default is the number of CPUs)"),
+		QLatin1String("n"));
+	const QCommandLineOption regionOption(QStringList() << QLatin1String("region"),
+		BatchRecover::tr("Preferred region for files found in multiple regions. (E, P, J, K)"),
+		QLatin1String("region"), QLatin1String("E"));
+	const QCommandLineOption usedBlocksOption(QStringList() << QLatin1String("search-used-blocks"),
+		BatchRecover::tr("Search used blocks in addition to free blocks."));
+	const QCommandLineOption allOption(QStringList() << QLatin1String("a") << QLatin1String("all"),
+		BatchRecover::tr("Export all files, not just lost files."));
+	const QCommandLineOption overwriteOption(QStringList() << QLatin1String("overwrite"),
+		BatchRecover::tr("Overwrite existing files."));
+	const QCommandLineOption noMmapOption(QStringList() << QLatin1String("no-mmap"),
+		BatchRecover::tr("Read images with file I/O instead of memory-mapping them."));
+	const QCommandLineOption quietOption(QStringList() << QLatin1String("q") << QLatin1String("quiet"),
+		BatchRecover::tr("Don't print progress messages."));
+	parser.addOption(outputOption);
+	parser.addOption(reportOption);
+	parser.addOption(listOption);
+	parser.addOption(recursiveOption);
+	parser.addOption(jobsOption);
+	parser.addOption(regionOption);
+	parser.addOption(usedBlocksOption);
+	parser.addOption(allOption);
+	parser.addOption(overwriteOption);
+	parser.addOption(noMmapOption);
+	parser.addOption(quietOption);
+	parser.process(app);
+
+	// Get the list of images.
+	const bool recursive = parser.isSet(recursiveOption);
+	QStringList images;
+	foreach (const QString &arg, parser.positionalArguments()) {
+		const QString path = QDir::fromNativeSeparators(arg);
+		if (QFileInfo(path).isDir()) {
+			addImagesFromDir(images, path, recursive);
+		} else {
+			images.append(path);
+		}
+	}
+	if (parser.isSet(listOption)) {
+		const QString listFile = parser.value(listOption);
+		if (addImagesFromList(images, listFile, recursive) != 0) {
+			printErr(BatchRecover::tr("Unable to open the list file %1.").arg(listFile));
+			return 2;
+		}
+	}
+	if (images.isEmpty()) {
+		printErr(BatchRecover::tr("No memory card images were specified."));
+		parser.showHelp(2);
+	}
+
+	// Determine where the report should be written.
+	const QString outputDir = QDir::fromNativeSeparators(parser.value(outputOption));
+	QString reportFile = parser.value(reportOption);
+	if (reportFile.isEmpty()) {
+		if (outputDir.isEmpty()) {
+			printErr(BatchRecover::tr("Either --output or --report must be specified."));
+			return 2;
+		}
+		reportFile = outputDir + QLatin1String("/report.json");
+	}
+
+	BatchRecover batchRecover;
+	batchRecover.setOutputDir(outputDir);
+	if (parser.isSet(jobsOption)) {
+		bool ok;
+		const int jobCount = parser.value(jobsOption).toInt(&ok);
+		if (!ok || jobCount <= 0) {
+			printErr(BatchRecover::tr("Invalid job count: %1").arg(parser.value(jobsOption)));
+			return 2;
+		}
+		batchRecover.setJobCount(jobCount);
+	}
+	// Region codes match the GCN game ID region byte.
+	const QString region = parser.value(regionOption).toUpper();
+	if (region.size() != 1 || !QString(QLatin1String("EPJK")).contains(region.at(0))) {
+		printErr(BatchRecover::tr("Invalid region: %1").arg(parser.value(regionOption)));
+		return 2;
+	}
+	batchRecover.setPreferredRegion(region.at(0).toLatin1());
+	batchRecover.setSearchUsedBlocks(parser.isSet(usedBlocksOption));
+	batchRecover.setExportAllFiles(parser.isSet(allOption));
+	batchRecover.setOverwrite(parser.isSet(overwriteOption));
+	batchRecover.setVerbose(!parser.isSet(quietOption));
+	if (parser.isSet(noMmapOption)) {
+		// Blocks will be read using QFile::read() and cached.
+		Card::setDefaultMemoryMapped(false);
+	}
+
+	// Load the databases.
+	const GcnMcFileDbSnapshot databases = GcnMcFileDbManager::instance()->snapshot();
+	if (databases.isEmpty()) {
+#ifdef Q_OS_WIN
+		printErr(BatchRecover::tr(
+			"No GCN MemCard file databases were found.\n"
+			"The database files should be located in the data subdirectory in\n"
+			"mcrecover.exe's program directory."));
+#else
+		printErr(BatchRecover::tr(
+			"No GCN MemCard file databases were found.\n"
+			"The database files should be located in %1.\n"
+			"Alternatively, you can place your own version in ~/.config/mcrecover/data/")
+			.arg(QLatin1String(MCRECOVER_DATA_DIRECTORY)));
+#endif
+		return 2;
+	}
+
+	// Process the images.
+	const int failed = batchRecover.run(images, databases);
+
+	// Write the report.
+	QFile report;
+	bool isOpen;
+	if (reportFile == QLatin1String("-")) {
+		isOpen = report.open(stdout, QIODevice::WriteOnly);
+	} else {
+		QDir().mkpath(QFileInfo(reportFile).absolutePath());
+		report.setFileName(reportFile);
+		isOpen = report.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	}
+	if (!isOpen || batchRecover.writeReport(&report) != 0) {
+		printErr(BatchRecover::tr("Unable to write the report to %1.").arg(reportFile));
+		return 1;
+	}
+	report.close();
+
+	return (failed == 0 ? 0 : 1);
+}
@@ -43,6 +43,7 @@ class ConfigStorePrivate
 	public:
 		/**
 		* Initialize the configuration path.
+		* NOTE: ConfigPathMutex must be locked by the caller.
 		*/
 		static void InitConfigPath(void);
 
@@ -73,7 +74,11 @@ class ConfigStorePrivate
 		/** Internal variables. **/
 
 		// Configuration path.
+		// NOTE: The database loader may call ConfigStore::ConfigPath()
+		// from a worker thread, so ConfigPathMutex must be locked when
+		// initializing the configuration path.
 		static QString ConfigPath;
+		static QMutex ConfigPathMutex;
 
 		// Current settings.
 		// TODO: Use const char* for the key instead of QString?
@@ -98,18 +103,20 @@ class ConfigStorePrivate
 /** ConfigStorePrivate **/
 
 QString ConfigStorePrivate::ConfigPath;
+QMutex ConfigStorePrivate::ConfigPathMutex;
 
 ConfigStorePrivate::ConfigStorePrivate(ConfigStore* q)
 	: q_ptr(q)
 {
 	// Determine the configuration path.
-	// TODO: Use a mutex?
+	QMutexLocker locker(&ConfigPathMutex);
 	if (ConfigPath.isEmpty())
 		InitConfigPath();
 }
 
 /**
  * Initialize the configuration path.
+ * NOTE: ConfigPathMutex must be locked by the caller.
  */
 void ConfigStorePrivate::InitConfigPath(void)
 {
@@ -389,6 +396,7 @@ int ConfigStore::getInt(const QString &key) const
  */
 QString ConfigStore::ConfigPath(void)
 {
+	QMutexLocker locker(&ConfigStorePrivate::ConfigPathMutex);
 	if (ConfigStorePrivate::ConfigPath.isEmpty())
 		ConfigStorePrivate::InitConfigPath();
 	return ConfigStorePrivate::ConfigPath;
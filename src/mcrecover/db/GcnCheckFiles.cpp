@@ -14,19 +14,25 @@
 
 // GCN Memory Card File Database.
 #include "db/GcnMcFileDb.hpp"
+#include "db/GcnMcFileDbManager.hpp"
 
 // Checksum algorithm class.
 #include "libgctools/Checksum.hpp"
 
+// C includes. (C++ namespace)
+#include <cstring>
+
 // Qt includes.
+#include <QtCore/QAtomicInt>
+#include <QtCore/QRunnable>
 #include <QtCore/QStack>
 #include <QtCore/QThread>
+#include <QtCore/QThreadPool>
 
 class GcnCheckFilesPrivate
 {
 	public:
 		explicit GcnCheckFilesPrivate(GcnCheckFiles *q);
-		~GcnCheckFilesPrivate();
 
 	protected:
 		GcnCheckFiles *const q_ptr;
@@ -36,16 +42,102 @@ class GcnCheckFilesPrivate
 
 	public:
 		// GCN Memory Card File databases.
-		QVector<GcnMcFileDb*> dbs;
+		GcnMcFileDbSnapshot dbs;
+
+		// Number of threads to use for checksum calculation.
+		// If 0, QThread::idealThreadCount() will be used.
+		int threadCount;
+
+		/**
+		 * Checksum calculation job for a single file.
+		 */
+		struct ChecksumJob {
+			GcnFile *file;
+			QVector<Checksum::ChecksumDef> checksumDefs;
+		};
+
+		/**
+		 * Card data for checksum calculation.
+		 * Each physical block is stored once.
+		 */
+		struct CardBlockData {
+			QByteArray data;		// Block data.
+			QVector<int> blockOffsets;	// Offset in data, indexed by physical block.
+			int blockSize;
+		};
+
+		/**
+		 * Calculate the checksums for a file using the preloaded card data.
+		 * @param job Checksum job.
+		 * @param cardData Card block data.
+		 */
+		static void runChecksumJob(const ChecksumJob &job, const CardBlockData &cardData);
 };
 
 GcnCheckFilesPrivate::GcnCheckFilesPrivate(GcnCheckFiles* q)
 	: q_ptr(q)
-{ }	
+	, threadCount(0)
+{ }
 
-GcnCheckFilesPrivate::~GcnCheckFilesPrivate()
+/**
+ * Calculate the checksums for a file using the preloaded card data.
+ * @param job Checksum job.
+ * @param cardData Card block data.
+ */
+void GcnCheckFilesPrivate::runChecksumJob(const ChecksumJob &job, const CardBlockData &cardData)
 {
-	qDeleteAll(dbs);
+	// Assemble the file data from the card data.
+	const QVector<uint16_t> fatEntries = job.file->fatEntries();
+	QByteArray fileData;
+	fileData.resize(fatEntries.size() * cardData.blockSize);
+	char *pDest = fileData.data();
+	foreach (uint16_t physBlock, fatEntries) {
+		memcpy(pDest, cardData.data.constData() + cardData.blockOffsets.at(physBlock),
+			cardData.blockSize);
+		pDest += cardData.blockSize;
+	}
+
+	job.file->setChecksumDefs(job.checksumDefs, fileData);
+}
+
+/** GcnCheckFilesTask **/
+
+/**
+ * Checksum calculation task for parallel checks.
+ * Each task pulls job indexes from a shared counter
+ * until the job list is exhausted.
+ */
+class GcnCheckFilesTask : public QRunnable
+{
+	public:
+		GcnCheckFilesTask(const QVector<GcnCheckFilesPrivate::ChecksumJob> &jobs,
+				  const GcnCheckFilesPrivate::CardBlockData &cardData,
+				  QAtomicInt &nextIdx)
+			: jobs(jobs)
+			, cardData(cardData)
+			, nextIdx(nextIdx)
+		{ }
+
+	private:
+		Q_DISABLE_COPY(GcnCheckFilesTask)
+
+	public:
+		void run(void) final;
+
+	private:
+		const QVector<GcnCheckFilesPrivate::ChecksumJob> &jobs;
+		const GcnCheckFilesPrivate::CardBlockData &cardData;
+		QAtomicInt &nextIdx;
+};
+
+void GcnCheckFilesTask::run(void)
+{
+	const int jobCount = jobs.size();
+	for (int idx = nextIdx.fetchAndAddRelaxed(1); idx < jobCount;
+	     idx = nextIdx.fetchAndAddRelaxed(1))
+	{
+		GcnCheckFilesPrivate::runChecksumJob(jobs.at(idx), cardData);
+	}
 }
 
 /** GcnCheckFiles **/
@@ -64,30 +156,14 @@ GcnCheckFiles::~GcnCheckFiles()
 /** Functions. **/
 
 /**
- * Load multiple GCN Memory Card File databases.
- * TODO: Singleton DB file management class.
- * @param dbFilenames Filenames of GCN Memory Card File database.
- * @return 0 on success; non-zero on error. (Check error string!)
+ * Load the GCN Memory Card File databases.
+ * This uses a snapshot from GcnMcFileDbManager.
+ * @return 0 on success; non-zero on error. (no databases loaded)
  */
-int GcnCheckFiles::loadGcnMcFileDbs(const QVector<QString> &dbFilenames)
+int GcnCheckFiles::loadDatabases(void)
 {
 	Q_D(GcnCheckFiles);
-	qDeleteAll(d->dbs);
-	d->dbs.clear();
-
-	if (dbFilenames.isEmpty())
-		return 0;
-
-	// Load the databases.
-	foreach (const QString &dbFilename, dbFilenames) {
-		GcnMcFileDb *db = new GcnMcFileDb(this);
-		int ret = db->load(dbFilename);
-		if (!ret) {
-			d->dbs.append(db);
-		} else {
-			delete db;
-		}
-	}
+	d->dbs = GcnMcFileDbManager::instance()->snapshot();
 
 	// TODO: Report if any DBs were unable to be loaded.
 	// For now, just error if no DBs could be loaded.
@@ -113,7 +189,7 @@ void GcnCheckFiles::addChecksumDefs(GcnFile *file) const
 	}
 
 	Q_D(const GcnCheckFiles);
-	foreach (GcnMcFileDb *db, d->dbs) {
+	foreach (const GcnMcFileDbPtr &db, d->dbs) {
 		bool ok = db->addChecksumDefs(file);
 		if (ok)
 			break;
@@ -124,16 +200,153 @@ void GcnCheckFiles::addChecksumDefs(GcnFile *file) const
  * Add checksum definitions to all files on a GcnCard
  * if they don't already have any.
  *
- * TODO: Return value?
+ * Each block used by the files is only read once,
+ * and the checksums are calculated in parallel.
+ *
+ * @return Checksum summary for all files on the card.
  */
-void GcnCheckFiles::addChecksumDefs(GcnCard *card) const
+GcnCheckFiles::ChecksumSummary GcnCheckFiles::addChecksumDefs(GcnCard *card) const
 {
+	Q_D(const GcnCheckFiles);
 	const int fileCount = card->fileCount();
+	const int totalPhysBlocks = card->totalPhysBlocks();
+
+	// Find the checksum definitions for all files first.
+	QVector<GcnCheckFilesPrivate::ChecksumJob> jobs;
+	jobs.reserve(fileCount);
+	QVector<uint8_t> usedBlockMap(totalPhysBlocks);
+	int usedBlockCount = 0;
 	for (int i = 0; i < fileCount; i++) {
 		// NOTE: nullptr check *shouldn't* be needed...
 		GcnFile *file = qobject_cast<GcnFile*>(card->getFile(i));
-		if (file != nullptr) {
-			addChecksumDefs(file);
+		if (!file || file->checksumStatus() != Checksum::CHKST_UNKNOWN) {
+			// No file, or the checksum has already been obtained.
+			continue;
+		}
+
+		GcnCheckFilesPrivate::ChecksumJob job;
+		job.file = file;
+		bool found = false;
+		foreach (const GcnMcFileDbPtr &db, d->dbs) {
+			found = db->findChecksumDefs(file, job.checksumDefs);
+			if (found)
+				break;
+		}
+		if (!found || job.checksumDefs.isEmpty()) {
+			// File information not found.
+			continue;
+		}
+
+		// Make sure all of the file's blocks are valid.
+		const QVector<uint16_t> fatEntries = file->fatEntries();
+		bool blocksOK = !fatEntries.isEmpty();
+		foreach (uint16_t physBlock, fatEntries) {
+			if (physBlock >= totalPhysBlocks) {
+				blocksOK = false;
+				break;
+			}
+		}
+		if (!blocksOK) {
+			// Can't use the card data for this file.
+			// Load the file data separately.
+			file->setChecksumDefs(job.checksumDefs);
+			continue;
+		}
+
+		foreach (uint16_t physBlock, fatEntries) {
+			if (!usedBlockMap[physBlock]) {
+				usedBlockMap[physBlock] = 1;
+				usedBlockCount++;
+			}
+		}
+		jobs.append(job);
+	}
+
+	if (!jobs.isEmpty()) {
+		// Read all of the used blocks.
+		// Blocks are read in physical order, so contiguous
+		// runs are read using a single read.
+		GcnCheckFilesPrivate::CardBlockData cardData;
+		cardData.blockSize = card->blockSize();
+		cardData.blockOffsets.fill(-1, totalPhysBlocks);
+		QVector<uint16_t> blockList;
+		blockList.reserve(usedBlockCount);
+		for (int i = 0; i < totalPhysBlocks; i++) {
+			if (usedBlockMap[i]) {
+				cardData.blockOffsets[i] = blockList.size() * cardData.blockSize;
+				blockList.append((uint16_t)i);
+			}
+		}
+		cardData.data.fill(0, blockList.size() * cardData.blockSize);
+		card->readBlocks(cardData.data.data(), cardData.data.size(), blockList);
+
+		// Determine the number of threads.
+		int threadCount = d->threadCount;
+		if (threadCount <= 0) {
+			threadCount = QThread::idealThreadCount();
+		}
+		if (threadCount > jobs.size()) {
+			threadCount = jobs.size();
+		}
+
+		if (threadCount <= 1) {
+			// Single-threaded calculation.
+			foreach (const GcnCheckFilesPrivate::ChecksumJob &job, jobs) {
+				GcnCheckFilesPrivate::runChecksumJob(job, cardData);
+			}
+		} else {
+			// Multi-threaded calculation.
+			QAtomicInt nextIdx(0);
+			QThreadPool threadPool;
+			threadPool.setMaxThreadCount(threadCount);
+			for (int i = threadCount; i > 0; i--) {
+				// NOTE: QThreadPool deletes the task when it's done.
+				threadPool.start(new GcnCheckFilesTask(jobs, cardData, nextIdx));
+			}
+			threadPool.waitForDone();
+		}
+	}
+
+	// Summarize the checksum status of all files.
+	ChecksumSummary summary = {0, 0, 0};
+	for (int i = 0; i < fileCount; i++) {
+		const File *file = card->getFile(i);
+		if (!file)
+			continue;
+
+		switch (file->checksumStatus()) {
+			case Checksum::CHKST_GOOD:
+				summary.good++;
+				break;
+			case Checksum::CHKST_INVALID:
+				summary.invalid++;
+				break;
+			case Checksum::CHKST_UNKNOWN:
+			default:
+				summary.unknown++;
+				break;
 		}
 	}
+
+	return summary;
+}
+
+/**
+ * Get the number of threads to use for checksum calculation.
+ * @return Number of threads. (If 0, QThread::idealThreadCount() will be used.)
+ */
+int GcnCheckFiles::threadCount(void) const
+{
+	Q_D(const GcnCheckFiles);
+	return d->threadCount;
+}
+
+/**
+ * Set the number of threads to use for checksum calculation.
+ * @param threadCount Number of threads. (If 0, QThread::idealThreadCount() will be used.)
+ */
+void GcnCheckFiles::setThreadCount(int threadCount)
+{
+	Q_D(GcnCheckFiles);
+	d->threadCount = threadCount;
 }
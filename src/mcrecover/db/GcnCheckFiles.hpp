@@ -37,20 +37,11 @@ class GcnCheckFiles : public QObject
 
 	public:
 		/**
-		 * Load a GCN Memory Card File database.
-		 * TODO: Singleton DB file management class.
-		 * @param dbFilename Filename of GCN Memory Card File database.
-		 * @return 0 on success; non-zero on error. (Check error string!)
+		 * Load the GCN Memory Card File databases.
+		 * This uses a snapshot from GcnMcFileDbManager.
+		 * @return 0 on success; non-zero on error. (no databases loaded)
 		 */
-		inline int loadGcnMcFileDb(const QString &dbFilename);
-
-		/**
-		 * Load multiple GCN Memory Card File databases.
-		 * TODO: Singleton DB file management class.
-		 * @param dbFilenames Filenames of GCN Memory Card File database.
-		 * @return 0 on success; non-zero on error. (Check error string!)
-		 */
-		int loadGcnMcFileDbs(const QVector<QString> &dbFilenames);
+		int loadDatabases(void);
 
 	public:
 		/**
@@ -61,25 +52,37 @@ class GcnCheckFiles : public QObject
 		 */
 		void addChecksumDefs(GcnFile *file) const;
 
+		/**
+		 * Checksum summary for a card.
+		 */
+		struct ChecksumSummary {
+			int good;	// Files with good checksums.
+			int invalid;	// Files with invalid checksums.
+			int unknown;	// Files with unknown checksums.
+		};
+
 		/**
 		 * Add checksum definitions to all files on a GcnCard
 		 * if they don't already have any.
 		 *
-		 * TODO: Return value?
+		 * Each block used by the files is only read once,
+		 * and the checksums are calculated in parallel.
+		 *
+		 * @return Checksum summary for all files on the card.
 		 */
-		void addChecksumDefs(GcnCard *card) const;
-};
+		ChecksumSummary addChecksumDefs(GcnCard *card) const;
 
-/**
- * Load a GCN Memory Card File database.
- * @param dbFilename Filename of GCN Memory Card File database.
- * @return 0 on success; non-zero on error. (Check error string!)
- */
-inline int GcnCheckFiles::loadGcnMcFileDb(const QString &dbFilename)
-{
-	QVector<QString> dbFilenames;
-	dbFilenames.append(dbFilename);
-	return loadGcnMcFileDbs(dbFilenames);
-}
+		/**
+		 * Get the number of threads to use for checksum calculation.
+		 * @return Number of threads. (If 0, QThread::idealThreadCount() will be used.)
+		 */
+		int threadCount(void) const;
+
+		/**
+		 * Set the number of threads to use for checksum calculation.
+		 * @param threadCount Number of threads. (If 0, QThread::idealThreadCount() will be used.)
+		 */
+		void setThreadCount(int threadCount);
+};
 
 #endif /* __MCRECOVER_DB_GCNCHECKFILES_HPP__ */
@@ -33,9 +33,15 @@
 
 // Qt includes.
 #include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
 #include <QtCore/QMap>
+#include <QtCore/QSaveFile>
 #include <QtCore/QTextCodec>
 #include <QtCore/QVector>
 #include <QtCore/QXmlStreamReader>
@@ -62,6 +68,86 @@ class GcnMcFileDbPrivate
 		 */
 		QMap<uint32_t, QVector<GcnMcFileDef*>*> addr_file_defs;
 
+		// Number of gameDesc prefix bytes used as a prefix index key.
+		static const int PREFIX_KEY_LEN = 4;
+
+		/**
+		 * Literal prefix index for a search address.
+		 * Values are indexes into the address's addr_file_defs vector,
+		 * in ascending order.
+		 */
+		struct PrefixIndex {
+			// Definitions with a gameDesc prefix of at least
+			// PREFIX_KEY_LEN bytes, keyed by the first PREFIX_KEY_LEN bytes.
+			QHash<QByteArray, QVector<int> > byPrefix;
+			// Definitions with a shorter gameDesc prefix, or no prefix.
+			QVector<int> unindexed;
+		};
+
+		/**
+		 * Literal prefix indexes.
+		 * - Key: Search address.
+		 * - Value: PrefixIndex.
+		 */
+		QMap<uint32_t, PrefixIndex> addr_prefix_index;
+
+		/**
+		 * Extract the literal prefix from a search pattern.
+		 *
+		 * Only ASCII characters that decode identically in
+		 * cp1252 and Shift-JIS are included, so the prefix can
+		 * be compared against the raw comment bytes.
+		 *
+		 * @param pattern Regular expression pattern.
+		 * @return Literal prefix, or empty QByteArray if none.
+		 */
+		static QByteArray ExtractLiteralPrefix(const QString &pattern);
+
+		/**
+		 * Initialize the search regular expressions and literal prefixes.
+		 * search.gameDesc and search.fileDesc must be set.
+		 * @param gcnMcFileDef File definition.
+		 * @param optimize If true, compile the regular expressions now.
+		 * Otherwise, they're compiled when they're first used.
+		 */
+		static void InitSearchPatterns(GcnMcFileDef *gcnMcFileDef, bool optimize = true);
+
+		/**
+		 * Compile the filename template and variable modifiers.
+		 * dirEntry.filename and varModifiers must be set.
+		 * @param gcnMcFileDef File definition.
+		 */
+		static void InitVarTemplates(GcnMcFileDef *gcnMcFileDef);
+
+		/**
+		 * Build the literal prefix indexes from addr_file_defs.
+		 */
+		void buildPrefixIndex(void);
+
+		/**
+		 * Skip leading bytes that QString::trimmed() may remove.
+		 * @param buf Comment.
+		 * @param siz Size of comment. (usually 32)
+		 * @return Offset of the first non-whitespace byte.
+		 */
+		static int SkipCommentWhitespace(const char *buf, int siz);
+
+		/**
+		 * Check if a comment can match a literal prefix.
+		 * @param buf Comment.
+		 * @param siz Size of comment. (usually 32)
+		 * @param prefix Literal prefix.
+		 * @return True if the comment starts with the prefix, or if the prefix is empty.
+		 */
+		static inline bool CommentHasPrefix(const char *buf, int siz, const QByteArray &prefix)
+		{
+			if (prefix.isEmpty())
+				return true;
+			const int start = SkipCommentWhitespace(buf, siz);
+			return (start + prefix.size() <= siz &&
+				!memcmp(&buf[start], prefix.constData(), prefix.size()));
+		}
+
 		/**
 		 * Convert a region character to a GcnMcFileDef::regions_t bitfield value.
 		 * @param regionChr Region character.
@@ -91,6 +177,35 @@ class GcnMcFileDbPrivate
 		void parseXml_file_variables(QXmlStreamReader &xml, GcnMcFileDef *gcnMcFileDef);
 		void parseXml_file_variable(QXmlStreamReader &xml, GcnMcFileDef *gcnMcFileDef);
 
+		/** Binary cache. **/
+
+		// Binary cache file header.
+		static const char CACHE_MAGIC[8];
+		static const quint32 CACHE_VERSION = 2;
+
+		/**
+		 * Get the binary cache filename for a database file.
+		 * @param filename Filename of the database file.
+		 * @return Binary cache filename, or empty string if no configuration path is available.
+		 */
+		static QString cacheFilename(const QString &filename);
+
+		/**
+		 * Load a GCN Memory Card File database from the binary cache.
+		 * The cache is only used if the database file's
+		 * path, size, and mtime match the cached values.
+		 * @param fileInfo Database file.
+		 * @return 0 on success; non-zero if the cache is missing or stale.
+		 */
+		int loadCache(const QFileInfo &fileInfo);
+
+		/**
+		 * Save the GCN Memory Card File database to the binary cache.
+		 * @param fileInfo Database file.
+		 * @return 0 on success; non-zero on error.
+		 */
+		int saveCache(const QFileInfo &fileInfo) const;
+
 		/**
 		 * Error string.
 		 * Set if an error occurs in load().
@@ -119,6 +234,60 @@ class GcnMcFileDbPrivate
 		 */
 		static QByteArray GetGcnCommentUtf8(const char *buf, int siz, QTextCodec *textCodec);
 
+		/**
+		 * GCN comment, decoded on demand.
+		 *
+		 * If the comment only contains ASCII characters that are
+		 * the same in cp1252 and Shift-JIS, both decodings are
+		 * identical, so the US string is shared with JP and the
+		 * Shift-JIS codec is never used.
+		 */
+		class LazyComment {
+			public:
+				/**
+				 * Initialize a lazily-decoded comment.
+				 * @param d GcnMcFileDbPrivate. (for text codecs)
+				 * @param buf Comment.
+				 * @param siz Size of comment. (usually 32)
+				 */
+				LazyComment(const GcnMcFileDbPrivate *d, const char *buf, int siz);
+
+			private:
+				Q_DISABLE_COPY(LazyComment)
+
+			public:
+				/**
+				 * Get the comment, decoded as cp1252.
+				 * @return Comment. (UTF-16)
+				 */
+				const QString &us(void);
+
+				/**
+				 * Get the comment, decoded as Shift-JIS.
+				 * @return Comment. (UTF-16)
+				 */
+				const QString &jp(void);
+
+				/**
+				 * Are the US and JP decodings identical?
+				 * @return True if the US and JP decodings are identical.
+				 */
+				inline bool isShared(void) const
+				{
+					return m_isAscii;
+				}
+
+			private:
+				const GcnMcFileDbPrivate *const d;
+				const char *const m_buf;
+				int m_siz;
+				bool m_isAscii;
+				bool m_hasUS;
+				bool m_hasJP;
+				QString m_us;
+				QString m_jp;
+		};
+
 		/**
 		 * Construct a GcnSearchData entry.
 		 * @param matchFileDef	[in] File definition.
@@ -128,7 +297,8 @@ class GcnMcFileDbPrivate
 		 */
 		GcnSearchData constructSearchData(
 			const GcnMcFileDef *matchFileDef,
-			const QHash<QString, QString> &vars,
+			const QStringList &gameDescVars,
+			const QStringList &fileDescVars,
 			const QDateTime &qDateTime) const;
 };
 
@@ -182,6 +352,7 @@ void GcnMcFileDbPrivate::clear(void)
 	}
 
 	addr_file_defs.clear();
+	addr_prefix_index.clear();
 }
 
 
@@ -195,6 +366,15 @@ int GcnMcFileDbPrivate::load(const QString &filename)
 	// Clear the loaded database.
 	clear();
 
+	// Check the binary cache first.
+	const QFileInfo fileInfo(filename);
+	if (loadCache(fileInfo) == 0) {
+		// Database loaded from the cache.
+		buildPrefixIndex();
+		errorString = QString();
+		return 0;
+	}
+
 	// Attempt to open the specified database file.
 	QFile file(filename);
 	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
@@ -234,11 +414,406 @@ int GcnMcFileDbPrivate::load(const QString &filename)
 	}
 
 	// Database parsed successfully.
+	// Save it to the binary cache for next time.
+	saveCache(fileInfo);
+	buildPrefixIndex();
 	errorString = QString();
 	return 0;
 }
 
 
+/**
+ * Extract the literal prefix from a search pattern.
+ *
+ * Only ASCII characters that decode identically in
+ * cp1252 and Shift-JIS are included, so the prefix can
+ * be compared against the raw comment bytes.
+ *
+ * @param pattern Regular expression pattern.
+ * @return Literal prefix, or empty QByteArray if none.
+ */
+QByteArray GcnMcFileDbPrivate::ExtractLiteralPrefix(const QString &pattern)
+{
+	// Pattern must be anchored to the start of the string.
+	// Alternation may bypass the prefix, so don't bother
+	// with patterns that have alternation anywhere.
+	if (!pattern.startsWith(QChar(L'^')) || pattern.contains(QChar(L'|')))
+		return QByteArray();
+
+	QByteArray prefix;
+	const int len = pattern.size();
+	for (int i = 1; i < len; ) {
+		ushort chr = pattern.at(i).unicode();
+		int next = i + 1;
+		if (chr == '\\') {
+			// Escape sequence.
+			// Only escaped punctuation is a literal.
+			if (next >= len)
+				break;
+			chr = pattern.at(next).unicode();
+			if (chr >= 0x80 || isalnum(chr))
+				break;
+			next++;
+		} else if (chr < 0x80 && strchr(".[]()*+?{}|^$", chr)) {
+			// Metacharacter.
+			break;
+		}
+
+		// Only use characters that are the same in cp1252 and Shift-JIS.
+		// NOTE: '\\' and '~' may be remapped by Shift-JIS.
+		if (chr < 0x20 || chr > 0x7D || chr == '\\')
+			break;
+
+		// If this character has a quantifier, it might be optional.
+		if (next < len) {
+			const ushort q = pattern.at(next).unicode();
+			if (q == '*' || q == '+' || q == '?' || q == '{')
+				break;
+		}
+
+		prefix.append((char)chr);
+		i = next;
+	}
+
+	return prefix;
+}
+
+
+/**
+ * Initialize the search regular expressions and literal prefixes.
+ * search.gameDesc and search.fileDesc must be set.
+ * @param gcnMcFileDef File definition.
+ * @param optimize If true, compile the regular expressions now.
+ * Otherwise, they're compiled when they're first used.
+ */
+void GcnMcFileDbPrivate::InitSearchPatterns(GcnMcFileDef *gcnMcFileDef, bool optimize)
+{
+	// Set the regular expressions.
+	gcnMcFileDef->search.gameDesc_regex.setPattern(gcnMcFileDef->search.gameDesc);
+	gcnMcFileDef->search.fileDesc_regex.setPattern(gcnMcFileDef->search.fileDesc);
+#if QT_VERSION >= QT_VERSION_CHECK(5,4,0)
+	// NOTE: optimize() compiles and JITs the pattern immediately.
+	// Qt 5.4 and later always optimize on first use otherwise.
+	if (optimize) {
+		gcnMcFileDef->search.gameDesc_regex.optimize();
+		gcnMcFileDef->search.fileDesc_regex.optimize();
+	}
+#else /* QT_VERSION < QT_VERSION_CHECK(5,4,0) */
+	Q_UNUSED(optimize)
+#endif /* QT_VERSION >= QT_VERSION_CHECK(5,4,0) */
+
+	// Extract the literal prefixes.
+	gcnMcFileDef->search.gameDesc_prefix = ExtractLiteralPrefix(gcnMcFileDef->search.gameDesc);
+	gcnMcFileDef->search.fileDesc_prefix = ExtractLiteralPrefix(gcnMcFileDef->search.fileDesc);
+}
+
+
+/**
+ * Compile the filename template and variable modifiers.
+ * dirEntry.filename and varModifiers must be set.
+ * @param gcnMcFileDef File definition.
+ */
+void GcnMcFileDbPrivate::InitVarTemplates(GcnMcFileDef *gcnMcFileDef)
+{
+	gcnMcFileDef->dirEntry.filename_tmpl = VarReplace::Compile(gcnMcFileDef->dirEntry.filename);
+	gcnMcFileDef->varModifiers_compiled = VarReplace::CompileModifiers(gcnMcFileDef->varModifiers);
+}
+
+
+/**
+ * Build the literal prefix indexes from addr_file_defs.
+ */
+void GcnMcFileDbPrivate::buildPrefixIndex(void)
+{
+	addr_prefix_index.clear();
+	for (auto iter = addr_file_defs.cbegin(); iter != addr_file_defs.cend(); ++iter) {
+		PrefixIndex &index = addr_prefix_index[iter.key()];
+		const QVector<GcnMcFileDef*> &vec = *(iter.value());
+		for (int i = 0; i < vec.size(); i++) {
+			const QByteArray &prefix = vec.at(i)->search.gameDesc_prefix;
+			if (prefix.size() >= PREFIX_KEY_LEN) {
+				index.byPrefix[prefix.left(PREFIX_KEY_LEN)].append(i);
+			} else {
+				index.unindexed.append(i);
+			}
+		}
+	}
+}
+
+
+/**
+ * Skip leading bytes that QString::trimmed() may remove.
+ * @param buf Comment.
+ * @param siz Size of comment. (usually 32)
+ * @return Offset of the first non-whitespace byte.
+ */
+int GcnMcFileDbPrivate::SkipCommentWhitespace(const char *buf, int siz)
+{
+	// Whitespace in cp1252: 0x09-0x0D, 0x20, 0xA0 (NBSP)
+	// Whitespace in Shift-JIS: 0x09-0x0D, 0x20, 0x81 0x40 (ideographic space)
+	int i = 0;
+	while (i < siz) {
+		const uint8_t chr = (uint8_t)buf[i];
+		if (chr == 0x20 || (chr >= 0x09 && chr <= 0x0D) || chr == 0xA0) {
+			i++;
+		} else if (chr == 0x81 && i+1 < siz && (uint8_t)buf[i+1] == 0x40) {
+			i += 2;
+		} else {
+			break;
+		}
+	}
+	return i;
+}
+
+
+/** Binary cache. **/
+
+const char GcnMcFileDbPrivate::CACHE_MAGIC[8] = {'M','C','R','D','B','C','\0','\0'};
+
+/**
+ * Get the binary cache filename for a database file.
+ * @param filename Filename of the database file.
+ * @return Binary cache filename, or empty string if no configuration path is available.
+ */
+QString GcnMcFileDbPrivate::cacheFilename(const QString &filename)
+{
+	const QString configPath = ConfigStore::ConfigPath();
+	if (configPath.isEmpty())
+		return QString();
+
+	// Cache filename: "dbcache/[basename]-[SHA-1 of the absolute path].bin"
+	const QFileInfo fileInfo(filename);
+	const QByteArray pathHash = QCryptographicHash::hash(
+		fileInfo.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+	return configPath + QLatin1String("dbcache/") +
+		fileInfo.completeBaseName() + QChar(L'-') +
+		QLatin1String(pathHash.constData()) + QLatin1String(".bin");
+}
+
+/**
+ * Load a GCN Memory Card File database from the binary cache.
+ * The cache is only used if the database file's
+ * path, size, and mtime match the cached values.
+ * @param fileInfo Database file.
+ * @return 0 on success; non-zero if the cache is missing or stale.
+ */
+int GcnMcFileDbPrivate::loadCache(const QFileInfo &fileInfo)
+{
+	const QString cacheFile = cacheFilename(fileInfo.absoluteFilePath());
+	if (cacheFile.isEmpty())
+		return -1;
+
+	QFile file(cacheFile);
+	if (!file.open(QIODevice::ReadOnly))
+		return -1;
+
+	QDataStream ds(&file);
+	ds.setVersion(QDataStream::Qt_5_0);
+
+	// Verify the header.
+	char magic[sizeof(CACHE_MAGIC)];
+	if (ds.readRawData(magic, sizeof(magic)) != (int)sizeof(magic) ||
+	    memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0)
+	{
+		return -2;
+	}
+	quint32 version;
+	ds >> version;
+	if (version != CACHE_VERSION)
+		return -2;
+
+	// Verify the source file.
+	QString srcPath;
+	qint64 srcSize, srcMTime;
+	ds >> srcPath >> srcSize >> srcMTime;
+	if (ds.status() != QDataStream::Ok ||
+	    srcPath != fileInfo.absoluteFilePath() ||
+	    srcSize != fileInfo.size() ||
+	    srcMTime != fileInfo.lastModified().toMSecsSinceEpoch())
+	{
+		// Cache is stale.
+		return -3;
+	}
+
+	// Read the file definitions.
+	// NOTE: Definitions are stored in addr_file_defs order,
+	// so appending them reproduces the original vectors.
+	quint32 count;
+	ds >> count;
+	for (; count > 0 && ds.status() == QDataStream::Ok; count--) {
+		GcnMcFileDef *const gcnMcFileDef = new GcnMcFileDef;
+		ds >> gcnMcFileDef->gameName >> gcnMcFileDef->fileInfo;
+		ds.readRawData(gcnMcFileDef->id6, sizeof(gcnMcFileDef->id6));
+		ds >> gcnMcFileDef->regions;
+
+		// Search definitions.
+		ds >> gcnMcFileDef->search.address;
+		ds >> gcnMcFileDef->search.gameDesc >> gcnMcFileDef->search.fileDesc;
+
+		// Checksum definitions.
+		quint32 chkCount;
+		ds >> chkCount;
+		if (ds.status() != QDataStream::Ok || chkCount > 2043*8) {
+			delete gcnMcFileDef;
+			break;
+		}
+		gcnMcFileDef->checksumDefs.resize(chkCount);
+		for (quint32 i = 0; i < chkCount; i++) {
+			Checksum::ChecksumDef &checksumDef = gcnMcFileDef->checksumDefs[i];
+			quint8 algorithm, endian, crcReflected;
+			ds >> algorithm >> checksumDef.address >> checksumDef.param;
+			ds >> checksumDef.start >> checksumDef.length >> endian;
+			ds >> checksumDef.crcInit >> checksumDef.crcXorOut >> crcReflected;
+			checksumDef.algorithm = (Checksum::ChkAlgorithm)algorithm;
+			checksumDef.endian = (Checksum::ChkEndian)endian;
+			checksumDef.crcReflected = (crcReflected != 0);
+		}
+
+		// Directory entry.
+		ds >> gcnMcFileDef->dirEntry.filename;
+		ds >> gcnMcFileDef->dirEntry.bannerFormat;
+		ds >> gcnMcFileDef->dirEntry.iconAddress;
+		ds >> gcnMcFileDef->dirEntry.iconFormat;
+		ds >> gcnMcFileDef->dirEntry.iconSpeed;
+		ds >> gcnMcFileDef->dirEntry.permission;
+		ds >> gcnMcFileDef->dirEntry.length;
+
+		// Variable modifiers.
+		quint32 varCount;
+		ds >> varCount;
+		for (; varCount > 0 && ds.status() == QDataStream::Ok; varCount--) {
+			QString id;
+			VarModifierDef varModifierDef;
+			qint8 fillChar;
+			qint32 addValue;
+			ds >> id >> varModifierDef.useAs >> varModifierDef.varType;
+			ds >> varModifierDef.minWidth >> fillChar;
+			ds >> varModifierDef.fieldAlign >> addValue;
+			varModifierDef.fillChar = (char)fillChar;
+			varModifierDef.addValue = addValue;
+			gcnMcFileDef->varModifiers.insert(id, varModifierDef);
+		}
+
+		if (ds.status() != QDataStream::Ok) {
+			delete gcnMcFileDef;
+			break;
+		}
+
+		// Set the regular expressions.
+		// Don't optimize them here; most of them won't be used
+		// in a given scan, since the literal prefixes filter
+		// out most definitions before the regex is matched.
+		InitSearchPatterns(gcnMcFileDef, false);
+		InitVarTemplates(gcnMcFileDef);
+
+		// Add the file to the database.
+		const uint32_t address = (gcnMcFileDef->search.address & BLOCK_SIZE_MASK);
+		QVector<GcnMcFileDef*>* vec = addr_file_defs.value(address);
+		if (!vec) {
+			// Create a new QVector.
+			vec = new QVector<GcnMcFileDef*>();
+			addr_file_defs.insert(address, vec);
+		}
+		vec->append(gcnMcFileDef);
+	}
+
+	if (count != 0 || ds.status() != QDataStream::Ok) {
+		// Cache is corrupted.
+		clear();
+		return -4;
+	}
+
+	return 0;
+}
+
+/**
+ * Save the GCN Memory Card File database to the binary cache.
+ * @param fileInfo Database file.
+ * @return 0 on success; non-zero on error.
+ */
+int GcnMcFileDbPrivate::saveCache(const QFileInfo &fileInfo) const
+{
+	const QString cacheFile = cacheFilename(fileInfo.absoluteFilePath());
+	if (cacheFile.isEmpty())
+		return -1;
+
+	// Make sure the cache directory exists.
+	if (!QDir().mkpath(QFileInfo(cacheFile).absolutePath()))
+		return -1;
+
+	// NOTE: QSaveFile prevents other instances from
+	// seeing a partially-written cache file.
+	QSaveFile file(cacheFile);
+	if (!file.open(QIODevice::WriteOnly))
+		return -1;
+
+	QDataStream ds(&file);
+	ds.setVersion(QDataStream::Qt_5_0);
+
+	// Header.
+	ds.writeRawData(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	ds << (quint32)CACHE_VERSION;
+
+	// Source file.
+	ds << fileInfo.absoluteFilePath();
+	ds << (qint64)fileInfo.size();
+	ds << (qint64)fileInfo.lastModified().toMSecsSinceEpoch();
+
+	// File definitions.
+	quint32 count = 0;
+	foreach (const QVector<GcnMcFileDef*> *vec, addr_file_defs) {
+		count += vec->size();
+	}
+	ds << count;
+
+	foreach (const QVector<GcnMcFileDef*> *vec, addr_file_defs) {
+		foreach (const GcnMcFileDef *gcnMcFileDef, *vec) {
+			ds << gcnMcFileDef->gameName << gcnMcFileDef->fileInfo;
+			ds.writeRawData(gcnMcFileDef->id6, sizeof(gcnMcFileDef->id6));
+			ds << gcnMcFileDef->regions;
+
+			// Search definitions.
+			ds << gcnMcFileDef->search.address;
+			ds << gcnMcFileDef->search.gameDesc << gcnMcFileDef->search.fileDesc;
+
+			// Checksum definitions.
+			ds << (quint32)gcnMcFileDef->checksumDefs.size();
+			foreach (const Checksum::ChecksumDef &checksumDef, gcnMcFileDef->checksumDefs) {
+				ds << (quint8)checksumDef.algorithm << checksumDef.address << checksumDef.param;
+				ds << checksumDef.start << checksumDef.length << (quint8)checksumDef.endian;
+				ds << checksumDef.crcInit << checksumDef.crcXorOut << (quint8)checksumDef.crcReflected;
+			}
+
+			// Directory entry.
+			ds << gcnMcFileDef->dirEntry.filename;
+			ds << gcnMcFileDef->dirEntry.bannerFormat;
+			ds << gcnMcFileDef->dirEntry.iconAddress;
+			ds << gcnMcFileDef->dirEntry.iconFormat;
+			ds << gcnMcFileDef->dirEntry.iconSpeed;
+			ds << gcnMcFileDef->dirEntry.permission;
+			ds << gcnMcFileDef->dirEntry.length;
+
+			// Variable modifiers.
+			ds << (quint32)gcnMcFileDef->varModifiers.size();
+			for (auto iter = gcnMcFileDef->varModifiers.cbegin();
+			     iter != gcnMcFileDef->varModifiers.cend(); ++iter)
+			{
+				const VarModifierDef &varModifierDef = iter.value();
+				ds << iter.key() << varModifierDef.useAs << varModifierDef.varType;
+				ds << varModifierDef.minWidth << (qint8)varModifierDef.fillChar;
+				ds << varModifierDef.fieldAlign << (qint32)varModifierDef.addValue;
+			}
+		}
+	}
+
+	if (ds.status() != QDataStream::Ok) {
+		file.cancelWriting();
+		return -2;
+	}
+	return (file.commit() ? 0 : -2);
+}
+
+
 void GcnMcFileDbPrivate::parseXml_GcnMcFileDb(QXmlStreamReader &xml)
 {
 	const QLatin1String myTokenType("GcnMcFileDb");
@@ -377,6 +952,9 @@ GcnMcFileDef *GcnMcFileDbPrivate::parseXml_file(QXmlStreamReader &xml)
 		return nullptr;
 	}
 
+	// Compile the filename template and variable modifiers.
+	InitVarTemplates(gcnMcFileDef);
+
 	// Determine the main region code from the game code.
 	QChar regionChr((ushort)gcnMcFileDef->gamecode[3]);
 	gcnMcFileDef->regions = RegionCharToBitfield(regionChr);
@@ -442,16 +1020,7 @@ void GcnMcFileDbPrivate::parseXml_file_search(QXmlStreamReader &xml, GcnMcFileDe
 	}
 
 	// Set the regular expressions.
-	gcnMcFileDef->search.gameDesc_regex.setPattern(gcnMcFileDef->search.gameDesc);
-	gcnMcFileDef->search.fileDesc_regex.setPattern(gcnMcFileDef->search.fileDesc);
-#if QT_VERSION >= QT_VERSION_CHECK(5,4,0)
-	// TODO: If compiling with older Qt, set QRegularExpression::OptimizeOnFirstUsageOption.
-	// This will allow optimization if used with newer Qt without recompiling.
-	// QRegularExpression::PatternOption enum value 0x0080
-	// QRegularExpression::setPatternOptions()
-	gcnMcFileDef->search.gameDesc_regex.optimize();
-	gcnMcFileDef->search.fileDesc_regex.optimize();
-#endif /* QT_VERSION >= QT_VERSION_CHECK(5,4,0) */
+	InitSearchPatterns(gcnMcFileDef);
 }
 
 
@@ -495,6 +1064,25 @@ void GcnMcFileDbPrivate::parseXml_file_checksum(QXmlStreamReader &xml, GcnMcFile
 				else
 					poly = 0;
 
+				// CRC-32 options.
+				// Defaults are the zlib CRC-32 options.
+				if (attributes.hasAttribute(QLatin1String("init"))) {
+					checksumDef.crcInit =
+						attributes.value(QLatin1String("init")).toString().toUInt(nullptr, 0);
+				}
+				if (attributes.hasAttribute(QLatin1String("xorout"))) {
+					checksumDef.crcXorOut =
+						attributes.value(QLatin1String("xorout")).toString().toUInt(nullptr, 0);
+				}
+				if (attributes.hasAttribute(QLatin1String("reflected"))) {
+					const QString reflected =
+						attributes.value(QLatin1String("reflected")).toString().trimmed().toLower();
+					checksumDef.crcReflected =
+						(reflected == QLatin1String("true") ||
+						 reflected == QLatin1String("yes") ||
+						 reflected.toUInt(nullptr, 0) != 0);
+				}
+
 				algorithm = parseXml_element(xml).toLower();
 			} else if (xml.name() == QLatin1String("address")) {
 				// Checksum address.
@@ -825,16 +1413,87 @@ QByteArray GcnMcFileDbPrivate::GetGcnCommentUtf8(const char *buf, int siz, QText
 	return GetGcnCommentUtf16(buf, siz, textCodec).toUtf8();
 }
 
+/** LazyComment **/
+
+/**
+ * Initialize a lazily-decoded comment.
+ * @param d GcnMcFileDbPrivate. (for text codecs)
+ * @param buf Comment.
+ * @param siz Size of comment. (usually 32)
+ */
+GcnMcFileDbPrivate::LazyComment::LazyComment(const GcnMcFileDbPrivate *d, const char *buf, int siz)
+	: d(d)
+	, m_buf(buf)
+	, m_siz(siz)
+	, m_isAscii(true)
+	, m_hasUS(false)
+	, m_hasJP(false)
+{
+	// Only the characters before the first NULL are decoded.
+	const char *p_nullChr = (const char*)memchr(buf, 0x00, siz);
+	if (p_nullChr) {
+		m_siz = (int)(p_nullChr - buf);
+	}
+
+	// Check for characters that cp1252 and Shift-JIS decode differently.
+	// NOTE: Shift-JIS may remap '\\' (0x5C) and '~' (0x7E).
+	for (int i = 0; i < m_siz; i++) {
+		const uint8_t chr = (uint8_t)buf[i];
+		if (chr >= 0x7E || chr == 0x5C) {
+			m_isAscii = false;
+			break;
+		}
+	}
+}
+
+/**
+ * Get the comment, decoded as cp1252.
+ * @return Comment. (UTF-16)
+ */
+const QString &GcnMcFileDbPrivate::LazyComment::us(void)
+{
+	if (!m_hasUS) {
+		if (m_isAscii) {
+			// ASCII is the same in every supported encoding.
+			m_us = QString::fromLatin1(m_buf, m_siz).trimmed();
+		} else {
+			m_us = GetGcnCommentUtf16(m_buf, m_siz, d->textCodecUS);
+		}
+		m_hasUS = true;
+	}
+	return m_us;
+}
+
+/**
+ * Get the comment, decoded as Shift-JIS.
+ * @return Comment. (UTF-16)
+ */
+const QString &GcnMcFileDbPrivate::LazyComment::jp(void)
+{
+	if (m_isAscii) {
+		// Share the US string.
+		return us();
+	}
+
+	if (!m_hasJP) {
+		m_jp = GetGcnCommentUtf16(m_buf, m_siz, d->textCodecJP);
+		m_hasJP = true;
+	}
+	return m_jp;
+}
+
 /**
  * Construct a GcnSearchData entry.
  * @param matchFileDef	[in] File definition.
- * @param vars		[in] Variables.
+ * @param gameDescVars	[in] GameDesc variables.
+ * @param fileDescVars	[in] FileDesc variables.
  * @param qDateTime	[in] Timestamp.
  * @return GcnSearchData entry.
  */
 GcnSearchData GcnMcFileDbPrivate::constructSearchData(
 	const GcnMcFileDef *matchFileDef,
-	const QHash<QString, QString> &vars,
+	const QStringList &gameDescVars,
+	const QStringList &fileDescVars,
 	const QDateTime &qDateTime) const
 {
 	// TODO: Implicitly share GcnSearchData?
@@ -850,7 +1509,8 @@ GcnSearchData GcnMcFileDbPrivate::constructSearchData(
 	QByteArray ba;
 
 	// Substitute variables in the filename.
-	QString filename = VarReplace::Exec(matchFileDef->dirEntry.filename, vars);
+	QString filename = VarReplace::Exec(matchFileDef->dirEntry.filename_tmpl,
+		gameDescVars, fileDescVars);
 
 	// Filename.
 	// FIXME: Also for 'S' (used by SADX preview)?
@@ -950,29 +1610,73 @@ QVector<GcnSearchData> GcnMcFileDb::checkBlock(const void *buf, int siz) const
 	QVector<GcnSearchData> fileMatches;
 
 	Q_D(const GcnMcFileDb);
-	foreach (uint32_t address, d->addr_file_defs.keys()) {
+	for (auto iter = d->addr_file_defs.cbegin(); iter != d->addr_file_defs.cend(); ++iter) {
 		// Make sure this address is within the bounds of the buffer.
 		// Game Description + File Description == 64 bytes. (0x40)
+		const uint32_t address = iter.key();
 		const int maxAddress = (int)(address + 0x40);
 		if (maxAddress < 0 || maxAddress > siz)
 			continue;
 
 		// Get the game description and file description.
 		const char *const commentData = ((const char*)buf + address);
-		const QString gameDescUS = d->GetGcnCommentUtf16(commentData, 32, d->textCodecUS);
-		const QString gameDescJP = d->GetGcnCommentUtf16(commentData, 32, d->textCodecJP);
-		const QString fileDescUS = d->GetGcnCommentUtf16(commentData+32, 32, d->textCodecUS);
-		const QString fileDescJP = d->GetGcnCommentUtf16(commentData+32, 32, d->textCodecJP);
 
-		QVector<GcnMcFileDef*> *vec = d->addr_file_defs.value(address);
-		foreach (const GcnMcFileDef *gcnMcFileDef, *vec) {
+		// Find candidate definitions using the literal prefix index.
+		// Most blocks don't match any prefix, so they're rejected
+		// without decoding the comments or running any regexes.
+		auto indexIter = d->addr_prefix_index.constFind(address);
+		if (indexIter == d->addr_prefix_index.constEnd())
+			continue;
+		const GcnMcFileDbPrivate::PrefixIndex &index = indexIter.value();
+		const QVector<int> *bucket = nullptr;
+		const int gameDescStart = d->SkipCommentWhitespace(commentData, 32);
+		if (gameDescStart + GcnMcFileDbPrivate::PREFIX_KEY_LEN <= 32) {
+			auto bucketIter = index.byPrefix.constFind(QByteArray::fromRawData(
+				&commentData[gameDescStart], GcnMcFileDbPrivate::PREFIX_KEY_LEN));
+			if (bucketIter != index.byPrefix.constEnd())
+				bucket = &bucketIter.value();
+		}
+		if (!bucket && index.unindexed.isEmpty())
+			continue;
+
+		// Comments are decoded on first use.
+		GcnMcFileDbPrivate::LazyComment gameDesc(d, commentData, 32);
+		GcnMcFileDbPrivate::LazyComment fileDesc(d, commentData+32, 32);
+
+		// Check the candidates in database order.
+		// Both index lists are sorted, so merge them.
+		const QVector<GcnMcFileDef*> &vec = *(iter.value());
+		const int bucketSize = (bucket ? bucket->size() : 0);
+		int idxBucket = 0, idxUnindexed = 0;
+		while (idxBucket < bucketSize || idxUnindexed < index.unindexed.size()) {
+			int defIdx;
+			if (idxUnindexed >= index.unindexed.size() ||
+			    (idxBucket < bucketSize && bucket->at(idxBucket) < index.unindexed.at(idxUnindexed))) {
+				defIdx = bucket->at(idxBucket++);
+			} else {
+				defIdx = index.unindexed.at(idxUnindexed++);
+			}
+			const GcnMcFileDef *const gcnMcFileDef = vec.at(defIdx);
+
+			// Check the full literal prefixes.
+			if (!d->CommentHasPrefix(commentData, 32, gcnMcFileDef->search.gameDesc_prefix) ||
+			    !d->CommentHasPrefix(commentData+32, 32, gcnMcFileDef->search.fileDesc_prefix))
+			{
+				// No match.
+				continue;
+			}
+
 			// Check if the Game Description (US) matches.
 			QRegularExpressionMatch gameDescMatch =
-				gcnMcFileDef->search.gameDesc_regex.match(gameDescUS);
+				gcnMcFileDef->search.gameDesc_regex.match(gameDesc.us());
 			if (!gameDescMatch.hasMatch()) {
 				// No match for US.
+				if (gameDesc.isShared()) {
+					// JP is identical to US.
+					continue;
+				}
 				// Check if the Game Description (JP) matches.
-				gameDescMatch = gcnMcFileDef->search.gameDesc_regex.match(gameDescJP);
+				gameDescMatch = gcnMcFileDef->search.gameDesc_regex.match(gameDesc.jp());
 				if (!gameDescMatch.hasMatch()) {
 					// No match for JP.
 					continue;
@@ -981,11 +1685,15 @@ QVector<GcnSearchData> GcnMcFileDb::checkBlock(const void *buf, int siz) const
 
 			// Check if the File Description (US) matches.
 			QRegularExpressionMatch fileDescMatch =
-				gcnMcFileDef->search.fileDesc_regex.match(fileDescUS);
+				gcnMcFileDef->search.fileDesc_regex.match(fileDesc.us());
 			if (!fileDescMatch.hasMatch()) {
 				// No match for US.
+				if (fileDesc.isShared()) {
+					// JP is identical to US.
+					continue;
+				}
 				// Check if the Game Description (JP) matches.
-				fileDescMatch = gcnMcFileDef->search.fileDesc_regex.match(fileDescJP);
+				fileDescMatch = gcnMcFileDef->search.fileDesc_regex.match(fileDesc.jp());
 				if (!fileDescMatch.hasMatch()) {
 					// No match for JP.
 					continue;
@@ -995,13 +1703,15 @@ QVector<GcnSearchData> GcnMcFileDb::checkBlock(const void *buf, int siz) const
 			// Found a match.
 			// Attempt to apply variable modifiers.
 			QDateTime qDateTime;
-			QHash<QString, QString> vars = VarReplace::StringListsToHash(
-				gameDescMatch.capturedTexts(), fileDescMatch.capturedTexts());
-			int ret = VarReplace::ApplyModifiers(gcnMcFileDef->varModifiers, vars, &qDateTime);
+			QStringList gameDescVars = gameDescMatch.capturedTexts();
+			QStringList fileDescVars = fileDescMatch.capturedTexts();
+			int ret = VarReplace::ApplyModifiers(gcnMcFileDef->varModifiers_compiled,
+				gameDescVars, fileDescVars, &qDateTime);
 			if (ret == 0) {
 				// Variable modifiers applied successfully.
 				// Construct a GcnSearchData struct for this file entry.
-				fileMatches.append(d->constructSearchData(gcnMcFileDef, vars, qDateTime));
+				fileMatches.append(d->constructSearchData(gcnMcFileDef,
+					gameDescVars, fileDescVars, qDateTime));
 			}
 		}
 	}
@@ -1111,6 +1821,26 @@ bool GcnMcFileDb::addChecksumDefs(GcnFile *file) const
 		return true;
 	}
 
+	QVector<Checksum::ChecksumDef> checksumDefs;
+	if (!findChecksumDefs(file, checksumDefs)) {
+		// File information not found.
+		return false;
+	}
+
+	// Copy the checksum definitions.
+	file->setChecksumDefs(checksumDefs);
+	return true;
+}
+
+/**
+ * Find checksum definitions for an open file.
+ * The file's checksum definitions are not modified.
+ * @param file		[in] GcnFile
+ * @param checksumDefs	[out] Checksum definitions.
+ * @return True if the file was found in this database; false if not.
+ */
+bool GcnMcFileDb::findChecksumDefs(const GcnFile *file, QVector<Checksum::ChecksumDef> &checksumDefs) const
+{
 	// TODO: Filename regex?
 
 	// GCN file comments: "GameDesc\0FileDesc"
@@ -1153,8 +1883,7 @@ bool GcnMcFileDb::addChecksumDefs(GcnFile *file) const
 			}
 
 			// File matches.
-			// Copy the checksum definitions.
-			file->setChecksumDefs(gcnMcFileDef->checksumDefs);
+			checksumDefs = gcnMcFileDef->checksumDefs;
 			return true;
 		}
 	}
@@ -84,6 +84,15 @@ class GcnMcFileDb : public QObject
 		 * @return True if definitions were added by this class; false if not.
 		 */
 		bool addChecksumDefs(GcnFile *file) const;
+
+		/**
+		 * Find checksum definitions for an open file.
+		 * The file's checksum definitions are not modified.
+		 * @param file		[in] GcnFile
+		 * @param checksumDefs	[out] Checksum definitions.
+		 * @return True if the file was found in this database; false if not.
+		 */
+		bool findChecksumDefs(const GcnFile *file, QVector<Checksum::ChecksumDef> &checksumDefs) const;
 };
 
 #endif /* __MCRECOVER_GCNMCFILEDB_HPP__ */
@@ -0,0 +1,289 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * GcnMcFileDbManager.cpp: GCN Memory Card File Database manager.          *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#include "GcnMcFileDbManager.hpp"
+
+// GCN Memory Card File Database.
+#include "GcnMcFileDb.hpp"
+
+// Qt includes.
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QRunnable>
+#include <QtCore/QStringList>
+#include <QtCore/QThreadPool>
+
+/** GcnMcFileDbManagerPrivate **/
+
+class GcnMcFileDbManagerPrivate
+{
+	public:
+		explicit GcnMcFileDbManagerPrivate(GcnMcFileDbManager *q);
+
+	protected:
+		GcnMcFileDbManager *const q_ptr;
+		Q_DECLARE_PUBLIC(GcnMcFileDbManager)
+	private:
+		Q_DISABLE_COPY(GcnMcFileDbManagerPrivate)
+
+	public:
+		static GcnMcFileDbManager *instance;
+
+		// Protects everything below.
+		mutable QMutex mutex;
+
+		/**
+		 * Loaded database file.
+		 * size and mtime are used to determine if
+		 * the file has to be reloaded.
+		 */
+		struct DbEntry {
+			GcnMcFileDbPtr db;
+			qint64 size;
+			qint64 mtime;
+		};
+
+		/**
+		 * Loaded database files.
+		 * - Key: Database filename.
+		 * - Value: DbEntry.
+		 */
+		QHash<QString, DbEntry> entries;
+
+		// Current snapshot, in GetDbFilenames() order.
+		GcnMcFileDbSnapshot dbs;
+
+		// If true, the database files have to be rechecked.
+		bool dirty;
+
+		// Error string.
+		QString errorString;
+
+		// File system watcher.
+		// NOTE: Only accessed from the manager's thread.
+		QFileSystemWatcher *watcher;
+
+		/**
+		 * Reload changed database files.
+		 * The mutex must be locked by the caller.
+		 */
+		void refresh(void);
+};
+
+// Singleton instance.
+GcnMcFileDbManager *GcnMcFileDbManagerPrivate::instance = nullptr;
+
+GcnMcFileDbManagerPrivate::GcnMcFileDbManagerPrivate(GcnMcFileDbManager *q)
+	: q_ptr(q)
+	, dirty(true)
+	, watcher(new QFileSystemWatcher(q))
+{
+	QObject::connect(watcher, &QFileSystemWatcher::fileChanged,
+			 q, &GcnMcFileDbManager::pathChanged_slot);
+	QObject::connect(watcher, &QFileSystemWatcher::directoryChanged,
+			 q, &GcnMcFileDbManager::pathChanged_slot);
+}
+
+/**
+ * Reload changed database files.
+ * The mutex must be locked by the caller.
+ */
+void GcnMcFileDbManagerPrivate::refresh(void)
+{
+	if (!dirty)
+		return;
+
+	Q_Q(GcnMcFileDbManager);
+	QHash<QString, DbEntry> newEntries;
+	GcnMcFileDbSnapshot newDbs;
+	QStringList watchPaths;
+	QString newErrorString;
+
+	const QVector<QString> dbFilenames = GcnMcFileDb::GetDbFilenames();
+	foreach (const QString &dbFilename, dbFilenames) {
+		const QFileInfo fileInfo(dbFilename);
+		const qint64 size = fileInfo.size();
+		const qint64 mtime = fileInfo.lastModified().toMSecsSinceEpoch();
+
+		// Watch the file and its directory.
+		watchPaths.append(fileInfo.absoluteFilePath());
+		if (!watchPaths.contains(fileInfo.absolutePath()))
+			watchPaths.append(fileInfo.absolutePath());
+
+		DbEntry entry;
+		auto iter = entries.constFind(dbFilename);
+		if (iter != entries.constEnd() &&
+		    iter->size == size && iter->mtime == mtime)
+		{
+			// File hasn't changed.
+			entry = *iter;
+		} else {
+			// File is new or has changed. (Re)load it.
+			GcnMcFileDb *db = new GcnMcFileDb();
+			int ret = db->load(dbFilename);
+			if (ret != 0) {
+				// TODO: Translate this message?
+				if (!newErrorString.isEmpty())
+					newErrorString += QChar(L'\n');
+				newErrorString += dbFilename + QLatin1String(": ") + db->errorString();
+				delete db;
+				continue;
+			}
+
+			// NOTE: The database may have been loaded
+			// in a background thread.
+			db->moveToThread(q->thread());
+			entry.db = GcnMcFileDbPtr(db);
+			entry.size = size;
+			entry.mtime = mtime;
+		}
+
+		newEntries.insert(dbFilename, entry);
+		newDbs.append(entry.db);
+	}
+
+	// NOTE: Databases that are no longer present are released
+	// here, but they stay alive as long as a snapshot uses them.
+	entries = newEntries;
+	dbs = newDbs;
+	errorString = newErrorString;
+	dirty = false;
+
+	// Update the watched paths in the manager's thread.
+	QMetaObject::invokeMethod(q, "setWatchedPaths_slot",
+		Qt::QueuedConnection, Q_ARG(QStringList, watchPaths));
+}
+
+/** GcnMcFileDbLoadTask **/
+
+/**
+ * Background database loading task.
+ */
+class GcnMcFileDbLoadTask : public QRunnable
+{
+	public:
+		explicit GcnMcFileDbLoadTask(GcnMcFileDbManager *manager)
+			: manager(manager)
+		{ }
+
+	private:
+		Q_DISABLE_COPY(GcnMcFileDbLoadTask)
+
+	public:
+		void run(void) final
+		{
+			// snapshot() reloads the databases if necessary.
+			manager->snapshot();
+		}
+
+	private:
+		GcnMcFileDbManager *const manager;
+};
+
+/** GcnMcFileDbManager **/
+
+GcnMcFileDbManager::GcnMcFileDbManager()
+	: super()
+	, d_ptr(new GcnMcFileDbManagerPrivate(this))
+{ }
+
+GcnMcFileDbManager::~GcnMcFileDbManager()
+{
+	Q_D(GcnMcFileDbManager);
+	delete d;
+}
+
+/**
+ * Get the GcnMcFileDbManager instance.
+ * NOTE: This must be called from the main thread first.
+ * @return GcnMcFileDbManager instance.
+ */
+GcnMcFileDbManager *GcnMcFileDbManager::instance(void)
+{
+	if (!GcnMcFileDbManagerPrivate::instance)
+		GcnMcFileDbManagerPrivate::instance = new GcnMcFileDbManager();
+	return GcnMcFileDbManagerPrivate::instance;
+}
+
+/**
+ * Load the databases in a background thread.
+ * snapshot() will wait for this to finish.
+ */
+void GcnMcFileDbManager::loadAsync(void)
+{
+	// NOTE: QThreadPool deletes the task when it's done.
+	QThreadPool::globalInstance()->start(new GcnMcFileDbLoadTask(this));
+}
+
+/**
+ * Get a snapshot of the loaded databases.
+ *
+ * If the databases haven't been loaded yet, or if any
+ * database file has changed, the databases will be
+ * (re)loaded first. Only changed files are reloaded.
+ *
+ * This function is thread-safe.
+ *
+ * @return Snapshot of the loaded databases. (May be empty.)
+ */
+GcnMcFileDbSnapshot GcnMcFileDbManager::snapshot(void)
+{
+	Q_D(GcnMcFileDbManager);
+	QMutexLocker locker(&d->mutex);
+	d->refresh();
+	return d->dbs;
+}
+
+/**
+ * Get the error string.
+ * This lists database files that couldn't be loaded.
+ * @return Error string.
+ */
+QString GcnMcFileDbManager::errorString(void) const
+{
+	Q_D(const GcnMcFileDbManager);
+	QMutexLocker locker(&d->mutex);
+	return d->errorString;
+}
+
+/** Slots. **/
+
+/**
+ * A watched database file or directory has changed.
+ * @param path Path of the changed file or directory.
+ */
+void GcnMcFileDbManager::pathChanged_slot(const QString &path)
+{
+	Q_UNUSED(path)
+	Q_D(GcnMcFileDbManager);
+	{
+		QMutexLocker locker(&d->mutex);
+		d->dirty = true;
+	}
+	emit databasesChanged();
+}
+
+/**
+ * Update the watched paths.
+ * @param paths Database files and directories to watch.
+ */
+void GcnMcFileDbManager::setWatchedPaths_slot(const QStringList &paths)
+{
+	Q_D(GcnMcFileDbManager);
+	QStringList oldPaths = d->watcher->files() + d->watcher->directories();
+	if (!oldPaths.isEmpty()) {
+		d->watcher->removePaths(oldPaths);
+	}
+	if (!paths.isEmpty()) {
+		d->watcher->addPaths(paths);
+	}
+}
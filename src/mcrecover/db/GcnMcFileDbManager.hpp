@@ -0,0 +1,105 @@
+/***************************************************************************
+ * GameCube Memory Card Recovery Program.                                  *
+ * GcnMcFileDbManager.hpp: GCN Memory Card File Database manager.          *
+ *                                                                         *
+ * Copyright (c) 2026 by David Korth.                                      *
+ * SPDX-License-Identifier: GPL-2.0-or-later                               *
+ ***************************************************************************/
+
+#ifndef __MCRECOVER_DB_GCNMCFILEDBMANAGER_HPP__
+#define __MCRECOVER_DB_GCNMCFILEDBMANAGER_HPP__
+
+// Qt includes.
+#include <QtCore/QObject>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+class GcnMcFileDb;
+
+/**
+ * Shared GCN Memory Card File database.
+ * Databases are immutable once loaded, so they can be
+ * used by multiple threads at the same time.
+ */
+typedef QSharedPointer<const GcnMcFileDb> GcnMcFileDbPtr;
+
+/**
+ * Snapshot of all loaded GCN Memory Card File databases.
+ * A snapshot keeps its databases alive even if the
+ * manager reloads them afterwards.
+ */
+typedef QVector<GcnMcFileDbPtr> GcnMcFileDbSnapshot;
+
+class GcnMcFileDbManagerPrivate;
+class GcnMcFileDbManager : public QObject
+{
+	Q_OBJECT
+	typedef QObject super;
+
+	private:
+		GcnMcFileDbManager();
+		virtual ~GcnMcFileDbManager();
+
+	protected:
+		GcnMcFileDbManagerPrivate *const d_ptr;
+		Q_DECLARE_PRIVATE(GcnMcFileDbManager)
+	private:
+		Q_DISABLE_COPY(GcnMcFileDbManager)
+
+	public:
+		/**
+		 * Get the GcnMcFileDbManager instance.
+		 * NOTE: This must be called from the main thread first.
+		 * @return GcnMcFileDbManager instance.
+		 */
+		static GcnMcFileDbManager *instance(void);
+
+		/**
+		 * Load the databases in a background thread.
+		 * snapshot() will wait for this to finish.
+		 */
+		void loadAsync(void);
+
+		/**
+		 * Get a snapshot of the loaded databases.
+		 *
+		 * If the databases haven't been loaded yet, or if any
+		 * database file has changed, the databases will be
+		 * (re)loaded first. Only changed files are reloaded.
+		 *
+		 * This function is thread-safe.
+		 *
+		 * @return Snapshot of the loaded databases. (May be empty.)
+		 */
+		GcnMcFileDbSnapshot snapshot(void);
+
+		/**
+		 * Get the error string.
+		 * This lists database files that couldn't be loaded.
+		 * @return Error string.
+		 */
+		QString errorString(void) const;
+
+	signals:
+		/**
+		 * A database file has been added, changed, or removed.
+		 * The databases will be reloaded on the next snapshot().
+		 */
+		void databasesChanged(void);
+
+	private slots:
+		/**
+		 * A watched database file or directory has changed.
+		 * @param path Path of the changed file or directory.
+		 */
+		void pathChanged_slot(const QString &path);
+
+		/**
+		 * Update the watched paths.
+		 * @param paths Database files and directories to watch.
+		 */
+		void setWatchedPaths_slot(const QStringList &paths);
+};
+
+#endif /* __MCRECOVER_DB_GCNMCFILEDBMANAGER_HPP__ */
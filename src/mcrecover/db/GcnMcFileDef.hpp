@@ -14,12 +14,14 @@
 #include <string.h>
 
 // Qt includes.
+#include <QtCore/QByteArray>
 #include <QtCore/QString>
 #include <QtCore/QHash>
 #include <QtCore/QRegularExpression>
 
 #include "Checksum.hpp"
 #include "VarModifierDef.hpp"
+#include "VarReplace.hpp"
 
 class GcnMcFileDef {
 	public:
@@ -67,6 +69,16 @@ class GcnMcFileDef {
 			// Regular expressions.
 			QRegularExpression gameDesc_regex;
 			QRegularExpression fileDesc_regex;
+
+			/**
+			 * Literal prefixes of the regular expressions.
+			 * If a pattern is anchored with '^' and starts with
+			 * literal ASCII characters, the comment bytes must
+			 * start with these characters in order to match.
+			 * Empty if no prefix could be determined.
+			 */
+			QByteArray gameDesc_prefix;
+			QByteArray fileDesc_prefix;
 		} search;
 
 		/**
@@ -77,6 +89,9 @@ class GcnMcFileDef {
 
 		struct {
 			QString filename;
+			// Compiled filename template.
+			VarReplace::Template filename_tmpl;
+
 			uint8_t bannerFormat;
 			uint32_t iconAddress;
 			uint16_t iconFormat;
@@ -95,6 +110,12 @@ class GcnMcFileDef {
 		 */
 		QHash<QString, VarModifierDef> varModifiers;
 
+		/**
+		 * Compiled variable modifiers.
+		 * Built from varModifiers.
+		 */
+		VarReplace::Modifiers varModifiers_compiled;
+
 		// Make sure all fields are initialized.
 		GcnMcFileDef()
 		{
@@ -13,6 +13,7 @@
 
 // GCN Memory Card File Database.
 #include "db/GcnMcFileDb.hpp"
+#include "db/GcnMcFileDbManager.hpp"
 
 // Worker object.
 #include "GcnSearchWorker.hpp"
@@ -21,6 +22,8 @@
 using std::list;
 
 // Qt includes.
+#include <QtCore/QCoreApplication>
+#include <QtCore/QHash>
 #include <QtCore/QStack>
 #include <QtCore/QThread>
 
@@ -38,7 +41,7 @@ class GcnSearchThreadPrivate
 
 	public:
 		// GCN Memory Card File databases.
-		QVector<GcnMcFileDb*> dbs;
+		GcnMcFileDbSnapshot dbs;
 
 		// Worker object.
 		// NOTE: This object cannot have a parent;
@@ -48,22 +51,91 @@ class GcnSearchThreadPrivate
 		// Worker thread.
 		QThread *workerThread;
 
+		// Stream search results?
+		bool streamResults;
+
+		// Has the current search emitted searchStarted()?
+		bool searchActive;
+
+		/**
+		 * Workers that were replaced by a new search
+		 * while they were still running, and their threads.
+		 * They're deleted once they've stopped.
+		 */
+		QHash<GcnSearchWorker*, QThread*> retiredWorkers;
+
+		/**
+		 * Create a worker object and connect its signals.
+		 * @return Worker object.
+		 */
+		GcnSearchWorker *createWorker(void);
+
 		/**
 		 * Stop the worker thread.
 		 */
 		void stopWorkerThread(void);
+
+		/**
+		 * Cancel the running search without waiting for it,
+		 * and replace the worker so a new search can be started.
+		 * The old worker is deleted once it has stopped.
+		 */
+		void retireWorker(void);
+
+		/**
+		 * Delete a retired worker once it has stopped.
+		 * @param oldWorker Retired worker.
+		 */
+		void deleteRetiredWorker(GcnSearchWorker *oldWorker);
 };
 
 GcnSearchThreadPrivate::GcnSearchThreadPrivate(GcnSearchThread* q)
 	: q_ptr(q)
-	, worker(new GcnSearchWorker())
+	, worker(nullptr)
 	, workerThread(nullptr)
+	, streamResults(false)
+	, searchActive(false)
+{
+	worker = createWorker();
+}
+
+GcnSearchThreadPrivate::~GcnSearchThreadPrivate()
 {
-	// Signal passthrough.
+	// Stop all running searches.
+	for (auto iter = retiredWorkers.begin(); iter != retiredWorkers.end(); ++iter) {
+		iter.key()->cancel();
+		QThread *const thread = iter.value();
+		thread->quit();
+		thread->wait();
+		delete thread;
+		delete iter.key();
+	}
+	retiredWorkers.clear();
+
+	if (workerThread) {
+		worker->cancel();
+		stopWorkerThread();
+	}
+	delete worker;
+}
+
+/**
+ * Create a worker object and connect its signals.
+ * @return Worker object.
+ */
+GcnSearchWorker *GcnSearchThreadPrivate::createWorker(void)
+{
+	Q_Q(GcnSearchThread);
+	GcnSearchWorker *const worker = new GcnSearchWorker();
+
+	// Signals are relayed through slots so signals
+	// from retired workers can be ignored.
 	QObject::connect(worker, &GcnSearchWorker::searchStarted,
-			 q, &GcnSearchThread::searchStarted);
+			 q, &GcnSearchThread::searchStarted_slot);
 	QObject::connect(worker, &GcnSearchWorker::searchUpdate,
-			 q, &GcnSearchThread::searchUpdate);
+			 q, &GcnSearchThread::searchUpdate_slot);
+	QObject::connect(worker, &GcnSearchWorker::filesFound,
+			 q, &GcnSearchThread::filesFound_slot);
 
 	// We have to handle these signals in order to move
 	// the worker object back to the main thread.
@@ -73,13 +145,8 @@ GcnSearchThreadPrivate::GcnSearchThreadPrivate(GcnSearchThread* q)
 			 q, &GcnSearchThread::searchFinished_slot);
 	QObject::connect(worker, &GcnSearchWorker::searchError,
 			 q, &GcnSearchThread::searchError_slot);
-}	
 
-GcnSearchThreadPrivate::~GcnSearchThreadPrivate()
-{
-	delete worker;
-	qDeleteAll(dbs);
-	dbs.clear();
+	return worker;
 }
 
 /**
@@ -97,6 +164,47 @@ void GcnSearchThreadPrivate::stopWorkerThread(void)
 	workerThread = nullptr;
 }
 
+/**
+ * Cancel the running search without waiting for it,
+ * and replace the worker so a new search can be started.
+ * The old worker is deleted once it has stopped.
+ */
+void GcnSearchThreadPrivate::retireWorker(void)
+{
+	if (!workerThread)
+		return;
+
+	worker->cancel();
+	retiredWorkers.insert(worker, workerThread);
+	worker = createWorker();
+	workerThread = nullptr;
+
+	if (searchActive) {
+		// The old search won't send any more signals.
+		searchActive = false;
+		Q_Q(GcnSearchThread);
+		emit q->searchCancelled();
+	}
+}
+
+/**
+ * Delete a retired worker once it has stopped.
+ * @param oldWorker Retired worker.
+ */
+void GcnSearchThreadPrivate::deleteRetiredWorker(GcnSearchWorker *oldWorker)
+{
+	QThread *const thread = retiredWorkers.take(oldWorker);
+	if (!thread)
+		return;
+
+	// The worker moves itself back to this thread
+	// once the search function returns.
+	thread->quit();
+	thread->wait();
+	delete thread;
+	oldWorker->deleteLater();
+}
+
 /** GcnSearchThread **/
 
 GcnSearchThread::GcnSearchThread(QObject *parent)
@@ -126,32 +234,52 @@ QString GcnSearchThread::errorString(void) const
 	return d->worker->errorString();
 }
 
-/** Functions. **/
+/** Properties. **/
+
+/**
+ * Is a search currently running?
+ * @return True if a search is running; false if not.
+ */
+bool GcnSearchThread::isSearching(void) const
+{
+	Q_D(const GcnSearchThread);
+	return (d->workerThread != nullptr);
+}
 
 /**
- * Load multiple GCN Memory Card File databases.
- * @param dbFilenames Filenames of GCN Memory Card File database.
- * @return 0 on success; non-zero on error. (Check error string!)
+ * Are search results streamed?
+ * @return True if filesFound() is emitted during the search; false if not.
  */
-int GcnSearchThread::loadGcnMcFileDbs(const QVector<QString> &dbFilenames)
+bool GcnSearchThread::streamResults(void) const
+{
+	Q_D(const GcnSearchThread);
+	return d->streamResults;
+}
+
+/**
+ * Should search results be streamed?
+ * If true, filesFound() is emitted with batches of files
+ * while the search is running.
+ * filesFoundList() is populated regardless of this setting.
+ * @param streamResults True to stream results; false to not.
+ */
+void GcnSearchThread::setStreamResults(bool streamResults)
 {
 	Q_D(GcnSearchThread);
-	qDeleteAll(d->dbs);
-	d->dbs.clear();
+	d->streamResults = streamResults;
+}
 
-	if (dbFilenames.isEmpty())
-		return 0;
+/** Functions. **/
 
-	// Load the databases.
-	foreach (const QString &dbFilename, dbFilenames) {
-		GcnMcFileDb *db = new GcnMcFileDb(this);
-		int ret = db->load(dbFilename);
-		if (!ret) {
-			d->dbs.append(db);
-		} else {
-			delete db;
-		}
-	}
+/**
+ * Load the GCN Memory Card File databases.
+ * This uses a snapshot from GcnMcFileDbManager.
+ * @return 0 on success; non-zero on error. (no databases loaded)
+ */
+int GcnSearchThread::loadDatabases(void)
+{
+	Q_D(GcnSearchThread);
+	d->dbs = GcnMcFileDbManager::instance()->snapshot();
 
 	// TODO: Report if any DBs were unable to be loaded.
 	// For now, just error if no DBs could be loaded.
@@ -189,10 +317,10 @@ int GcnSearchThread::searchMemCard(GcnCard *card, char preferredRegion, bool sea
 {
 	Q_D(GcnSearchThread);
 
-	// TODO: Mutex?
 	if (d->workerThread) {
-		// Thread is running.
-		return -255;	// TODO: Error code constant?
+		// A search is already running.
+		// Cancel it and start a new one.
+		d->retireWorker();
 	}
 
 	// Don't do anything if no databases are loaded.
@@ -204,6 +332,7 @@ int GcnSearchThread::searchMemCard(GcnCard *card, char preferredRegion, bool sea
 	d->worker->setDatabases(d->dbs);
 	d->worker->setPreferredRegion(preferredRegion);
 	d->worker->setSearchUsedBlocks(searchUsedBlocks);
+	d->worker->setStreamResults(d->streamResults);
 	d->worker->setOrigThread(nullptr);
 
 	// Search for files.
@@ -223,15 +352,18 @@ int GcnSearchThread::searchMemCard(GcnCard *card, char preferredRegion, bool sea
  * - searchCancelled(): Search was cancelled. No files found.
  * - searchFinished(): Search has completed.
  * - searchError(): Search failed due to an error.
+ *
+ * If a search is already running, it's cancelled, and the
+ * new search is started without waiting for it to stop.
  */
 int GcnSearchThread::searchMemCard_async(GcnCard *card, char preferredRegion, bool searchUsedBlocks)
 {
 	Q_D(GcnSearchThread);
 
-	// TODO: Mutex?
 	if (d->workerThread) {
-		// Thread is already running.
-		return -255;	// TODO: Error code constant?
+		// A search is already running.
+		// Cancel it and start a new one.
+		d->retireWorker();
 	}
 
 	// Don't do anything if no databases are loaded.
@@ -248,8 +380,14 @@ int GcnSearchThread::searchMemCard_async(GcnCard *card, char preferredRegion, bo
 	d->worker->setDatabases(d->dbs);
 	d->worker->setPreferredRegion(preferredRegion);
 	d->worker->setSearchUsedBlocks(searchUsedBlocks);
+	d->worker->setStreamResults(d->streamResults);
 	d->worker->setOrigThread(QThread::currentThread());
 
+	// Clear interruption requests from the previous search.
+	// cancel() or pause() may have been called after the worker
+	// cleared them, but before searchFinished_slot() ran.
+	d->worker->clearInterrupt();
+
 	connect(d->workerThread, &QThread::started,
 		d->worker, &GcnSearchWorker::searchMemCard_threaded);
 
@@ -260,14 +398,140 @@ int GcnSearchThread::searchMemCard_async(GcnCard *card, char preferredRegion, bo
 	return 0;
 }
 
+/** Interruption. **/
+
+/**
+ * Cancel the running search.
+ * searchCancelled() is emitted once the search has stopped.
+ * @param wait If true, wait for the search to stop before returning.
+ */
+void GcnSearchThread::cancel(bool wait)
+{
+	Q_D(GcnSearchThread);
+	if (!d->workerThread && d->retiredWorkers.isEmpty()) {
+		// No search is running.
+		return;
+	}
+	if (d->workerThread) {
+		d->worker->cancel();
+	}
+	if (!wait)
+		return;
+
+	// Retired workers were cancelled when they were
+	// replaced, but they may still be running.
+	foreach (QThread *thread, d->retiredWorkers) {
+		thread->quit();
+		thread->wait();
+	}
+
+	// The worker moves itself back to this thread
+	// before the worker thread exits.
+	d->stopWorkerThread();
+
+	// Deliver the workers' queued signals now, so
+	// searchCancelled() is emitted before returning
+	// and can't be mistaken for a later search's.
+	QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+/**
+ * Pause the running search.
+ */
+void GcnSearchThread::pause(void)
+{
+	Q_D(GcnSearchThread);
+	if (!d->workerThread) {
+		// No search is running.
+		return;
+	}
+	d->worker->pause();
+}
+
+/**
+ * Resume a paused search.
+ */
+void GcnSearchThread::resume(void)
+{
+	Q_D(GcnSearchThread);
+	if (!d->workerThread) {
+		// No search is running.
+		return;
+	}
+	d->worker->resume();
+}
+
+/**
+ * Is the search paused?
+ * @return True if paused; false if not.
+ */
+bool GcnSearchThread::isPaused(void) const
+{
+	Q_D(const GcnSearchThread);
+	return (d->workerThread && d->worker->isPaused());
+}
+
 /** Slots. **/
 
+/**
+ * Search has started.
+ * @param totalPhysBlocks Total number of blocks in the card.
+ * @param totalSearchBlocks Number of blocks being searched.
+ * @param firstPhysBlock First block being searched.
+ */
+void GcnSearchThread::searchStarted_slot(int totalPhysBlocks, int totalSearchBlocks, int firstPhysBlock)
+{
+	Q_D(GcnSearchThread);
+	if (sender() != d->worker)
+		return;
+
+	d->searchActive = true;
+	emit searchStarted(totalPhysBlocks, totalSearchBlocks, firstPhysBlock);
+}
+
+/**
+ * Update search status.
+ * @param currentPhysBlock Current physical block number being searched.
+ * @param currentSearchBlock Number of blocks searched so far.
+ * @param lostFilesFound Number of "lost" files found.
+ * @param blankBlocksSkipped Number of blank blocks skipped so far.
+ */
+void GcnSearchThread::searchUpdate_slot(int currentPhysBlock, int currentSearchBlock, int lostFilesFound, int blankBlocksSkipped)
+{
+	Q_D(GcnSearchThread);
+	if (sender() != d->worker)
+		return;
+
+	emit searchUpdate(currentPhysBlock, currentSearchBlock, lostFilesFound, blankBlocksSkipped);
+}
+
+/**
+ * "Lost" files have been found. (streaming mode only)
+ * @param files Files found since the previous batch.
+ */
+void GcnSearchThread::filesFound_slot(const QVector<GcnSearchData> &files)
+{
+	Q_D(GcnSearchThread);
+	if (sender() != d->worker)
+		return;
+
+	emit filesFound(files);
+}
+
 /**
  * Search has been cancelled.
  */
 void GcnSearchThread::searchCancelled_slot(void)
 {
 	Q_D(GcnSearchThread);
+	GcnSearchWorker *const sender_worker = qobject_cast<GcnSearchWorker*>(sender());
+	if (sender_worker && sender_worker != d->worker) {
+		// Retired worker has stopped.
+		d->deleteRetiredWorker(sender_worker);
+		return;
+	}
+
+	d->searchActive = false;
 	if (d->workerThread) {
 		// Worker moved itself back to this thread.
 		d->stopWorkerThread();
@@ -283,6 +547,15 @@ void GcnSearchThread::searchCancelled_slot(void)
 void GcnSearchThread::searchFinished_slot(int lostFilesFound)
 {
 	Q_D(GcnSearchThread);
+	GcnSearchWorker *const sender_worker = qobject_cast<GcnSearchWorker*>(sender());
+	if (sender_worker && sender_worker != d->worker) {
+		// Retired worker has stopped.
+		// (It finished before it noticed the cancellation.)
+		d->deleteRetiredWorker(sender_worker);
+		return;
+	}
+
+	d->searchActive = false;
 	if (d->workerThread) {
 		// Worker moved itself back to this thread.
 		d->stopWorkerThread();
@@ -298,6 +571,14 @@ void GcnSearchThread::searchFinished_slot(int lostFilesFound)
 void GcnSearchThread::searchError_slot(const QString &errorString)
 {
 	Q_D(GcnSearchThread);
+	GcnSearchWorker *const sender_worker = qobject_cast<GcnSearchWorker*>(sender());
+	if (sender_worker && sender_worker != d->worker) {
+		// Retired worker has stopped.
+		d->deleteRetiredWorker(sender_worker);
+		return;
+	}
+
+	d->searchActive = false;
 	if (d->workerThread) {
 		// Worker moved itself back to this thread.
 		d->stopWorkerThread();
@@ -65,8 +65,21 @@ class GcnSearchThread : public QObject
 		 * @param currentPhysBlock Current physical block number being searched.
 		 * @param currentSearchBlock Number of blocks searched so far.
 		 * @param lostFilesFound Number of "lost" files found.
+		 * @param blankBlocksSkipped Number of blank blocks skipped so far.
 		 */
-		void searchUpdate(int currentPhysBlock, int currentSearchBlock, int lostFilesFound);
+		void searchUpdate(int currentPhysBlock, int currentSearchBlock, int lostFilesFound, int blankBlocksSkipped);
+
+		/**
+		 * "Lost" files have been found. (streaming mode only)
+		 *
+		 * Batches are emitted while the search is running.
+		 * Each batch is sorted by block number, and all of its
+		 * files have lower block numbers than the files in
+		 * previous batches.
+		 *
+		 * @param files Files found since the previous batch.
+		 */
+		void filesFound(const QVector<GcnSearchData> &files);
 
 		/**
 		 * An error has occurred during the search.
@@ -88,19 +101,36 @@ class GcnSearchThread : public QObject
 		QString errorString(void) const;
 
 	public:
+		/** Properties. **/
+
 		/**
-		 * Load a GCN Memory Card File database.
-		 * @param dbFilename Filename of GCN Memory Card File database.
-		 * @return 0 on success; non-zero on error. (Check error string!)
+		 * Is a search currently running?
+		 * @return True if a search is running; false if not.
 		 */
-		inline int loadGcnMcFileDb(const QString &dbFilename);
+		bool isSearching(void) const;
 
 		/**
-		 * Load multiple GCN Memory Card File databases.
-		 * @param dbFilenames Filenames of GCN Memory Card File database.
-		 * @return 0 on success; non-zero on error. (Check error string!)
+		 * Are search results streamed?
+		 * @return True if filesFound() is emitted during the search; false if not.
 		 */
-		int loadGcnMcFileDbs(const QVector<QString> &dbFilenames);
+		bool streamResults(void) const;
+
+		/**
+		 * Should search results be streamed?
+		 * If true, filesFound() is emitted with batches of files
+		 * while the search is running.
+		 * filesFoundList() is populated regardless of this setting.
+		 * @param streamResults True to stream results; false to not.
+		 */
+		void setStreamResults(bool streamResults);
+
+	public:
+		/**
+		 * Load the GCN Memory Card File databases.
+		 * This uses a snapshot from GcnMcFileDbManager.
+		 * @return 0 on success; non-zero on error. (no databases loaded)
+		 */
+		int loadDatabases(void);
 
 		/**
 		 * Get the list of files found in the last successful search.
@@ -138,6 +168,9 @@ class GcnSearchThread : public QObject
 		 * - searchFinished(): Search has completed.
 		 * - searchError(): Search failed due to an error.
 		 *
+		 * If a search is already running, it's cancelled, and the
+		 * new search is started without waiting for it to stop.
+		 *
 		 * NOTE: If the search could not be done asynchronously, it will
 		 * be done synchronously, though the signals will still be emitted.
 		 *
@@ -146,7 +179,55 @@ class GcnSearchThread : public QObject
 		 */
 		int searchMemCard_async(GcnCard *card, char preferredRegion = 0, bool searchUsedBlocks = false);
 
+		/** Interruption. **/
+
+		/**
+		 * Cancel the running search.
+		 * searchCancelled() is emitted once the search has stopped.
+		 * @param wait If true, wait for the search to stop before returning.
+		 */
+		void cancel(bool wait = false);
+
+		/**
+		 * Pause the running search.
+		 */
+		void pause(void);
+
+		/**
+		 * Resume a paused search.
+		 */
+		void resume(void);
+
+		/**
+		 * Is the search paused?
+		 * @return True if paused; false if not.
+		 */
+		bool isPaused(void) const;
+
 	private slots:
+		/**
+		 * Search has started.
+		 * @param totalPhysBlocks Total number of blocks in the card.
+		 * @param totalSearchBlocks Number of blocks being searched.
+		 * @param firstPhysBlock First block being searched.
+		 */
+		void searchStarted_slot(int totalPhysBlocks, int totalSearchBlocks, int firstPhysBlock);
+
+		/**
+		 * Update search status.
+		 * @param currentPhysBlock Current physical block number being searched.
+		 * @param currentSearchBlock Number of blocks searched so far.
+		 * @param lostFilesFound Number of "lost" files found.
+		 * @param blankBlocksSkipped Number of blank blocks skipped so far.
+		 */
+		void searchUpdate_slot(int currentPhysBlock, int currentSearchBlock, int lostFilesFound, int blankBlocksSkipped);
+
+		/**
+		 * "Lost" files have been found. (streaming mode only)
+		 * @param files Files found since the previous batch.
+		 */
+		void filesFound_slot(const QVector<GcnSearchData> &files);
+
 		/**
 		 * Search has been cancelled.
 		 */
@@ -165,16 +246,4 @@ class GcnSearchThread : public QObject
 		void searchError_slot(const QString &errorString);
 };
 
-/**
- * Load a GCN Memory Card File database.
- * @param dbFilename Filename of GCN Memory Card File database.
- * @return 0 on success; non-zero on error. (Check error string!)
- */
-inline int GcnSearchThread::loadGcnMcFileDb(const QString &dbFilename)
-{
-	QVector<QString> dbFilenames;
-	dbFilenames.append(dbFilename);
-	return loadGcnMcFileDbs(dbFilenames);
-}
-
 #endif /* __MCRECOVER_SEARCHTHREAD_HPP__ */
@@ -16,18 +16,29 @@
 
 // Checksum algorithm class.
 #include "Checksum.hpp"
+// Blank block detection.
+#include "ByteScan.hpp"
+#include "util/log.h"
 
 // C includes. (C++ namespace)
-#include <cstdio>
+#include <cerrno>
 
 // C++ includes.
+#include <algorithm>
 #include <limits>
 #include <memory>
 using std::list;
 using std::unique_ptr;
 
 // Qt includes.
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
 #include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
 
 /** GcnSearchWorkerPrivate **/
 
@@ -56,12 +67,93 @@ class GcnSearchWorkerPrivate
 
 		// Properties.
 		GcnCard *card;
-		QVector<GcnMcFileDb*> databases;
+		GcnMcFileDbSnapshot databases;
 		char preferredRegion;
 		bool searchUsedBlocks;
+		int threadCount;
+		bool streamResults;
 
 		// Original thread.
 		QThread *origThread;
+
+		// Minimum interval between searchUpdate() signals, in milliseconds. (~30 Hz)
+		static const int PROGRESS_UPDATE_INTERVAL = 33;
+
+		// Streaming mode.
+		// Minimum interval between filesFound() batches, in milliseconds.
+		static const int STREAM_BATCH_INTERVAL = 50;
+		// Files found since the last filesFound() batch.
+		// (blockSearchList order, i.e. descending block numbers)
+		QVector<GcnSearchData> pendingFiles;
+		// Time since the last filesFound() batch.
+		QElapsedTimer batchTimer;
+
+		/**
+		 * Emit pending files as a filesFound() batch.
+		 * If force is false, nothing is emitted if the previous
+		 * batch was emitted less than STREAM_BATCH_INTERVAL ms ago.
+		 * @param force If true, emit the pending files regardless of the interval.
+		 */
+		void flushFoundFiles(bool force);
+
+		// Interruption requests.
+		QAtomicInt cancelRequested;
+		QAtomicInt pauseRequested;
+		// Paused scanning threads wait on pauseCond.
+		mutable QMutex pauseMutex;
+		mutable QWaitCondition pauseCond;
+
+		/**
+		 * Check if the search should stop.
+		 * If the search is paused, this blocks until
+		 * the search is either resumed or cancelled.
+		 *
+		 * This is called before every block by each
+		 * scanning thread.
+		 *
+		 * @return True if the search was cancelled; false to continue.
+		 */
+		bool checkInterrupt(void) const;
+
+		/**
+		 * Clear the interruption requests.
+		 * This is done when searchMemCard() returns.
+		 */
+		void clearInterrupt(void);
+
+		/**
+		 * Check a block against all loaded databases.
+		 *
+		 * This function is thread-safe as long as each thread
+		 * uses its own block buffer.
+		 *
+		 * Blank blocks (all 0x00 or all 0xFF) can't contain
+		 * a file comment, so they're skipped without checking
+		 * the databases.
+		 *
+		 * @param buf		[out] Block buffer. (must be at least blockSize bytes; unused if the card is memory-mapped)
+		 * @param blockSize	[in] Block size.
+		 * @param physBlock	[in] Physical block number.
+		 * @param pIsBlank	[out,opt] Set to true if the block is blank; false if not.
+		 * @return Search data entries matching this block. (empty if none)
+		 */
+		QVector<GcnSearchData> scanBlock(uint8_t *buf, int blockSize, uint16_t physBlock, bool *pIsBlank = nullptr) const;
+
+		/**
+		 * Add a "lost" file found at the specified block.
+		 * This selects an entry based on the preferred region,
+		 * constructs its FAT entries, and claims its blocks
+		 * in the used block map.
+		 *
+		 * NOTE: This must be called in blockSearchList order
+		 * in order to produce consistent FAT entries.
+		 *
+		 * @param searchDataEntries	[in] Search data entries matching this block. (must not be empty)
+		 * @param physBlock		[in] Physical block number.
+		 * @param usedBlockMap		[in/out] Used block map.
+		 */
+		void addFoundFile(const QVector<GcnSearchData> &searchDataEntries,
+				  uint16_t physBlock, QVector<uint8_t> &usedBlockMap);
 };
 
 GcnSearchWorkerPrivate::GcnSearchWorkerPrivate(GcnSearchWorker* q)
@@ -69,15 +161,338 @@ GcnSearchWorkerPrivate::GcnSearchWorkerPrivate(GcnSearchWorker* q)
 	, card(nullptr)
 	, preferredRegion(0)
 	, searchUsedBlocks(false)
+	, threadCount(0)
+	, streamResults(false)
 	, origThread(nullptr)
 { }
 
+/**
+ * Check a block against all loaded databases.
+ *
+ * This function is thread-safe as long as each thread
+ * uses its own block buffer.
+ *
+ * Blank blocks (all 0x00 or all 0xFF) can't contain
+ * a file comment, so they're skipped without checking
+ * the databases.
+ *
+ * @param buf		[out] Block buffer. (must be at least blockSize bytes; unused if the card is memory-mapped)
+ * @param blockSize	[in] Block size.
+ * @param physBlock	[in] Physical block number.
+ * @param pIsBlank	[out,opt] Set to true if the block is blank; false if not.
+ * @return Search data entries matching this block. (empty if none)
+ */
+QVector<GcnSearchData> GcnSearchWorkerPrivate::scanBlock(uint8_t *buf, int blockSize, uint16_t physBlock, bool *pIsBlank) const
+{
+	QVector<GcnSearchData> searchDataEntries;
+	if (pIsBlank) {
+		*pIsBlank = false;
+	}
+
+	// If the card is memory-mapped, check the block in place.
+	const uint8_t *blockData = card->blockPtr(physBlock);
+	if (!blockData) {
+		int ret = card->readBlock(buf, blockSize, physBlock);
+		if (ret != blockSize) {
+			// Error reading block.
+			LOG(LOGLEVEL_ERROR, "Cannot read block %d - readBlock() returned %d.\n", physBlock, ret);
+			return searchDataEntries;
+		}
+		blockData = buf;
+	}
+
+	// Skip blank blocks.
+	if (ByteScan::isBlank(blockData, blockSize)) {
+		if (pIsBlank) {
+			*pIsBlank = true;
+		}
+		return searchDataEntries;
+	}
+
+	// Check the block in the databases.
+	foreach (const GcnMcFileDbPtr &db, databases) {
+		searchDataEntries += db->checkBlock(blockData, blockSize);
+	}
+
+	return searchDataEntries;
+}
+
+/**
+ * Add a "lost" file found at the specified block.
+ * This selects an entry based on the preferred region,
+ * constructs its FAT entries, and claims its blocks
+ * in the used block map.
+ *
+ * NOTE: This must be called in blockSearchList order
+ * in order to produce consistent FAT entries.
+ *
+ * @param searchDataEntries	[in] Search data entries matching this block. (must not be empty)
+ * @param physBlock		[in] Physical block number.
+ * @param usedBlockMap		[in/out] Used block map.
+ */
+void GcnSearchWorkerPrivate::addFoundFile(const QVector<GcnSearchData> &searchDataEntries,
+					  uint16_t physBlock, QVector<uint8_t> &usedBlockMap)
+{
+	const int totalPhysBlocks = card->totalPhysBlocks();
+
+	GcnSearchData searchData;
+	if (searchDataEntries.size() == 1 || preferredRegion == 0) {
+		// Only one entry, or no preferred region.
+		searchData = searchDataEntries.at(0);
+	} else {
+		// Find an entry matching the preferred region.
+		bool isMatch = false;
+		for (int i = 0; i < searchDataEntries.size(); i++) {
+			const GcnSearchData &schk = searchDataEntries.at(i);
+			if (schk.dirEntry.gamecode[3] == preferredRegion) {
+				// Found a match!
+				searchData = schk;
+				isMatch = true;
+				break;
+			}
+		}
+
+		if (!isMatch) {
+			// No region match. Use the first entry.
+			searchData = searchDataEntries.at(0);
+		}
+	}
+
+	// NOTE: GcnMcFileDb doesn't initialize fatEntries.
+	// Hence, we have to make a copy and initialize the list.
+	LOG(LOGLEVEL_INFO, "FOUND A MATCH: %-.4s%-.2s %-.32s\n",
+		searchData.dirEntry.gamecode,
+		searchData.dirEntry.company,
+		searchData.dirEntry.filename);
+	LOG(LOGLEVEL_DEBUG, "bannerFmt == %02X, iconAddress == %08X, iconFormat == %02X, iconSpeed == %02X\n",
+		searchData.dirEntry.bannerfmt,
+		searchData.dirEntry.iconaddr,
+		searchData.dirEntry.iconfmt,
+		searchData.dirEntry.iconspeed);
+
+	// NOTE: dirEntry's block start is not set by d->db->checkBlock().
+	// Set it here.
+	searchData.dirEntry.block = physBlock;
+	if (searchData.dirEntry.length == 0) {
+		// This only happens if an entry is either
+		// missing a <dirEntry>, or has <length>0</length>.
+		// TODO: Check for this in GcnMcFileDb.
+		searchData.dirEntry.length = 1;
+	}
+
+	// Construct the FAT entries for this file.
+	searchData.fatEntries.clear();
+	searchData.fatEntries.reserve(searchData.dirEntry.length);
+
+	// First block is always valid.
+	searchData.fatEntries.append(searchData.dirEntry.block);
+	if (usedBlockMap[searchData.dirEntry.block] < std::numeric_limits<uint8_t>::max())
+		usedBlockMap[searchData.dirEntry.block]++;
+
+	uint16_t blocksRemaining = (searchData.dirEntry.length - 1);
+	uint16_t block = (searchData.dirEntry.block + 1);
+	bool wasWrapped = false;
+
+	// Skip used blocks and go after empty blocks only.
+	while (blocksRemaining > 0) {
+		if (block >= totalPhysBlocks) {
+			// Wraparound.
+			// Do NOT mark the wrapped blocks as used,
+			// since they might be used by actual files.
+			block = 5;
+			wasWrapped = true;
+			continue;
+		} else if (block == searchData.dirEntry.block) {
+			// ERROR: We wrapped around!
+			// Use the "naive" algorithm after the last valid block.
+			break;
+		}
+
+		// Check if this block is used.
+		if (usedBlockMap[block] == 0) {
+			// Block is not used.
+			searchData.fatEntries.append(block);
+			if (!wasWrapped)
+				usedBlockMap[block]++;
+			blocksRemaining--;
+		}
+
+		// Next block.
+		block++;
+	}
+
+	// Naive block algorithm for the remaining blocks.
+	block = (searchData.fatEntries.value(searchData.fatEntries.size() - 1) + 1);
+	wasWrapped = false;
+	while (blocksRemaining > 0) {
+		if (block >= totalPhysBlocks) {
+			// Wraparound.
+			// Do NOT mark the wrapped blocks as used,
+			// since they might be used by actual files.
+			block = 5;
+			continue;
+		}
+
+		// Add this block.
+		searchData.fatEntries.append(block);
+		if (usedBlockMap[block] < std::numeric_limits<uint8_t>::max()) {
+			if (!wasWrapped)
+				usedBlockMap[block]++;
+		}
+		block++;
+		blocksRemaining--;
+	}
+
+	// Add the search data to the list. (front of list)
+	filesFoundList.push_front(searchData);
+	if (streamResults) {
+		pendingFiles.append(searchData);
+	}
+}
+
+/**
+ * Emit pending files as a filesFound() batch.
+ * If force is false, nothing is emitted if the previous
+ * batch was emitted less than STREAM_BATCH_INTERVAL ms ago.
+ * @param force If true, emit the pending files regardless of the interval.
+ */
+void GcnSearchWorkerPrivate::flushFoundFiles(bool force)
+{
+	if (pendingFiles.isEmpty())
+		return;
+	if (!force && batchTimer.isValid() &&
+	    batchTimer.elapsed() < STREAM_BATCH_INTERVAL)
+	{
+		// Too soon after the previous batch.
+		return;
+	}
+
+	// Files are found in descending block order.
+	// Reverse the batch to match filesFoundList.
+	std::reverse(pendingFiles.begin(), pendingFiles.end());
+
+	Q_Q(GcnSearchWorker);
+	emit q->filesFound(pendingFiles);
+	pendingFiles.clear();
+	batchTimer.start();
+}
+
+/**
+ * Check if the search should stop.
+ * If the search is paused, this blocks until
+ * the search is either resumed or cancelled.
+ *
+ * This is called before every block by each
+ * scanning thread.
+ *
+ * @return True if the search was cancelled; false to continue.
+ */
+bool GcnSearchWorkerPrivate::checkInterrupt(void) const
+{
+	if (pauseRequested.loadAcquire() != 0) {
+		QMutexLocker locker(&pauseMutex);
+		while (pauseRequested.loadAcquire() != 0 &&
+		       cancelRequested.loadAcquire() == 0)
+		{
+			pauseCond.wait(&pauseMutex);
+		}
+	}
+
+	return (cancelRequested.loadAcquire() != 0);
+}
+
+/**
+ * Clear the interruption requests.
+ * This is done when searchMemCard() starts and when it returns.
+ */
+void GcnSearchWorkerPrivate::clearInterrupt(void)
+{
+	QMutexLocker locker(&pauseMutex);
+	cancelRequested.storeRelease(0);
+	pauseRequested.storeRelease(0);
+}
+
+/** GcnSearchScanTask **/
+
+/**
+ * Block scanning task for parallel searches.
+ * Each task has its own block buffer and pulls
+ * block indexes from a shared counter until the
+ * block search list is exhausted.
+ */
+class GcnSearchScanTask : public QRunnable
+{
+	public:
+		GcnSearchScanTask(const GcnSearchWorkerPrivate *d,
+				  const QVector<uint16_t> &blockSearchList,
+				  QVector<GcnSearchData> *blockMatches,
+				  QAtomicInt *blockReady,
+				  QAtomicInt &nextIdx, QAtomicInt &blocksDone,
+				  QAtomicInt &blocksMatched, QAtomicInt &blocksSkipped)
+			: d(d)
+			, blockSearchList(blockSearchList)
+			, blockMatches(blockMatches)
+			, blockReady(blockReady)
+			, nextIdx(nextIdx)
+			, blocksDone(blocksDone)
+			, blocksMatched(blocksMatched)
+			, blocksSkipped(blocksSkipped)
+		{ }
+
+	private:
+		Q_DISABLE_COPY(GcnSearchScanTask)
+
+	public:
+		void run(void) final;
+
+	private:
+		const GcnSearchWorkerPrivate *const d;
+		const QVector<uint16_t> &blockSearchList;
+		// NOTE: Each task only writes to the indexes it claims.
+		QVector<GcnSearchData> *const blockMatches;
+		// Set to 1 once blockMatches[idx] has been written.
+		QAtomicInt *const blockReady;
+		QAtomicInt &nextIdx;
+		QAtomicInt &blocksDone;
+		QAtomicInt &blocksMatched;
+		QAtomicInt &blocksSkipped;
+};
+
+void GcnSearchScanTask::run(void)
+{
+	const int blockSize = d->card->blockSize();
+	unique_ptr<uint8_t[]> buf(new uint8_t[blockSize]);
+
+	const int totalSearchBlocks = blockSearchList.size();
+	for (int idx = nextIdx.fetchAndAddRelaxed(1); idx < totalSearchBlocks;
+	     idx = nextIdx.fetchAndAddRelaxed(1))
+	{
+		if (d->checkInterrupt()) {
+			// Search was cancelled.
+			break;
+		}
+
+		bool isBlank;
+		blockMatches[idx] = d->scanBlock(buf.get(), blockSize, blockSearchList.at(idx), &isBlank);
+		if (!blockMatches[idx].isEmpty()) {
+			blocksMatched.fetchAndAddRelaxed(1);
+		} else if (isBlank) {
+			blocksSkipped.fetchAndAddRelaxed(1);
+		}
+		blockReady[idx].storeRelease(1);
+		blocksDone.fetchAndAddRelease(1);
+	}
+}
+
 /** GcnSearchWorker **/
 
 GcnSearchWorker::GcnSearchWorker(QObject *parent)
 	: super(parent)
 	, d_ptr(new GcnSearchWorkerPrivate(this))
-{ }
+{
+	// filesFound() is usually received in another thread.
+	qRegisterMetaType<QVector<GcnSearchData> >();
+}
 
 GcnSearchWorker::~GcnSearchWorker()
 {
@@ -136,20 +551,20 @@ void GcnSearchWorker::setCard(GcnCard *card)
 }
 
 /**
- * Get the vector of GCN file databases.
+ * Get the GCN file databases.
  * @return GCN file databases.
  */
-QVector<GcnMcFileDb*> GcnSearchWorker::databases(void) const
+GcnMcFileDbSnapshot GcnSearchWorker::databases(void) const
 {
 	Q_D(const GcnSearchWorker);
 	return d->databases;
 }
 
 /**
- * Set the vector of GCN file databases.
+ * Set the GCN file databases.
  * @param databases GCN file databases.
  */
-void GcnSearchWorker::setDatabases(const QVector<GcnMcFileDb*> &databases)
+void GcnSearchWorker::setDatabases(const GcnMcFileDbSnapshot &databases)
 {
 	// TODO: Not if searching?
 	Q_D(GcnSearchWorker);
@@ -198,6 +613,64 @@ void GcnSearchWorker::setSearchUsedBlocks(bool searchUsedBlocks)
 	d->searchUsedBlocks = searchUsedBlocks;
 }
 
+/**
+ * Get the number of scanning threads.
+ * @return Number of scanning threads. (0 == automatic)
+ */
+int GcnSearchWorker::threadCount(void) const
+{
+	Q_D(const GcnSearchWorker);
+	return d->threadCount;
+}
+
+/**
+ * Set the number of scanning threads.
+ *
+ * If 0, QThread::idealThreadCount() will be used.
+ * If 1, blocks will be scanned in the worker's own thread.
+ *
+ * Regardless of the thread count, FAT entries are
+ * constructed serially, so the search results are
+ * identical to a single-threaded search.
+ *
+ * @param threadCount Number of scanning threads. (0 == automatic)
+ */
+void GcnSearchWorker::setThreadCount(int threadCount)
+{
+	// TODO: Not if searching?
+	Q_D(GcnSearchWorker);
+	d->threadCount = threadCount;
+}
+
+/**
+ * Are search results streamed?
+ * @return True if filesFound() is emitted during the search; false if not.
+ */
+bool GcnSearchWorker::streamResults(void) const
+{
+	Q_D(const GcnSearchWorker);
+	return d->streamResults;
+}
+
+/**
+ * Should search results be streamed?
+ *
+ * If true, filesFound() is emitted with batches of files
+ * while the search is running. Batches are emitted at most
+ * once every 50 ms, except for the first file found, which
+ * is emitted immediately.
+ *
+ * filesFoundList() is populated regardless of this setting.
+ *
+ * @param streamResults True to stream results; false to not.
+ */
+void GcnSearchWorker::setStreamResults(bool streamResults)
+{
+	// TODO: Not if searching?
+	Q_D(GcnSearchWorker);
+	d->streamResults = streamResults;
+}
+
 /**
  * Get the "original thread".
  *
@@ -240,13 +713,32 @@ void GcnSearchWorker::setOrigThread(QThread *origThread)
  * If an error occurs, check the errorString(). (TODO)
  */
 int GcnSearchWorker::searchMemCard(void)
+{
+	Q_D(GcnSearchWorker);
+
+	// Clear interruption requests from the previous search.
+	// A cancel or pause could have been requested after the
+	// previous search cleared them, but before it returned.
+	d->clearInterrupt();
+	return searchMemCard_int();
+}
+
+/**
+ * Search a memory card for "lost" files.
+ * Interruption requests are NOT cleared first.
+ * @return Number of files found on success; negative on error.
+ */
+int GcnSearchWorker::searchMemCard_int(void)
 {
 	Q_D(GcnSearchWorker);
 	d->filesFoundList.clear();
+	d->pendingFiles.clear();
+	d->batchTimer.invalidate();
 
 	if (!d->card) {
 		// No card specified.
 		d->errorString = tr("searchMemCard(): A card was not set.");
+		d->clearInterrupt();
 		emit searchError(d->errorString);
 		return -1;
 	}
@@ -255,6 +747,7 @@ int GcnSearchWorker::searchMemCard(void)
 		// Database is not loaded.
 		// TODO: Set an error string somewhere.
 		d->errorString = tr("searchMemCard(): No databases were loaded.");
+		d->clearInterrupt();
 		emit searchError(d->errorString);
 		return -1;
 	}
@@ -296,172 +789,225 @@ int GcnSearchWorker::searchMemCard(void)
 		// This may happen if searchUsedBlocks == false
 		// and the card is full.
 		d->errorString = tr("searchMemCard(): No blocks to search.");
+		d->clearInterrupt();
 		emit searchError(d->errorString);
 		return 0;
 	}
 
-	// Block buffer.
-	const int blockSize = d->card->blockSize();
-	unique_ptr<uint8_t[]> buf(new uint8_t[blockSize]);
-
-	fprintf(stderr, "--------------------------------\n");
-	fprintf(stderr, "SCANNING MEMORY CARD...\n");
+	LOG(LOGLEVEL_INFO, "--------------------------------\n");
+	LOG(LOGLEVEL_INFO, "SCANNING MEMORY CARD...\n");
 
 	const int totalSearchBlocks = blockSearchList.size();
 	int currentPhysBlock = blockSearchList.value(0);
 	emit searchStarted(totalPhysBlocks, totalSearchBlocks, currentPhysBlock);
 
-	int currentSearchBlock = -1;	// compensate for currentSearchBlock++
-	foreach (currentPhysBlock, blockSearchList) {
-		currentSearchBlock++;
-		fprintf(stderr, "Searching block: %d...\n", currentPhysBlock);
-		emit searchUpdate(currentPhysBlock, currentSearchBlock, d->filesFoundList.size());
-
-		int ret = d->card->readBlock(buf.get(), blockSize, currentPhysBlock);
-		if (ret != blockSize) {
-			// Error reading block.
-			fprintf(stderr, "ERROR reading block %d - readBlock() returned %d.\n", currentPhysBlock, ret);
-			continue;
-		}
-
-		// Check the block in the databases.
-		QVector<GcnSearchData> searchDataEntries;
-		foreach (GcnMcFileDb *db, d->databases) {
-			QVector<GcnSearchData> curEntries = db->checkBlock(buf.get(), blockSize);
-			searchDataEntries += curEntries;
-		}
-
-		// TODO: Search for preferred region. For now, just use the first hit.
-		if (!searchDataEntries.isEmpty()) {
-			// Matched!
-			GcnSearchData searchData;
-			if (searchDataEntries.size() == 1 || d->preferredRegion == 0) {
-				// Only one entry, or no preferred region.
-				searchData = searchDataEntries.at(0);
-			} else {
-				// Find an entry matching the preferred region.
-				bool isMatch = false;
-				for (int i = 0; i < searchDataEntries.size(); i++) {
-					const GcnSearchData &schk = searchDataEntries.at(i);
-					if (schk.dirEntry.gamecode[3] == d->preferredRegion) {
-						// Found a match!
-						searchData = schk;
-						isMatch = true;
-						break;
-					}
-				}
+	// Determine the number of scanning threads.
+	int threadCount = d->threadCount;
+	if (threadCount <= 0) {
+		threadCount = QThread::idealThreadCount();
+	}
+	if (threadCount > totalSearchBlocks) {
+		threadCount = totalSearchBlocks;
+	}
 
-				if (!isMatch) {
-					// No region match. Use the first entry.
-					searchData = searchDataEntries.at(0);
-				}
+	// FAT entries are constructed in blockSearchList order,
+	// since each file claims blocks in usedBlockMap that
+	// affect subsequent files. This is done as soon as all
+	// preceding blocks have been scanned, so found files
+	// can be streamed while the search is running.
+	int currentSearchBlock = 0;
+	int blankBlocksSkipped = 0;
+
+	// Progress updates are limited to one per PROGRESS_UPDATE_INTERVAL,
+	// since each update is a queued signal to the UI thread.
+	QElapsedTimer progressTimer;
+
+	if (threadCount <= 1) {
+		// Single-threaded scan.
+		const int blockSize = d->card->blockSize();
+		unique_ptr<uint8_t[]> buf(new uint8_t[blockSize]);
+
+		int blocksMatched = 0;
+		for (; currentSearchBlock < totalSearchBlocks; currentSearchBlock++) {
+			if (d->checkInterrupt()) {
+				// Search was cancelled.
+				break;
 			}
 
-			// NOTE: GcnMcFileDb doesn't initialize fatEntries.
-			// Hence, we have to make a copy and initialize the list.
-			fprintf(stderr, "FOUND A MATCH: %-.4s%-.2s %-.32s\n",
-				searchData.dirEntry.gamecode,
-				searchData.dirEntry.company,
-				searchData.dirEntry.filename);
-			fprintf(stderr, "bannerFmt == %02X, iconAddress == %08X, iconFormat == %02X, iconSpeed == %02X\n",
-				searchData.dirEntry.bannerfmt,
-				searchData.dirEntry.iconaddr,
-				searchData.dirEntry.iconfmt,
-				searchData.dirEntry.iconspeed);
-
-			// NOTE: dirEntry's block start is not set by d->db->checkBlock().
-			// Set it here.
-			searchData.dirEntry.block = currentPhysBlock;
-			if (searchData.dirEntry.length == 0) {
-				// This only happens if an entry is either
-				// missing a <dirEntry>, or has <length>0</length>.
-				// TODO: Check for this in GcnMcFileDb.
-				searchData.dirEntry.length = 1;
+			currentPhysBlock = blockSearchList.at(currentSearchBlock);
+			LOG(LOGLEVEL_DEBUG, "Searching block: %d...\n", currentPhysBlock);
+			if (!progressTimer.isValid() ||
+			    progressTimer.elapsed() >= d->PROGRESS_UPDATE_INTERVAL)
+			{
+				// Counters are cumulative, so skipped updates
+				// don't lose any information.
+				emit searchUpdate(currentPhysBlock, currentSearchBlock, blocksMatched, blankBlocksSkipped);
+				progressTimer.start();
 			}
 
-			// Construct the FAT entries for this file.
-			searchData.fatEntries.clear();
-			searchData.fatEntries.reserve(searchData.dirEntry.length);
-
-			// First block is always valid.
-			searchData.fatEntries.append(searchData.dirEntry.block);
-			if (usedBlockMap[searchData.dirEntry.block] < std::numeric_limits<uint8_t>::max())
-				usedBlockMap[searchData.dirEntry.block]++;
-
-			uint16_t blocksRemaining = (searchData.dirEntry.length - 1);
-			uint16_t block = (searchData.dirEntry.block + 1);
-			bool wasWrapped = false;
-
-			// Skip used blocks and go after empty blocks only.
-			while (blocksRemaining > 0) {
-				if (block >= totalPhysBlocks) {
-					// Wraparound.
-					// Do NOT mark the wrapped blocks as used,
-					// since they might be used by actual files.
-					block = 5;
-					wasWrapped = true;
-					continue;
-				} else if (block == searchData.dirEntry.block) {
-					// ERROR: We wrapped around!
-					// Use the "naive" algorithm after the last valid block.
-					break;
-				}
-
-				// Check if this block is used.
-				if (usedBlockMap[block] == 0) {
-					// Block is not used.
-					searchData.fatEntries.append(block);
-					if (!wasWrapped)
-						usedBlockMap[block]++;
-					blocksRemaining--;
-				}
-
-				// Next block.
-				block++;
+			bool isBlank;
+			const QVector<GcnSearchData> blockMatches =
+				d->scanBlock(buf.get(), blockSize, currentPhysBlock, &isBlank);
+			if (!blockMatches.isEmpty()) {
+				blocksMatched++;
+				d->addFoundFile(blockMatches, currentPhysBlock, usedBlockMap);
+			} else if (isBlank) {
+				blankBlocksSkipped++;
 			}
+			d->flushFoundFiles(false);
+		}
+	} else {
+		// Multi-threaded scan.
+		LOG(LOGLEVEL_INFO, "Using %d scanning threads.\n", threadCount);
+
+		// Database matches for each block, indexed by blockSearchList position.
+		QVector<QVector<GcnSearchData> > blockMatches(totalSearchBlocks);
+		unique_ptr<QAtomicInt[]> blockReady(new QAtomicInt[totalSearchBlocks]);
+
+		QAtomicInt nextIdx(0);
+		QAtomicInt blocksDone(0);
+		QAtomicInt blocksMatched(0);
+		QAtomicInt blocksSkipped(0);
+		QVector<GcnSearchData> *const pBlockMatches = blockMatches.data();
+
+		QThreadPool threadPool;
+		threadPool.setMaxThreadCount(threadCount);
+		for (int i = threadCount; i > 0; i--) {
+			// NOTE: QThreadPool deletes the task when it's done.
+			threadPool.start(new GcnSearchScanTask(d, blockSearchList,
+				pBlockMatches, blockReady.get(),
+				nextIdx, blocksDone, blocksMatched, blocksSkipped));
+		}
 
-			// Naive block algorithm for the remaining blocks.
-			block = (searchData.fatEntries.value(searchData.fatEntries.size() - 1) + 1);
-			wasWrapped = false;
-			while (blocksRemaining > 0) {
-				if (block >= totalPhysBlocks) {
-					// Wraparound.
-					// Do NOT mark the wrapped blocks as used,
-					// since they might be used by actual files.
-					block = 5;
-					continue;
-				}
-
-				// Add this block.
-				searchData.fatEntries.append(block);
-				if (usedBlockMap[block] < std::numeric_limits<uint8_t>::max()) {
-					if (!wasWrapped)
-						usedBlockMap[block]++;
+		// Construct FAT entries and report progress
+		// while the tasks are running.
+		int nextFatIdx = 0;
+		int lastDone = -1;
+		bool isDone;
+		do {
+			isDone = threadPool.waitForDone(d->PROGRESS_UPDATE_INTERVAL);
+
+			// Blocks are usually finished in order, since each task
+			// claims the next index, so this stays close to blocksDone.
+			for (; nextFatIdx < totalSearchBlocks &&
+			       blockReady[nextFatIdx].loadAcquire() != 0; nextFatIdx++)
+			{
+				const QVector<GcnSearchData> &matches = blockMatches.at(nextFatIdx);
+				if (!matches.isEmpty()) {
+					d->addFoundFile(matches, blockSearchList.at(nextFatIdx), usedBlockMap);
 				}
-				block++;
-				blocksRemaining--;
 			}
+			d->flushFoundFiles(false);
+
+			const int done = blocksDone.loadAcquire();
+			if (done != lastDone) {
+				lastDone = done;
+				currentSearchBlock = done;
+				currentPhysBlock = blockSearchList.value(
+					(done < totalSearchBlocks ? done : totalSearchBlocks - 1));
+				emit searchUpdate(currentPhysBlock, currentSearchBlock,
+					blocksMatched.loadAcquire(), blocksSkipped.loadAcquire());
+			}
+		} while (!isDone);
+		currentSearchBlock = totalSearchBlocks;
+		blankBlocksSkipped = blocksSkipped.loadAcquire();
+	}
 
-			// Add the search data to the list. (front of list)
-			d->filesFoundList.push_front(searchData);
-		}
+	if (d->cancelRequested.loadAcquire() != 0) {
+		// Search was cancelled.
+		// Don't return partial results.
+		d->filesFoundList.clear();
+		d->pendingFiles.clear();
+		d->clearInterrupt();
+		emit searchCancelled();
+
+		LOG(LOGLEVEL_INFO, "Search cancelled.\n");
+		LOG(LOGLEVEL_INFO, "--------------------------------\n");
+		return -ECANCELED;
 	}
 
+	// Emit the last batch of found files.
+	d->flushFoundFiles(true);
+
 	// Send an update for the last block.
-	emit searchUpdate(5, currentSearchBlock, d->filesFoundList.size());
+	emit searchUpdate(5, currentSearchBlock - 1, d->filesFoundList.size(), blankBlocksSkipped);
 
 	// Search is finished.
+	d->clearInterrupt();
 	emit searchFinished(d->filesFoundList.size());
 
-	fprintf(stderr, "Finished scanning memory card.\n");
-	fprintf(stderr, "--------------------------------\n");
+	LOG(LOGLEVEL_INFO, "Finished scanning memory card. (%d blank block(s) skipped)\n", blankBlocksSkipped);
+	LOG(LOGLEVEL_INFO, "--------------------------------\n");
 	return d->filesFoundList.size();
 }
 
+/** Interruption. **/
+
+/**
+ * Clear the interruption requests.
+ * This must not be called while a search is running.
+ * searchMemCard_threaded() doesn't clear them, so call
+ * this before starting the thread instead. A cancel
+ * requested before the thread starts is then kept.
+ */
+void GcnSearchWorker::clearInterrupt(void)
+{
+	Q_D(GcnSearchWorker);
+	d->clearInterrupt();
+}
+
+/**
+ * Cancel the search.
+ * Each scanning thread checks for cancellation
+ * before every block, so the search stops promptly.
+ * searchCancelled() is emitted once it has stopped.
+ * This also cancels a paused search.
+ */
+void GcnSearchWorker::cancel(void)
+{
+	Q_D(GcnSearchWorker);
+	QMutexLocker locker(&d->pauseMutex);
+	d->cancelRequested.storeRelease(1);
+	d->pauseCond.wakeAll();
+}
+
+/**
+ * Pause the search.
+ * Scanning threads will wait before their next block
+ * until the search is resumed or cancelled.
+ */
+void GcnSearchWorker::pause(void)
+{
+	Q_D(GcnSearchWorker);
+	QMutexLocker locker(&d->pauseMutex);
+	d->pauseRequested.storeRelease(1);
+}
+
+/**
+ * Resume a paused search.
+ */
+void GcnSearchWorker::resume(void)
+{
+	Q_D(GcnSearchWorker);
+	QMutexLocker locker(&d->pauseMutex);
+	d->pauseRequested.storeRelease(0);
+	d->pauseCond.wakeAll();
+}
+
+/**
+ * Is the search paused?
+ * @return True if paused; false if not.
+ */
+bool GcnSearchWorker::isPaused(void) const
+{
+	Q_D(const GcnSearchWorker);
+	return (d->pauseRequested.loadAcquire() != 0);
+}
+
 /**
  * Search the memory card for "lost" files.
  * This version should be connected to a QThread's SIGNAL(started()).
- * Thread information must have been set using setThreadInfo().
+ * Properties must have been set previously, including origThread.
  */
 void GcnSearchWorker::searchMemCard_threaded(void)
 {
@@ -478,12 +1024,16 @@ void GcnSearchWorker::searchMemCard_threaded(void)
 		}
 
 		d->errorString = tr("GcnSearchWorker: Thread information was not set.");
+		d->clearInterrupt();
 		emit searchError(d->errorString);
 		return;
 	}
 
 	// Search the memory card.
-	searchMemCard();
+	// NOTE: Interruption requests were cleared by clearInterrupt()
+	// before the thread was started, so a cancel that was requested
+	// before this function was called isn't lost.
+	searchMemCard_int();
 
 	// Move back to the original thread.
 	moveToThread(d->origThread);
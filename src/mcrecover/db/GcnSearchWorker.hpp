@@ -15,19 +15,22 @@
 // Search Data struct.
 #include "GcnSearchData.hpp"
 
+// GCN Memory Card File Database manager.
+#include "GcnMcFileDbManager.hpp"
+
 // C++ includes.
 #include <list>
 
 // Qt includes.
 #include <QtCore/QObject>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 
 // Qt classes.
 class QThread;
 
 // Forward declarations.
 class GcnCard;
-class GcnMcFileDb;
 
 class GcnSearchWorkerPrivate;
 class GcnSearchWorker : public QObject
@@ -39,9 +42,11 @@ class GcnSearchWorker : public QObject
 	Q_PROPERTY(std::list<GcnSearchData> filesFoundList READ filesFoundList)
 
 	Q_PROPERTY(GcnCard* card READ card WRITE setCard)
-	Q_PROPERTY(QVector<GcnMcFileDb*> databases READ databases WRITE setDatabases)
+	Q_PROPERTY(GcnMcFileDbSnapshot databases READ databases WRITE setDatabases)
 	Q_PROPERTY(char preferredRegion READ preferredRegion WRITE setPreferredRegion)
 	Q_PROPERTY(bool searchUsedBlocks READ searchUsedBlocks WRITE setSearchUsedBlocks)
+	Q_PROPERTY(int threadCount READ threadCount WRITE setThreadCount)
+	Q_PROPERTY(bool streamResults READ streamResults WRITE setStreamResults)
 	Q_PROPERTY(QThread* origThread READ origThread WRITE setOrigThread)
 
 	public:
@@ -54,6 +59,13 @@ class GcnSearchWorker : public QObject
 	private:
 		Q_DISABLE_COPY(GcnSearchWorker)
 
+		/**
+		 * Search a memory card for "lost" files.
+		 * Interruption requests are NOT cleared first.
+		 * @return Number of files found on success; negative on error.
+		 */
+		int searchMemCard_int(void);
+
 	signals:
 		/**
 		 * Search has started.
@@ -65,6 +77,7 @@ class GcnSearchWorker : public QObject
 
 		/**
 		 * Search has been cancelled.
+		 * No files are returned by a cancelled search.
 		 */
 		void searchCancelled(void);
 
@@ -79,8 +92,22 @@ class GcnSearchWorker : public QObject
 		 * @param currentPhysBlock Current physical block number being searched.
 		 * @param currentSearchBlock Number of blocks searched so far.
 		 * @param lostFilesFound Number of "lost" files found.
+		 * @param blankBlocksSkipped Number of blank blocks skipped so far.
+		 */
+		void searchUpdate(int currentPhysBlock, int currentSearchBlock, int lostFilesFound, int blankBlocksSkipped);
+
+		/**
+		 * "Lost" files have been found. (streaming mode only)
+		 *
+		 * Batches are emitted while the search is running.
+		 * Each batch is sorted by block number, and all of its
+		 * files have lower block numbers than the files in
+		 * previous batches. Prepending each batch to the
+		 * previous ones results in filesFoundList().
+		 *
+		 * @param files Files found since the previous batch.
 		 */
-		void searchUpdate(int currentPhysBlock, int currentSearchBlock, int lostFilesFound);
+		void filesFound(const QVector<GcnSearchData> &files);
 
 		/**
 		 * An error has occurred during the search.
@@ -123,16 +150,16 @@ class GcnSearchWorker : public QObject
 		void setCard(GcnCard *card);
 
 		/**
-		 * Get the vector of GCN file databases.
+		 * Get the GCN file databases.
 		 * @return GCN file databases.
 		 */
-		QVector<GcnMcFileDb*> databases(void) const;
+		GcnMcFileDbSnapshot databases(void) const;
 
 		/**
-		 * Set the vector of GCN file databases.
+		 * Set the GCN file databases.
 		 * @param databases GCN file databases.
 		 */
-		void setDatabases(const QVector<GcnMcFileDb*> &databases);
+		void setDatabases(const GcnMcFileDbSnapshot &databases);
 
 		/**
 		 * Get the preferred region.
@@ -158,6 +185,46 @@ class GcnSearchWorker : public QObject
 		 */
 		void setSearchUsedBlocks(bool searchUsedBlocks);
 
+		/**
+		 * Get the number of scanning threads.
+		 * @return Number of scanning threads. (0 == automatic)
+		 */
+		int threadCount(void) const;
+
+		/**
+		 * Set the number of scanning threads.
+		 *
+		 * If 0, QThread::idealThreadCount() will be used.
+		 * If 1, blocks will be scanned in the worker's own thread.
+		 *
+		 * Regardless of the thread count, FAT entries are
+		 * constructed serially, so the search results are
+		 * identical to a single-threaded search.
+		 *
+		 * @param threadCount Number of scanning threads. (0 == automatic)
+		 */
+		void setThreadCount(int threadCount);
+
+		/**
+		 * Are search results streamed?
+		 * @return True if filesFound() is emitted during the search; false if not.
+		 */
+		bool streamResults(void) const;
+
+		/**
+		 * Should search results be streamed?
+		 *
+		 * If true, filesFound() is emitted with batches of files
+		 * while the search is running. Batches are emitted at most
+		 * once every 50 ms, except for the first file found, which
+		 * is emitted immediately.
+		 *
+		 * filesFoundList() is populated regardless of this setting.
+		 *
+		 * @param streamResults True to stream results; false to not.
+		 */
+		void setStreamResults(bool streamResults);
+
 		/**
 		 * Get the "original thread".
 		 *
@@ -190,29 +257,61 @@ class GcnSearchWorker : public QObject
 		 *
 		 * If successful, retrieve the file list using filesEntryList().
 		 * If an error occurs, check the errorString(). (TODO)
+		 * If the search was cancelled, -ECANCELED is returned.
+		 *
+		 * Interruption requests left over from a previous
+		 * search are cleared before the search starts.
 		 */
 		int searchMemCard(void);
 
+		/** Interruption. **/
+		// NOTE: These functions are thread-safe, and are
+		// meant to be called while searchMemCard() is
+		// running in another thread.
+		// Interruption requests are cleared when
+		// searchMemCard() starts and when it returns.
+
 		/**
-		 * Set internal information for threading purposes.
-		 * This is basically the parameters to searchMemCard().
-		 * We can't pass these when starting the thread, so
-		 * we have to set them up first.
-		 * @param card Memory Card to search.
-		 * @param dbs Vector of GcnMcFileDb to use.
-		 * @param orig_thread Thread to move back to once completed.
-		 * @param preferredRegion Preferred region.
-		 * @param searchUsedBlocks If true, search all blocks, not just blocks marked as empty.
+		 * Clear the interruption requests.
+		 * This must not be called while a search is running.
+		 * searchMemCard_threaded() doesn't clear them, so call
+		 * this before starting the thread instead. A cancel
+		 * requested before the thread starts is then kept.
+		 */
+		void clearInterrupt(void);
+
+		/**
+		 * Cancel the search.
+		 * Each scanning thread checks for cancellation
+		 * before every block, so the search stops promptly.
+		 * searchCancelled() is emitted once it has stopped.
+		 * This also cancels a paused search.
+		 */
+		void cancel(void);
+
+		/**
+		 * Pause the search.
+		 * Scanning threads will wait before their next block
+		 * until the search is resumed or cancelled.
+		 */
+		void pause(void);
+
+		/**
+		 * Resume a paused search.
+		 */
+		void resume(void);
+
+		/**
+		 * Is the search paused?
+		 * @return True if paused; false if not.
 		 */
-		void setThreadInfo(GcnCard *card, const QVector<GcnMcFileDb*> &dbs,
-				QThread *orig_thread,
-				char preferredRegion = 0, bool searchUsedBlocks = false);
+		bool isPaused(void) const;
 
 	public slots:
 		/**
 		 * Search the memory card for "lost" files.
 		 * This version should be connected to a QThread's SIGNAL(started()).
-		 * Thread information must have been set using setThreadInfo().
+		 * Properties must have been set previously, including origThread.
 		 */
 		void searchMemCard_threaded(void);
 };
@@ -9,6 +9,7 @@
 #include "mcrecover.hpp"
 
 #include "windows/McRecoverWindow.hpp"
+#include "db/GcnMcFileDbManager.hpp"
 
 // C includes.
 #include <stdio.h>
@@ -39,6 +40,9 @@ int mcrecover_main(int argc, char *argv[])
 
 	McRecoverQApplication *mcApp = new McRecoverQApplication(argc, argv);
 
+	// Start loading the GCN Memory Card File databases.
+	GcnMcFileDbManager::instance()->loadAsync();
+
 	// Initialize the McRecoverWindow.
 	McRecoverWindow *mcRecoverWindow = new McRecoverWindow();
 
@@ -61,15 +61,30 @@ class StatusBarManagerPrivate
 		// Are we currently scanning a memory card?
 		bool scanning;
 
+		// Are we currently saving files?
+		bool exporting;
+
+		// What is the progress bar showing?
+		enum ProgressMode {
+			PROGRESS_SEARCH,
+			PROGRESS_EXPORT,
+		};
+		ProgressMode progressMode;
+
 		// Search status from last SearchThread update.
 		int currentPhysBlock;
 		int totalPhysBlocks;
 		int currentSearchBlock;
 		int totalSearchBlocks;
 		int lostFilesFound;
+		int blankBlocksSkipped;
+
+		// Export status from the last FileExporter update.
+		int filesProcessed;
+		int totalFiles;
 
 		// Number of seconds to wait before hiding the
-		// progress bar after the search has completed.
+		// progress bar after the search or export has completed.
 		static const int SECONDS_TO_HIDE_PROGRESS_BAR = 5;
 
 		// TaskbarButtonManager.
@@ -86,11 +101,16 @@ StatusBarManagerPrivate::StatusBarManagerPrivate(StatusBarManager *q)
 	, progressBar(nullptr)
 	, searchThread(nullptr)
 	, scanning(false)
+	, exporting(false)
+	, progressMode(PROGRESS_SEARCH)
 	, currentPhysBlock(0)
 	, totalPhysBlocks(0)
 	, currentSearchBlock(0)
 	, totalSearchBlocks(0)
 	, lostFilesFound(0)
+	, blankBlocksSkipped(0)
+	, filesProcessed(0)
+	, totalFiles(0)
 	, taskbarButtonManager(nullptr)
 {
 	// Default message.
@@ -126,6 +146,11 @@ void StatusBarManagerPrivate::updateStatusBar(void)
 		QString filesFoundText = StatusBarManager::tr("%n lost file(s) found.", nullptr, lostFilesFound);
 		q->lblFilesFound->setText(filesFoundText);
 		*/
+	} else if (exporting) {
+		// We're saving files.
+		lastStatusMessage = StatusBarManager::tr("Saving files... (%L1 of %L2)")
+					.arg(filesProcessed)
+					.arg(totalFiles);
 	}
 
 	// Set the status bar message.
@@ -141,18 +166,27 @@ void StatusBarManagerPrivate::updateStatusBar(void)
 		lblMessage->resize(w, lblMessage->height());
 	}
 
-	// Make sure the progress bar is visible when scanning.
-	if (scanning && progressBar)
+	// Make sure the progress bar is visible when scanning or saving.
+	if ((scanning || exporting) && progressBar)
 		progressBar->setVisible(true);
 
 	// Set the progress bar values.
 	if (progressBar && progressBar->isVisible()) {
-		progressBar->setMaximum(totalSearchBlocks);
-		progressBar->setValue(currentSearchBlock);
+		int value, max;
+		if (progressMode == PROGRESS_EXPORT) {
+			value = filesProcessed;
+			max = totalFiles;
+		} else {
+			value = currentSearchBlock;
+			max = totalSearchBlocks;
+		}
+
+		progressBar->setMaximum(max);
+		progressBar->setValue(value);
 		if (taskbarButtonManager) {
 			// TODO: Set max only in initialization?
-			taskbarButtonManager->setProgressBarValue(currentSearchBlock);
-			taskbarButtonManager->setProgressBarMax(totalSearchBlocks);
+			taskbarButtonManager->setProgressBarValue(value);
+			taskbarButtonManager->setProgressBarMax(max);
 		}
 	} else {
 		if (taskbarButtonManager) {
@@ -306,11 +340,13 @@ void StatusBarManager::setSearchThread(GcnSearchThread *searchThread)
 	// TODO: Get current status from the new searchThread.
 	// For now, just clear everything.
 	d->scanning = false;
+	d->progressMode = StatusBarManagerPrivate::PROGRESS_SEARCH;
 	d->currentPhysBlock = 0;
 	d->totalPhysBlocks = 0;
 	d->currentPhysBlock = 0;
 	d->totalSearchBlocks = 0;
 	d->lostFilesFound = 0;
+	d->blankBlocksSkipped = 0;
 	d->updateStatusBar();
 }
 
@@ -367,6 +403,7 @@ void StatusBarManager::opened(const QString &filename, const QString &productNam
 
 	Q_D(StatusBarManager);
 	d->scanning = false;
+	d->exporting = false;
 	d->progressBar->setVisible(false);
 	d->lastStatusMessage = tr("Loaded %1 image %2")
 				.arg(productName)
@@ -385,6 +422,7 @@ void StatusBarManager::closed(const QString &productName)
 {
 	Q_D(StatusBarManager);
 	d->scanning = false;
+	d->exporting = false;
 	d->progressBar->setVisible(false);
 	d->lastStatusMessage = tr("%1 image closed.").arg(productName);
 	d->updateStatusBar();
@@ -393,22 +431,92 @@ void StatusBarManager::closed(const QString &productName)
 	d->tmrHideProgressBar.stop();
 }
 
+/**
+ * Files are being saved in the background.
+ * @param totalFiles Number of files being saved.
+ */
+void StatusBarManager::filesExportStarted(int totalFiles)
+{
+	Q_D(StatusBarManager);
+
+	// Initialize the export status.
+	d->scanning = false;
+	d->exporting = true;
+	d->progressMode = StatusBarManagerPrivate::PROGRESS_EXPORT;
+	// NOTE: When exporting, lastStatusMessage is set by updateStatusBar().
+	d->filesProcessed = 0;
+	d->totalFiles = totalFiles;
+	d->updateStatusBar();
+
+	// Stop the Hide Progress Bar timer.
+	d->tmrHideProgressBar.stop();
+}
+
+/**
+ * Update the status of files being saved in the background.
+ * @param filesProcessed Number of files processed so far.
+ * @param totalFiles Number of files being saved.
+ */
+void StatusBarManager::filesExportUpdate(int filesProcessed, int totalFiles)
+{
+	Q_D(StatusBarManager);
+	if (!d->exporting)
+		return;
+
+	// Update the export status.
+	// NOTE: When exporting, lastStatusMessage is set by updateStatusBar().
+	d->filesProcessed = filesProcessed;
+	d->totalFiles = totalFiles;
+	d->updateStatusBar();
+}
+
 /**
  * Files were saved.
+ * If files were being saved in the background,
+ * this finishes the progress display.
  * @param n Number of files saved.
  * @param path Path files were saved to.
  */
 void StatusBarManager::filesSaved(int n, const QString &path)
 {
 	Q_D(StatusBarManager);
+	const bool wasExporting = d->exporting;
 	d->scanning = false;
-	d->progressBar->setVisible(false);
+	d->exporting = false;
+	if (wasExporting) {
+		// Show the completed progress bar for a few seconds.
+		d->filesProcessed = d->totalFiles;
+	} else {
+		d->progressBar->setVisible(false);
+	}
 	d->lastStatusMessage = tr("%Ln file(s) saved to %1.", "", n)
 				.arg(QDir::toNativeSeparators(path));
 	d->updateStatusBar();
 
-	// Stop the Hide Progress Bar timer.
-	d->tmrHideProgressBar.stop();
+	if (wasExporting) {
+		// Hide the progress bar after a few seconds.
+		d->tmrHideProgressBar.start();
+	} else {
+		// Stop the Hide Progress Bar timer.
+		d->tmrHideProgressBar.stop();
+	}
+}
+
+/**
+ * File checksums were verified.
+ * This is appended to the current status message.
+ * @param good Number of files with good checksums.
+ * @param invalid Number of files with invalid checksums.
+ * @param unknown Number of files with unknown checksums.
+ */
+void StatusBarManager::checksumsVerified(int good, int invalid, int unknown)
+{
+	Q_D(StatusBarManager);
+	//: Checksum summary. (%1 == good, %2 == invalid, %3 == unknown)
+	d->lastStatusMessage += QChar(L' ') +
+		tr("(Checksums: %1 good, %2 invalid, %3 unknown)")
+			.arg(good).arg(invalid).arg(unknown);
+	d->updateStatusBar();
 }
 
 /** Private Slots. **/
@@ -450,12 +558,15 @@ void StatusBarManager::searchStarted_slot(int totalPhysBlocks, int totalSearchBl
 
 	// Initialize the search status.
 	d->scanning = true;
+	d->exporting = false;
+	d->progressMode = StatusBarManagerPrivate::PROGRESS_SEARCH;
 	// NOTE: When scanning, lastStatusMessage is set by updateStatusBar().
 	d->currentPhysBlock = firstPhysBlock;
 	d->totalPhysBlocks = totalPhysBlocks;
 	d->currentSearchBlock = 0;
 	d->totalSearchBlocks = totalSearchBlocks;
 	d->lostFilesFound = 0;
+	d->blankBlocksSkipped = 0;
 	d->updateStatusBar();
 
 	// Stop the Hide Progress Bar timer.
@@ -490,6 +601,10 @@ void StatusBarManager::searchFinished_slot(int lostFilesFound)
 	d->lostFilesFound = lostFilesFound;
 	d->currentSearchBlock = d->totalSearchBlocks;
 	d->lastStatusMessage = tr("Scan complete. %Ln lost file(s) found.", "", lostFilesFound);
+	if (d->blankBlocksSkipped > 0) {
+		d->lastStatusMessage += QChar(L' ') +
+			tr("(%Ln blank block(s) skipped.)", "", d->blankBlocksSkipped);
+	}
 	d->updateStatusBar();
 
 	// Hide the progress bar after a few seconds.
@@ -501,8 +616,9 @@ void StatusBarManager::searchFinished_slot(int lostFilesFound)
  * @param currentPhysBlock Current physical block number being searched.
  * @param currentSearchBlock Number of blocks searched so far.
  * @param lostFilesFound Number of "lost" files found.
+ * @param blankBlocksSkipped Number of blank blocks skipped so far.
  */
-void StatusBarManager::searchUpdate_slot(int currentPhysBlock, int currentSearchBlock, int lostFilesFound)
+void StatusBarManager::searchUpdate_slot(int currentPhysBlock, int currentSearchBlock, int lostFilesFound, int blankBlocksSkipped)
 {
 	Q_D(StatusBarManager);
 
@@ -511,6 +627,7 @@ void StatusBarManager::searchUpdate_slot(int currentPhysBlock, int currentSearch
 	d->currentPhysBlock = currentPhysBlock;
 	d->currentSearchBlock = currentSearchBlock;
 	d->lostFilesFound = lostFilesFound;
+	d->blankBlocksSkipped = blankBlocksSkipped;
 	d->updateStatusBar();
 }
 
@@ -532,7 +649,7 @@ void StatusBarManager::searchError_slot(QString errorString)
 /**
  * Hide the progress bar.
  * This is usually done a few seconds after the
- * search is completed.
+ * search or export is completed.
  */
 void StatusBarManager::hideProgressBar_slot(void)
 {
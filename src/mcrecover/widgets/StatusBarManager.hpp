@@ -90,13 +90,37 @@ class StatusBarManager : public QObject
 		 */
 		void closed(const QString &productName);
 
+		/**
+		 * Files are being saved in the background.
+		 * @param totalFiles Number of files being saved.
+		 */
+		void filesExportStarted(int totalFiles);
+
+		/**
+		 * Update the status of files being saved in the background.
+		 * @param filesProcessed Number of files processed so far.
+		 * @param totalFiles Number of files being saved.
+		 */
+		void filesExportUpdate(int filesProcessed, int totalFiles);
+
 		/**
 		 * Files were saved.
+		 * If files were being saved in the background,
+		 * this finishes the progress display.
 		 * @param n Number of files saved.
 		 * @param path Path files were saved to.
 		 */
 		void filesSaved(int n, const QString &path);
 
+		/**
+		 * File checksums were verified.
+		 * This is appended to the current status message.
+		 * @param good Number of files with good checksums.
+		 * @param invalid Number of files with invalid checksums.
+		 * @param unknown Number of files with unknown checksums.
+		 */
+		void checksumsVerified(int good, int invalid, int unknown);
+
 	private slots:
 		/**
 		 * An object has been destroyed.
@@ -128,8 +152,9 @@ class StatusBarManager : public QObject
 		 * @param currentPhysBlock Current physical block number being searched.
 		 * @param currentSearchBlock Number of blocks searched so far.
 		 * @param lostFilesFound Number of "lost" files found.
+		 * @param blankBlocksSkipped Number of blank blocks skipped so far.
 		 */
-		void searchUpdate_slot(int currentPhysBlock, int currentSearchBlock, int lostFilesFound);
+		void searchUpdate_slot(int currentPhysBlock, int currentSearchBlock, int lostFilesFound, int blankBlocksSkipped);
 
 		/**
 		 * An error has occurred during the search.
@@ -140,7 +165,7 @@ class StatusBarManager : public QObject
 		/**
 		 * Hide the progress bar.
 		 * This is usually done a few seconds after the
-		 * search is completed.
+		 * search or export is completed.
 		 */
 		void hideProgressBar_slot(void);
 };
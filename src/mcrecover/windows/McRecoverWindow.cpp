@@ -28,13 +28,15 @@
 #include "libmemcard/VmuCard.hpp"
 
 // File database.
-#include "db/GcnMcFileDb.hpp"
 #include "db/GcnCheckFiles.hpp"
 
 // Search classes.
 #include "db/GcnSearchThread.hpp"
 #include "widgets/StatusBarManager.hpp"
 
+// Background file exporter.
+#include "FileExporter.hpp"
+
 // Taskbar Button Manager.
 #include "TaskbarButtonManager/TaskbarButtonManager.hpp"
 #include "TaskbarButtonManager/TaskbarButtonManagerFactory.hpp"
@@ -56,6 +58,8 @@ using std::vector;
 #include <QtCore/QStack>
 #include <QtCore/QVector>
 #include <QtCore/QFile>
+#include <QtCore/QSet>
+#include <QtCore/QHash>
 #include <QtCore/QSignalMapper>
 #include <QtCore/QLocale>
 #include <QtCore/QTextCodec>
@@ -125,6 +129,23 @@ class McRecoverWindowPrivate
 		// Search thread.
 		GcnSearchThread *searchThread;
 
+		// Is a search running?
+		// NOTE: The UI isn't marked as busy while searching,
+		// so the search can be cancelled, paused, or restarted.
+		bool scanning;
+
+		/**
+		 * Update the UI for the search status.
+		 * @param scanning True if a search is running; false if not.
+		 */
+		void setScanning(bool scanning);
+
+		/**
+		 * Restart the search if it's running.
+		 * Used if the search options are changed.
+		 */
+		void restartScanIfRunning(void);
+
 		/**
 		 * Initialize the toolbar.
 		 */
@@ -158,11 +179,32 @@ class McRecoverWindowPrivate
 
 		/**
 		 * Save the specified file(s).
+		 * Overwrite conflicts are resolved first; the files
+		 * are then saved in the background by fileExporter.
 		 * @param files List of file(s) to save.
 		 * @param path If specified, save file(s) to path using default GCI filenames.
 		 */
 		void saveFiles(const QVector<File*> &files, QString path = QString());
 
+		/**
+		 * Save the specified file(s) to an archive.
+		 * The user is prompted for the archive filename.
+		 * The files are saved in the background by fileExporter.
+		 * @param files List of file(s) to save.
+		 */
+		void saveFilesToArchive(const QVector<File*> &files);
+
+		/**
+		 * Ask the user if uncommitted changes should be discarded.
+		 * @return True if there are no changes, or if they can be discarded; false to cancel.
+		 */
+		bool confirmDiscardChanges(void);
+
+		// Background file exporter.
+		FileExporter *fileExporter;
+		// Path for the status bar message for the current export.
+		QString exportPath;
+
 		// UI busy counter.
 		int uiBusyCounter;
 
@@ -235,7 +277,9 @@ McRecoverWindowPrivate::McRecoverWindowPrivate(McRecoverWindow *q)
 	, proxyModel(new MemCardSortFilterProxyModel(q))
 	, cols_init(false)
 	, searchThread(new GcnSearchThread(q))
+	, scanning(false)
 	, statusBarManager(nullptr)
+	, fileExporter(new FileExporter(q))
 	, uiBusyCounter(0)
 	, preferredRegion(0)
 	, lblPreferredRegion(nullptr)
@@ -255,18 +299,35 @@ McRecoverWindowPrivate::McRecoverWindowPrivate(McRecoverWindow *q)
 			 q, &McRecoverWindow::memCardModel_rowsInserted);
 
 	// Connect the SearchThread slots.
+	// Found files are added to the card while the search is running.
+	searchThread->setStreamResults(true);
+	QObject::connect(searchThread, &GcnSearchThread::filesFound,
+			 q, &McRecoverWindow::searchThread_filesFound_slot);
 	QObject::connect(searchThread, &GcnSearchThread::searchFinished,
 			 q, &McRecoverWindow::searchThread_searchFinished_slot);
+	QObject::connect(searchThread, &GcnSearchThread::searchCancelled,
+			 q, &McRecoverWindow::searchThread_searchCancelled_slot);
 
-	// Connect searchThread to the mark-as-busy slots.
+	// Connect searchThread to the scanning status slots.
+	// NOTE: The UI isn't marked as busy while searching,
+	// so the scan actions stay available.
 	QObject::connect(searchThread, &GcnSearchThread::searchStarted,
-			 q, &McRecoverWindow::markUiBusy);
+			 q, &McRecoverWindow::searchThread_searchStarted_slot);
 	QObject::connect(searchThread, &GcnSearchThread::searchFinished,
-			 q, &McRecoverWindow::markUiNotBusy);
+			 q, &McRecoverWindow::searchThread_searchStopped_slot);
+	QObject::connect(searchThread, &GcnSearchThread::searchCancelled,
+			 q, &McRecoverWindow::searchThread_searchStopped_slot);
 	QObject::connect(searchThread, &GcnSearchThread::searchError,
-			 q, &McRecoverWindow::markUiNotBusy);
-	QObject::connect(searchThread, &QObject::destroyed,
-			 q, &McRecoverWindow::markUiNotBusy);
+			 q, &McRecoverWindow::searchThread_searchStopped_slot);
+
+	// Connect the FileExporter slots.
+	// NOTE: exportStarted() is emitted synchronously by
+	// exportFiles_async(), so the UI is marked as busy
+	// before saveFiles() returns.
+	QObject::connect(fileExporter, &FileExporter::exportStarted,
+			 q, &McRecoverWindow::markUiBusy);
+	QObject::connect(fileExporter, &FileExporter::exportFinished,
+			 q, &McRecoverWindow::fileExporter_exportFinished_slot);
 
 	// Connect the QSignalMapper slot for "Preferred Region" selection.
 	QObject::connect(mapperPreferredRegion, SIGNAL(mapped(int)),
@@ -292,6 +353,9 @@ McRecoverWindowPrivate::~McRecoverWindowPrivate()
 	// Save the configuration.
 	cfg->save();
 
+	// Stop the file exporter before the card is deleted.
+	delete fileExporter;
+
 	// NOTE: Delete the MemCardModel first to prevent issues later.
 	delete model;
 	delete card;
@@ -359,6 +423,7 @@ void McRecoverWindowPrivate::initToolbar(void)
 	// Disable save actions by default.
 	ui.actionSave->setEnabled(false);
 	ui.actionSaveAll->setEnabled(false);
+	ui.actionSaveAllToArchive->setEnabled(false);
 
 	// Add a label for the "Preferred region" buttons.
 	lblPreferredRegion = new QLabel();
@@ -461,15 +526,68 @@ void McRecoverWindowPrivate::updateActionEnableStatus(void)
 		ui.actionScan->setEnabled(false);
 		ui.actionSave->setEnabled(false);
 		ui.actionSaveAll->setEnabled(false);
+		ui.actionSaveAllToArchive->setEnabled(false);
 	} else {
 		// Memory card image is loaded.
-		// TODO: Disable open, scan, and save (all) if we're scanning.
+		// NOTE: Files can't be saved while scanning,
+		// since the lost file list isn't complete yet.
+		// Scanning again restarts the search.
 		ui.actionClose->setEnabled(true);
 		ui.actionScan->setEnabled(true);
-		ui.actionSave->setEnabled(
+		ui.actionSave->setEnabled(!scanning &&
 			ui.lstFileList->selectionModel()->hasSelection());
-		ui.actionSaveAll->setEnabled(card->fileCount() > 0);
+		ui.actionSaveAll->setEnabled(!scanning && card->fileCount() > 0);
+		ui.actionSaveAllToArchive->setEnabled(!scanning && card->fileCount() > 0);
 	}
+
+	// Scan controls are only available while scanning.
+	ui.actionCancelScan->setEnabled(scanning);
+	ui.actionPauseScan->setEnabled(scanning);
+
+	// Uncommitted changes.
+	// Committing requires "Allow Writing".
+	const bool pendingChanges = (card && card->hasPendingChanges());
+	ui.actionCommitChanges->setEnabled(pendingChanges && !scanning && !card->isReadOnly());
+	ui.actionSaveImageAs->setEnabled(pendingChanges);
+	ui.actionDiscardChanges->setEnabled(pendingChanges && !scanning);
+}
+
+/**
+ * Update the UI for the search status.
+ * @param scanning True if a search is running; false if not.
+ */
+void McRecoverWindowPrivate::setScanning(bool scanning)
+{
+	Q_Q(McRecoverWindow);
+	this->scanning = scanning;
+
+	// A new search is never paused.
+	ui.actionPauseScan->setChecked(false);
+
+	// The file list is updated while scanning,
+	// so don't allow interaction with it.
+	q->centralWidget()->setEnabled(!scanning);
+	if (scanning) {
+		q->setCursor(Qt::BusyCursor);
+	} else if (uiBusyCounter == 0) {
+		q->unsetCursor();
+	}
+
+	updateActionEnableStatus();
+}
+
+/**
+ * Restart the search if it's running.
+ * Used if the search options are changed.
+ */
+void McRecoverWindowPrivate::restartScanIfRunning(void)
+{
+	if (!searchThread->isSearching())
+		return;
+
+	// Starting a new search cancels the running search.
+	Q_Q(McRecoverWindow);
+	q->on_actionScan_triggered();
 }
 
 /**
@@ -479,13 +597,33 @@ void McRecoverWindowPrivate::updateWindowTitle(void)
 {
 	QString windowTitle;
 	if (card) {
+		// NOTE: "[*]" is replaced with '*' if there are uncommitted changes.
 		windowTitle += displayFilename;
-		windowTitle += QLatin1String(" - ");
+		windowTitle += QLatin1String("[*] - ");
 	}
 	windowTitle += QApplication::applicationName();
 
 	Q_Q(McRecoverWindow);
 	q->setWindowTitle(windowTitle);
+	q->setWindowModified(card && card->hasPendingChanges());
+}
+
+/**
+ * Ask the user if uncommitted changes should be discarded.
+ * @return True if there are no changes, or if they can be discarded; false to cancel.
+ */
+bool McRecoverWindowPrivate::confirmDiscardChanges(void)
+{
+	if (!card || !card->hasPendingChanges())
+		return true;
+
+	Q_Q(McRecoverWindow);
+	const QMessageBox::StandardButton ret = QMessageBox::question(q,
+		McRecoverWindow::tr("Uncommitted Changes"),
+		McRecoverWindow::tr("The memory card image has changes that haven't been committed.\n\n"
+			"Do you want to discard them?"),
+		QMessageBox::Discard | QMessageBox::Cancel, QMessageBox::Cancel);
+	return (ret == QMessageBox::Discard);
 }
 
 /**
@@ -541,7 +679,6 @@ void McRecoverWindowPrivate::saveFiles(const QVector<File*> &files, QString path
 		OVERWRITEALL_NOTOALL	= 2,
 	};
 
-	int filesSaved = 0;
 	OverwriteAllStatus overwriteAll = OVERWRITEALL_UNKNOWN;
 
 	if (files.size() == 1 && path.isEmpty()) {
@@ -580,88 +717,130 @@ void McRecoverWindowPrivate::saveFiles(const QVector<File*> &files, QString path
 		setLastPath(path);
 	}
 
-	// Animted image format for icons.
-	GcImageWriter::AnimImageFormat animImgf = animIconFormat();
+	// Resolve all filenames and overwrite conflicts first,
+	// since the files are saved in the background.
+	QVector<FileExporter::Job> jobs;
+	jobs.reserve(files.size());
+
+	// Output paths claimed by jobs in this batch, and the index of
+	// the job that claimed them. Lost files often have the same
+	// default filename, and two jobs must never write the same path.
+	// NOTE: Keys are lowercase in case the filesystem is case-insensitive.
+	QHash<QString, int> claimedFilenames;
+	claimedFilenames.reserve(files.size() * 3);
 
 	foreach (File *file, files) {
+		FileExporter::Job job;
+		job.file = file;
 		if (!singleFile) {
-			const QString exportFilename = file->defaultExportFilename();
-			filename = path + QChar(L'/') + exportFilename;
-
-			// Check if the file exists.
-			// NOTE: Not done in the case of a single file because
-			// the "Save" dialog already prompted the user.
-			if (QFile::exists(filename)) {
-				if (overwriteAll == OVERWRITEALL_UNKNOWN) {
-					bool overwrite = false;
-					int ret = QMessageBox::warning(q,
-						McRecoverWindow::tr("File Already Exists"),
-						McRecoverWindow::tr("A file named \"%1\" already exists in the specified directory.\n\n"
-								    "Do you want to overwrite it?")
-								.arg(exportFilename),
-						(QMessageBox::Yes | QMessageBox::No | QMessageBox::YesToAll | QMessageBox::NoToAll),
-						QMessageBox::No);
-					switch (ret) {
-						case QMessageBox::Yes:
-							// Overwrite this file.
-							overwrite = true;
-							break;
-
-						default:
-						case QMessageBox::No:
-						case QMessageBox::Escape:
-							// Don't overwrite this file.
-							overwrite = false;
-							break;
-
-						case QMessageBox::YesToAll:
-							// Overwrite this file and all other files.
-							overwriteAll = OVERWRITEALL_YESTOALL;
-							overwrite = true;
-							break;
-
-						case QMessageBox::NoToAll:
-							// Don't overwrite this file or any other files.
-							overwriteAll = OVERWRITEALL_NOTOALL;
-							overwrite = false;
-							break;
-					}
-
-					if (!overwrite)
-						continue;
-				} else if (overwriteAll == OVERWRITEALL_NOTOALL) {
-					// Don't overwrite any files.
-					continue;
-				}
-			}
-		}
-
-		// Save the file.
-		int ret = file->exportToFile(filename);
-		if (ret == 0) {
-			// File saved successfully.
-			filesSaved++;
-		} else {
-			// An error occurred while saving the file.
-			// TODO: Error details.
+			filename = path + QChar(L'/') + file->defaultExportFilename();
 		}
+		job.filename = filename;
 
 		// Extract the banner.
 		if (extractBanners) {
-			// TODO: Error handling and details.
-			QString bannerFilename = changeFileExtension(filename, extBanner);
-			file->saveBanner(bannerFilename);
+			job.bannerFilenameNoExt = changeFileExtension(filename, extBanner);
 		}
 
 		// Extract the icon.
 		if (extractIcons) {
-			// TODO: Error handling and details.
-			if (file->iconCount() >= 1) {
-				// File has an icon.
-				QString iconFilename = changeFileExtension(filename, extIcon);
-				file->saveIcon(iconFilename, animImgf);
+			job.iconFilenameNoExt = changeFileExtension(filename, extIcon);
+		}
+
+		QStringList outFilenames(job.filename.toLower());
+		if (!job.bannerFilenameNoExt.isEmpty())
+			outFilenames.append(job.bannerFilenameNoExt.toLower());
+		if (!job.iconFilenameNoExt.isEmpty())
+			outFilenames.append(job.iconFilenameNoExt.toLower());
+
+		// Check if an earlier file in this batch will be saved to the same path.
+		// This is handled the same way as a file that already exists, since
+		// saving the earlier file would have created it.
+		bool claimed = false;
+		foreach (const QString &outFilename, outFilenames) {
+			if (claimedFilenames.contains(outFilename)) {
+				claimed = true;
+				break;
 			}
 		}
+
+		// Check if the file exists.
+		// NOTE: Not done in the case of a single file because
+		// the "Save" dialog already prompted the user.
+		if (!singleFile && (claimed || QFile::exists(filename))) {
+			if (overwriteAll == OVERWRITEALL_UNKNOWN) {
+				bool overwrite = false;
+				int ret = QMessageBox::warning(q,
+					McRecoverWindow::tr("File Already Exists"),
+					McRecoverWindow::tr("A file named \"%1\" already exists in the specified directory.\n\n"
+							    "Do you want to overwrite it?")
+							.arg(QFileInfo(filename).fileName()),
+					(QMessageBox::Yes | QMessageBox::No | QMessageBox::YesToAll | QMessageBox::NoToAll),
+					QMessageBox::No);
+				switch (ret) {
+					case QMessageBox::Yes:
+						// Overwrite this file.
+						overwrite = true;
+						break;
+
+					default:
+					case QMessageBox::No:
+					case QMessageBox::Escape:
+						// Don't overwrite this file.
+						overwrite = false;
+						break;
+
+					case QMessageBox::YesToAll:
+						// Overwrite this file and all other files.
+						overwriteAll = OVERWRITEALL_YESTOALL;
+						overwrite = true;
+						break;
+
+					case QMessageBox::NoToAll:
+						// Don't overwrite this file or any other files.
+						overwriteAll = OVERWRITEALL_NOTOALL;
+						overwrite = false;
+						break;
+				}
+
+				if (!overwrite)
+					continue;
+			} else if (overwriteAll == OVERWRITEALL_NOTOALL) {
+				// Don't overwrite any files.
+				continue;
+			}
+		}
+
+		if (claimed) {
+			// Overwriting a file from this batch.
+			// Drop the earlier job(s) so only this one writes the path.
+			foreach (const QString &outFilename, outFilenames) {
+				const int idx = claimedFilenames.value(outFilename, -1);
+				if (idx < 0 || !jobs[idx].file)
+					continue;
+
+				const FileExporter::Job &oldJob = jobs.at(idx);
+				claimedFilenames.remove(oldJob.filename.toLower());
+				if (!oldJob.bannerFilenameNoExt.isEmpty())
+					claimedFilenames.remove(oldJob.bannerFilenameNoExt.toLower());
+				if (!oldJob.iconFilenameNoExt.isEmpty())
+					claimedFilenames.remove(oldJob.iconFilenameNoExt.toLower());
+				jobs[idx].file = nullptr;
+			}
+		}
+
+		// Save the file.
+		foreach (const QString &outFilename, outFilenames) {
+			claimedFilenames.insert(outFilename, jobs.size());
+		}
+		jobs.append(job);
+	}
+
+	// Remove jobs that were replaced by later files.
+	for (int i = jobs.size() - 1; i >= 0; i--) {
+		if (!jobs.at(i).file) {
+			jobs.remove(i);
+		}
 	}
 
 	// Update the status bar.
@@ -681,7 +860,136 @@ void McRecoverWindowPrivate::saveFiles(const QVector<File*> &files, QString path
 		absolutePath += QChar(L'/');
 	}
 
-	statusBarManager->filesSaved(filesSaved, absolutePath);
+	if (jobs.isEmpty()) {
+		// All files were skipped.
+		statusBarManager->filesSaved(0, absolutePath);
+		return;
+	}
+
+	// Save the files in the background.
+	// The status bar is updated by fileExporter_exportFinished_slot().
+	exportPath = absolutePath;
+	// NOTE: The UI is busy while files are being saved,
+	// so another export can't be started until this one is done.
+	fileExporter->setAnimImgf(animIconFormat());
+	fileExporter->exportFiles_async(jobs);
+}
+
+/**
+ * Save the specified file(s) to an archive.
+ * The user is prompted for the archive filename.
+ * The files are saved in the background by fileExporter.
+ * @param files List of file(s) to save.
+ */
+void McRecoverWindowPrivate::saveFilesToArchive(const QVector<File*> &files)
+{
+	Q_Q(McRecoverWindow);
+
+	if (files.isEmpty())
+		return;
+
+	// Default archive name is based on the memory card filename.
+	QString defFilename = QFileInfo(filename).completeBaseName();
+	if (defFilename.isEmpty())
+		defFilename = QLatin1String("mcrecover");
+	defFilename = lastPath() + QChar(L'/') + defFilename + QLatin1String(".zip");
+
+	// Prompt the user for a save location.
+	const QString zipFilter = McRecoverWindow::tr("ZIP Archives") + QLatin1String(" (*.zip)");
+	const QString tarFilter = McRecoverWindow::tr("tar Archives") + QLatin1String(" (*.tar)");
+	const QString tgzFilter = McRecoverWindow::tr("Compressed tar Archives") + QLatin1String(" (*.tar.gz *.tgz)");
+	QString selectedFilter = zipFilter;
+	QString archiveFilename = QFileDialog::getSaveFileName(q,
+			McRecoverWindow::tr("Save %Ln GCN Save File(s) to Archive", "", files.size()),
+			defFilename,
+			zipFilter + QLatin1String(";;") + tarFilter + QLatin1String(";;") + tgzFilter,
+			&selectedFilter);
+	if (archiveFilename.isEmpty())
+		return;
+
+	// Set the last path.
+	setLastPath(archiveFilename);
+
+	// Determine the archive format from the file extension.
+	// If there's no recognized extension, use the selected filter.
+	ArchiveWriter::ArchiveFormat format;
+	ArchiveWriter::Compression compression;
+	if (archiveFilename.endsWith(QLatin1String(".tar.gz"), Qt::CaseInsensitive) ||
+	    archiveFilename.endsWith(QLatin1String(".tgz"), Qt::CaseInsensitive))
+	{
+		format = ArchiveWriter::FORMAT_TAR;
+		compression = ArchiveWriter::COMPRESS_DEFLATE;
+	} else if (archiveFilename.endsWith(QLatin1String(".tar"), Qt::CaseInsensitive)) {
+		format = ArchiveWriter::FORMAT_TAR;
+		compression = ArchiveWriter::COMPRESS_STORE;
+	} else if (archiveFilename.endsWith(QLatin1String(".zip"), Qt::CaseInsensitive)) {
+		format = ArchiveWriter::FORMAT_ZIP;
+		compression = ArchiveWriter::COMPRESS_DEFLATE;
+	} else {
+		if (selectedFilter == tgzFilter) {
+			format = ArchiveWriter::FORMAT_TAR;
+			compression = ArchiveWriter::COMPRESS_DEFLATE;
+		} else if (selectedFilter == tarFilter) {
+			format = ArchiveWriter::FORMAT_TAR;
+			compression = ArchiveWriter::COMPRESS_STORE;
+		} else {
+			format = ArchiveWriter::FORMAT_ZIP;
+			compression = ArchiveWriter::COMPRESS_DEFLATE;
+		}
+		archiveFilename += QChar(L'.') +
+			QLatin1String(ArchiveWriter::extForFormat(format, compression));
+	}
+
+	const bool extractBanners = ui.actionExtractBanners->isChecked();
+	const bool extractIcons = ui.actionExtractIcons->isChecked();
+	const QString extBanner = QLatin1String(".banner");
+	const QString extIcon = QLatin1String(".icon");
+
+	// Archive entries can't be overwritten, so files with
+	// duplicate filenames get a number appended.
+	QVector<FileExporter::Job> jobs;
+	jobs.reserve(files.size());
+	QSet<QString> usedFilenames;
+	usedFilenames.reserve(files.size());
+
+	foreach (File *file, files) {
+		QString exportFilename = file->defaultExportFilename();
+		if (usedFilenames.contains(exportFilename.toLower())) {
+			// Append a number before the file extension.
+			const int dotPos = exportFilename.lastIndexOf(QChar(L'.'));
+			const QString base = (dotPos > 0 ? exportFilename.left(dotPos) : exportFilename);
+			const QString ext = (dotPos > 0 ? exportFilename.mid(dotPos) : QString());
+			int i = 2;
+			do {
+				exportFilename = base + QString(QLatin1String(" (%1)")).arg(i++) + ext;
+			} while (usedFilenames.contains(exportFilename.toLower()));
+		}
+		usedFilenames.insert(exportFilename.toLower());
+
+		FileExporter::Job job;
+		job.file = file;
+		job.filename = exportFilename;
+		if (extractBanners) {
+			job.bannerFilenameNoExt = changeFileExtension(exportFilename, extBanner);
+		}
+		if (extractIcons) {
+			job.iconFilenameNoExt = changeFileExtension(exportFilename, extIcon);
+		}
+		jobs.append(job);
+	}
+
+	// Save the files in the background.
+	// The status bar is updated by fileExporter_exportFinished_slot().
+	exportPath = archiveFilename;
+	fileExporter->setAnimImgf(animIconFormat());
+	int ret = fileExporter->exportToArchive_async(jobs, archiveFilename, format, compression);
+	if (ret != 0) {
+		// Error creating the archive.
+		QMessageBox::critical(q,
+			McRecoverWindow::tr("Archive Error"),
+			McRecoverWindow::tr("Unable to create the archive \"%1\".")
+				.arg(QDir::toNativeSeparators(archiveFilename)));
+	}
 }
 
 /**
@@ -907,6 +1215,12 @@ McRecoverWindow::McRecoverWindow(QWidget *parent)
 	d->statusBarManager = new StatusBarManager(d->ui.statusBar, this);
 	d->updateWindowTitle();
 
+	// Show the export progress in the status bar.
+	connect(d->fileExporter, &FileExporter::exportStarted,
+		d->statusBarManager, &StatusBarManager::filesExportStarted);
+	connect(d->fileExporter, &FileExporter::exportUpdate,
+		d->statusBarManager, &StatusBarManager::filesExportUpdate);
+
 	// Shh... it's a secret to everybody.
 	connect(d->ui.lstFileList, &QTreeViewOpt::keyPress,
 		d->herpDerp, &HerpDerpEggListener::widget_keyPress);
@@ -938,6 +1252,10 @@ void McRecoverWindow::openCard(const QString &filename, FileType type)
 	Q_D(McRecoverWindow);
 
 	if (d->card) {
+		// Stop the search and export before the card is deleted.
+		d->searchThread->cancel(true);
+		d->fileExporter->cancel(true);
+
 		d->model->setCard(nullptr);
 		d->ui.mcCardView->setCard(nullptr);
 		d->ui.mcfFileView->setFile(nullptr);
@@ -1009,20 +1327,25 @@ void McRecoverWindow::openCard(const QString &filename, FileType type)
 
 	d->filename = filename;
 
+	// Edits are kept in the copy-on-write overlay until they're
+	// committed, so the image is never modified in place.
+	d->card->setOverlayEnabled(true);
+	connect(d->card, &Card::pendingChangesChanged,
+		this, &McRecoverWindow::card_pendingChangesChanged_slot);
+
 	// If GCN, check file checksums.
-	// TODO: Run this in a separate thread after loading?
+	// The checksums are calculated in parallel.
+	bool hasChkSummary = false;
+	GcnCheckFiles::ChecksumSummary chkSummary = {0, 0, 0};
 	if (type == FileType::GCN) {
-		// TODO: Singleton database management class.
-		// Get the database filenames.
-		QVector<QString> dbFilenames = GcnMcFileDb::GetDbFilenames();
-		if (!dbFilenames.isEmpty()) {
-			// Load the databases.
-			GcnCheckFiles checkFiles;
-			int ret = checkFiles.loadGcnMcFileDbs(dbFilenames);
-			if (ret == 0) {
-				// Check the files.
-				checkFiles.addChecksumDefs(qobject_cast<GcnCard*>(d->card));
-			}
+		// Get the databases.
+		// NOTE: GcnMcFileDbManager only loads the databases once.
+		GcnCheckFiles checkFiles;
+		int ret = checkFiles.loadDatabases();
+		if (ret == 0) {
+			// Check the files.
+			chkSummary = checkFiles.addChecksumDefs(qobject_cast<GcnCard*>(d->card));
+			hasChkSummary = true;
 		}
 	}
 
@@ -1120,6 +1443,10 @@ void McRecoverWindow::openCard(const QString &filename, FileType type)
 	// Update the UI.
 	d->updateLstFileList();
 	d->statusBarManager->opened(filename, d->card->productName());
+	if (hasChkSummary) {
+		d->statusBarManager->checksumsVerified(
+			chkSummary.good, chkSummary.invalid, chkSummary.unknown);
+	}
 	d->updateWindowTitle();
 
 	// FIXME: If a file is opened from the command line,
@@ -1139,6 +1466,10 @@ void McRecoverWindow::closeCard(bool noMsg)
 		productName = d->card->productName();
 	}
 
+	// Stop the search and export before the card is deleted.
+	d->searchThread->cancel(true);
+	d->fileExporter->cancel(true);
+
 	d->model->setCard(nullptr);
 	d->ui.mcCardView->setCard(nullptr);
 	d->ui.mcfFileView->setFile(nullptr);
@@ -1270,6 +1601,9 @@ void McRecoverWindow::dropEvent(QDropEvent *event)
 	event->accept();
 
 	// Open the memory card file.
+	Q_D(McRecoverWindow);
+	if (!d->confirmDiscardChanges())
+		return;
 	openCard(filename);
 }
 
@@ -1317,6 +1651,15 @@ void McRecoverWindow::closeEvent(QCloseEvent *event)
 		return;
 	}
 
+	if (!d->confirmDiscardChanges()) {
+		// User wants to keep the uncommitted changes.
+		event->ignore();
+		return;
+	}
+
+	// Stop the search before the window is closed.
+	d->searchThread->cancel(true);
+
 	// Pass the event to the base class.
 	super::closeEvent(event);
 }
@@ -1461,6 +1804,8 @@ void McRecoverWindow::on_actionOpen_triggered(void)
 		d->cfg->set(fileTypeKey, (int)type);
 
 		// Open the memory card file.
+		if (!d->confirmDiscardChanges())
+			return;
 		openCard(filename, type);
 	}
 }
@@ -1473,6 +1818,8 @@ void McRecoverWindow::on_actionClose_triggered(void)
 	Q_D(McRecoverWindow);
 	if (!d->card)
 		return;
+	if (!d->confirmDiscardChanges())
+		return;
 
 	closeCard();
 }
@@ -1490,9 +1837,11 @@ void McRecoverWindow::on_actionScan_triggered(void)
 	if (!gcnCard)
 		return;
 
-	// Get the database filenames.
-	QVector<QString> dbFilenames = GcnMcFileDb::GetDbFilenames();
-	if (dbFilenames.isEmpty()) {
+	// Get the databases.
+	// NOTE: GcnMcFileDbManager only reloads databases
+	// if the files have been changed.
+	int ret = d->searchThread->loadDatabases();
+	if (ret != 0) {
 #ifdef Q_OS_WIN
 		QString def_path_hint = tr(
 			"The database files should be located in the data subdirectory in\n"
@@ -1511,15 +1860,6 @@ void McRecoverWindow::on_actionScan_triggered(void)
 		return;
 	}
 
-	// Load the databases.
-	// TODO: Optimize database loading:
-	// - Only if the database is not loaded,
-	//   or if the database file has been changed.
-	// TODO: Singleton database management class.
-	int ret = d->searchThread->loadGcnMcFileDbs(dbFilenames);
-	if (ret != 0)
-		return;
-
 	// Remove "lost" files from the card.
 	d->card->removeLostFiles();
 
@@ -1541,7 +1881,7 @@ void McRecoverWindow::on_actionScan_triggered(void)
 		// Error starting the thread.
 		// Use the synchronous version.
 		// TODO: Handle errors.
-		// NOTE: Files will be added by searchThread_searchFinished_slot().
+		// NOTE: Files will be added by searchThread_filesFound_slot().
 		ret = d->searchThread->searchMemCard(gcnCard, d->preferredRegion, searchUsedBlocks);
 	}
 }
@@ -1552,6 +1892,10 @@ void McRecoverWindow::on_actionScan_triggered(void)
  */
 void McRecoverWindow::on_actionExit_triggered(void)
 {
+	Q_D(McRecoverWindow);
+	if (!d->confirmDiscardChanges())
+		return;
+
 	this->closeCard();
 	this->close();
 }
@@ -1617,6 +1961,111 @@ void McRecoverWindow::on_actionSaveAll_triggered(void)
 	d->saveFiles(files);
 }
 
+/**
+ * Save all files to an archive.
+ */
+void McRecoverWindow::on_actionSaveAllToArchive_triggered(void)
+{
+	Q_D(McRecoverWindow);
+	if (!d->card)
+		return;
+
+	QVector<File*> files = d->card->getFiles(Card::FTYPE_ALL);
+	if (files.isEmpty()) {
+		// No files to save...
+		return;
+	}
+
+	// Save the files.
+	d->saveFilesToArchive(files);
+}
+
+/**
+ * Write the uncommitted changes to the memory card image.
+ */
+void McRecoverWindow::on_actionCommitChanges_triggered(void)
+{
+	Q_D(McRecoverWindow);
+	if (!d->card)
+		return;
+
+	int ret = d->card->commitOverlay();
+	if (ret != 0) {
+		static const QChar chrBullet(0x2022);  // U+2022: BULLET
+		QString errMsg = tr("An error occurred while writing the changes to the memory card image:") +
+			QChar(L'\n') + chrBullet + QChar(L' ') +
+			QLatin1String(strerror(-ret)) + QChar(L'.');
+		d->ui.msgWidget->showMessage(errMsg, MessageWidget::ICON_WARNING);
+	}
+}
+
+/**
+ * Save a copy of the memory card image with the uncommitted changes.
+ */
+void McRecoverWindow::on_actionSaveImageAs_triggered(void)
+{
+	Q_D(McRecoverWindow);
+	if (!d->card)
+		return;
+
+	const QString allFilter = tr("All Files") + QLatin1String(" (*)");
+	QString filename = QFileDialog::getSaveFileName(this,
+			tr("Save Modified Memory Card Image"),	// Dialog title
+			d->lastPath() + QChar(L'/') + d->displayFilename,	// Default filename
+			allFilter);				// Filters
+	if (filename.isEmpty())
+		return;
+
+	static const QChar chrBullet(0x2022);  // U+2022: BULLET
+	if (QFileInfo(filename) == QFileInfo(d->filename)) {
+		// Can't replace the image that's currently open.
+		QString errMsg = tr("An error occurred while saving the memory card image:") +
+			QChar(L'\n') + chrBullet + QChar(L' ') +
+			tr("Use \"Commit Changes\" to write the changes to the open image.");
+		d->ui.msgWidget->showMessage(errMsg, MessageWidget::ICON_WARNING);
+		return;
+	}
+
+	int ret = d->card->saveOverlayAs(filename);
+	if (ret != 0) {
+		QString errMsg = tr("An error occurred while saving the memory card image:") +
+			QChar(L'\n') + chrBullet + QChar(L' ');
+		QString errorString = d->card->errorString();
+		if (!errorString.isEmpty()) {
+			// Qt error strings don't have a trailing '.'
+			errMsg += errorString + QChar(L'.');
+		} else {
+			errMsg += QLatin1String(strerror(-ret)) + QChar(L'.');
+		}
+		d->ui.msgWidget->showMessage(errMsg, MessageWidget::ICON_WARNING);
+	}
+}
+
+/**
+ * Discard the uncommitted changes.
+ */
+void McRecoverWindow::on_actionDiscardChanges_triggered(void)
+{
+	Q_D(McRecoverWindow);
+	if (!d->card)
+		return;
+	if (!d->confirmDiscardChanges())
+		return;
+
+	d->card->discardOverlay();
+}
+
+/**
+ * The card's uncommitted changes status has changed.
+ * @param hasPendingChanges True if there are uncommitted changes; false if not.
+ */
+void McRecoverWindow::card_pendingChangesChanged_slot(bool hasPendingChanges)
+{
+	Q_D(McRecoverWindow);
+	setWindowModified(hasPendingChanges);
+	d->updateActionEnableStatus();
+}
+
 /**
  * Set the preferred region.
  * This slot is triggered by a QSignalMapper that
@@ -1626,6 +2075,7 @@ void McRecoverWindow::on_actionSaveAll_triggered(void)
 void McRecoverWindow::setPreferredRegion_slot(int preferredRegion)
 {
 	Q_D(McRecoverWindow);
+	const bool changed = (d->preferredRegion != static_cast<char>(preferredRegion));
 	d->preferredRegion = static_cast<char>(preferredRegion);
 
 	/**
@@ -1637,6 +2087,11 @@ void McRecoverWindow::setPreferredRegion_slot(int preferredRegion)
 	 */
 	QString str = QChar(static_cast<uint16_t>(preferredRegion));
 	d->cfg->set(QLatin1String("preferredRegion"), str);
+
+	// If a search is running, restart it with the new region.
+	if (changed) {
+		d->restartScanIfRunning();
+	}
 }
 
 /**
@@ -1700,6 +2155,82 @@ void McRecoverWindow::memCardModel_rowsInserted(void)
 	d->updateLstFileList();
 }
 
+/**
+ * Search has found files. (streaming mode)
+ * @param files Files found since the previous batch.
+ */
+void McRecoverWindow::searchThread_filesFound_slot(const QVector<GcnSearchData> &files)
+{
+	Q_D(McRecoverWindow);
+
+	// FIXME: Move "lost files" code to Card?
+	GcnCard *gcnCard = qobject_cast<GcnCard*>(d->card);
+	if (!gcnCard)
+		return;
+
+	// Add the directory entries.
+	// NOTE: Lost files were removed when the search was started.
+	gcnCard->prependLostFiles(files);
+}
+
+/**
+ * Search has started.
+ */
+void McRecoverWindow::searchThread_searchStarted_slot(void)
+{
+	Q_D(McRecoverWindow);
+	d->setScanning(true);
+}
+
+/**
+ * Search has stopped.
+ * This is called if the search finished, was cancelled,
+ * or failed due to an error.
+ */
+void McRecoverWindow::searchThread_searchStopped_slot(void)
+{
+	Q_D(McRecoverWindow);
+	d->setScanning(false);
+}
+
+/**
+ * Cancel the running search.
+ */
+void McRecoverWindow::on_actionCancelScan_triggered(void)
+{
+	Q_D(McRecoverWindow);
+	// searchCancelled() will be emitted once the search has stopped.
+	d->searchThread->cancel();
+}
+
+/**
+ * Pause or resume the running search.
+ * @param checked True to pause; false to resume.
+ */
+void McRecoverWindow::on_actionPauseScan_triggered(bool checked)
+{
+	Q_D(McRecoverWindow);
+	if (checked) {
+		d->searchThread->pause();
+	} else {
+		d->searchThread->resume();
+	}
+}
+
+/**
+ * Search has been cancelled.
+ */
+void McRecoverWindow::searchThread_searchCancelled_slot(void)
+{
+	Q_D(McRecoverWindow);
+	if (!d->card)
+		return;
+
+	// A cancelled search doesn't return any files.
+	// Remove any files that were streamed before it was cancelled.
+	d->card->removeLostFiles();
+}
+
 /**
  * Search has completed.
  * @param lostFilesFound Number of "lost" files found.
@@ -1714,6 +2245,11 @@ void McRecoverWindow::searchThread_searchFinished_slot(int lostFilesFound)
 	if (!gcnCard)
 		return;
 
+	if (d->searchThread->streamResults()) {
+		// Files were already added by searchThread_filesFound_slot().
+		return;
+	}
+
 	// Remove lost files from the card.
 	d->card->removeLostFiles();
 
@@ -1724,6 +2260,19 @@ void McRecoverWindow::searchThread_searchFinished_slot(int lostFilesFound)
 	QList<GcnFile*> files = gcnCard->addLostFiles(filesFoundList);
 }
 
+/**
+ * FileExporter has finished.
+ * @param filesSaved Number of files saved successfully.
+ * @param totalFiles Number of files that were supposed to be saved.
+ */
+void McRecoverWindow::fileExporter_exportFinished_slot(int filesSaved, int totalFiles)
+{
+	Q_UNUSED(totalFiles)
+	Q_D(McRecoverWindow);
+	d->statusBarManager->filesSaved(filesSaved, d->exportPath);
+	markUiNotBusy();
+}
+
 /**
  * lstFileList selectionModel: Current row selection has changed.
  * @param selected Selected index.
@@ -1757,7 +2306,7 @@ void McRecoverWindow::lstFileList_selectionModel_selectionChanged(
 	}
 
 	// If file(s) are selected, enable the Save action.
-	d->ui.actionSave->setEnabled(file_idx >= 0);
+	d->ui.actionSave->setEnabled(!d->scanning && file_idx >= 0);
 
 	// Set the FileView's File to the
 	// selected file in the QTreeView.
@@ -1853,6 +2402,9 @@ void McRecoverWindow::on_actionSearchUsedBlocks_triggered(bool checked)
 	Q_D(McRecoverWindow);
 	// d->cfg->set() will trigger a notification.
 	d->cfg->set(QLatin1String("searchUsedBlocks"), checked);
+
+	// If a search is running, restart it with the new setting.
+	d->restartScanIfRunning();
 }
 
 /**
@@ -1880,6 +2432,10 @@ void McRecoverWindow::chkAllowWrite_clicked(bool checked)
 		return;
 	}
 
+	// Stop the search first, since reopening the file
+	// invalidates the block pointers the search is using.
+	d->searchThread->cancel(true);
+
 	// Switch the read-only mode.
 	// NOTE: This box is true for "write", whereas setReadOnly is false for "write".
 	int ret = d->card->setReadOnly(!checked);
@@ -1908,4 +2464,7 @@ void McRecoverWindow::chkAllowWrite_clicked(bool checked)
 		}
 		d->ui.msgWidget->showMessage(errMsg, MessageWidget::ICON_WARNING);
 	}
+
+	// "Commit Changes" depends on the read-only mode.
+	d->updateActionEnableStatus();
 }
@@ -13,8 +13,12 @@
 
 // Qt includes.
 #include <QtCore/QString>
+#include <QtCore/QVector>
 #include <QItemSelection>
 
+// Search Data struct.
+#include "GcnSearchData.hpp"
+
 // MemCard Recover classes.
 class MemCardFile;
 
@@ -87,12 +91,26 @@ class McRecoverWindow : public QMainWindow
 		void on_actionOpen_triggered(void);
 		void on_actionClose_triggered(void);
 		void on_actionScan_triggered(void);
+		void on_actionCancelScan_triggered(void);
+		void on_actionPauseScan_triggered(bool checked);
 		void on_actionExit_triggered(void);
 		void on_actionAbout_triggered(void);
 
 		// Save actions.
 		void on_actionSave_triggered(void);
 		void on_actionSaveAll_triggered(void);
+		void on_actionSaveAllToArchive_triggered(void);
+
+		// Uncommitted changes.
+		void on_actionCommitChanges_triggered(void);
+		void on_actionSaveImageAs_triggered(void);
+		void on_actionDiscardChanges_triggered(void);
+
+		/**
+		 * The card's uncommitted changes status has changed.
+		 * @param hasPendingChanges True if there are uncommitted changes; false if not.
+		 */
+		void card_pendingChangesChanged_slot(bool hasPendingChanges);
 
 		/**
 		 * Set the preferred region.
@@ -113,9 +131,24 @@ class McRecoverWindow : public QMainWindow
 		void memCardModel_layoutChanged(void);
 		void memCardModel_rowsInserted(void);
 
+		// SearchThread has found files. (streaming mode)
+		void searchThread_filesFound_slot(const QVector<GcnSearchData> &files);
+
+		// SearchThread has started.
+		void searchThread_searchStarted_slot(void);
+
+		// SearchThread has stopped. (finished, cancelled, or error)
+		void searchThread_searchStopped_slot(void);
+
+		// SearchThread has been cancelled.
+		void searchThread_searchCancelled_slot(void);
+
 		// SearchThread has finished.
 		void searchThread_searchFinished_slot(int lostFilesFound);
 
+		// FileExporter has finished.
+		void fileExporter_exportFinished_slot(int filesSaved, int totalFiles);
+
 		// lstFileList slots.
 		void lstFileList_selectionModel_selectionChanged(const QItemSelection& selected, const QItemSelection& deselected);
 